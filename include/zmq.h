@@ -662,6 +662,15 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 #define ZMQ_NORM_NUM_PARITY 122
 #define ZMQ_NORM_NUM_AUTOPARITY 123
 #define ZMQ_NORM_PUSH 124
+#define ZMQ_TCP_LISTEN_SHARDS 125
+#define ZMQ_TCP_LISTEN_CPU_STEERING 126
+#define ZMQ_ACCEPT_BATCH_SIZE 127
+#define ZMQ_OPTIMISTIC_HANDSHAKE 128
+#define ZMQ_IO_BUDGET 129
+#define ZMQ_RCVSPIN 130
+#define ZMQ_CURVE_AEAD 131
+#define ZMQ_CONFLATE_KEY 132
+#define ZMQ_XPUB_LAST_VALUE_CACHE 133
 
 /*  DRAFT ZMQ_NORM_MODE options                                               */
 #define ZMQ_NORM_FIXED 0
@@ -675,8 +684,23 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 #define ZMQ_RECONNECT_STOP_HANDSHAKE_FAILED 0x2
 #define ZMQ_RECONNECT_STOP_AFTER_DISCONNECT 0x4
 
+/*  DRAFT ZMQ_CURVE_AEAD options                                              */
+#define ZMQ_CURVE_AEAD_AES256GCM 1
+#define ZMQ_CURVE_AEAD_CHACHA20POLY1305 2
+
+/*  DRAFT ZMQ_CONFLATE_KEY options                                            */
+#define ZMQ_CONFLATE_KEY_FRAME -1
+
+/*  DRAFT ZMQ_XPUB_LAST_VALUE_CACHE options                                   */
+#define ZMQ_XPUB_LAST_VALUE_CACHE_FRAME -1
+
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_IO_THREAD_REBALANCE_IVL 11
+#define ZMQ_CRYPTO_THREADS 12
+#define ZMQ_ZAP_CACHE_TTL 13
+#define ZMQ_EDGE_TRIGGERED 14
+#define ZMQ_IO_THREAD_STATS 15
 
 /*  DRAFT Context methods.                                                    */
 ZMQ_EXPORT int zmq_ctx_set_ext (void *context_,
@@ -688,6 +712,20 @@ ZMQ_EXPORT int zmq_ctx_get_ext (void *context_,
                                 void *optval_,
                                 size_t *optvallen_);
 
+/*  Utilisation of an I/O thread, as returned by ZMQ_IO_THREAD_STATS. Times   */
+/*  are in microseconds.                                                      */
+typedef struct zmq_io_thread_stats_t
+{
+    uint64_t busy_time;
+    uint64_t idle_time;
+    uint64_t events;
+    uint64_t commands;
+    uint64_t timers;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t migrations;
+} zmq_io_thread_stats_t;
+
 /*  DRAFT Socket methods.                                                     */
 ZMQ_EXPORT int zmq_join (void *s, const char *group);
 ZMQ_EXPORT int zmq_leave (void *s, const char *group);
@@ -746,6 +784,21 @@ zmq_poller_add_fd (void *poller, zmq_fd_t fd, void *user_data, short events);
 ZMQ_EXPORT int zmq_poller_modify_fd (void *poller, zmq_fd_t fd, short events);
 ZMQ_EXPORT int zmq_poller_remove_fd (void *poller, zmq_fd_t fd);
 
+/*  Completion queue telling which of many sockets are ready                  */
+#define ZMQ_HAVE_CQ
+
+ZMQ_EXPORT void *zmq_cq_new (void);
+ZMQ_EXPORT int zmq_cq_destroy (void **cq_p);
+ZMQ_EXPORT int zmq_cq_size (void *cq);
+ZMQ_EXPORT int
+zmq_cq_add (void *cq, void *socket, void *user_data, short events);
+ZMQ_EXPORT int zmq_cq_modify (void *cq, void *socket, short events);
+ZMQ_EXPORT int zmq_cq_remove (void *cq, void *socket);
+ZMQ_EXPORT int zmq_cq_wait (void *cq,
+                            zmq_poller_event_t *events,
+                            int n_events,
+                            long timeout);
+
 ZMQ_EXPORT int zmq_socket_get_peer_state (void *socket,
                                           const void *routing_id,
                                           size_t routing_id_size);
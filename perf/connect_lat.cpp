@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the latency from connecting to the delivery of the first
+//  message, which is dominated by the round trips of the handshake. The
+//  connections are made one after the other, each by a fresh peer that
+//  queues one message before connecting and is closed once the message
+//  has been received. With --optimistic, the peers send their greeting
+//  and first handshake command without waiting for the listener's.
+
+static int compare_latency (const void *lhs_, const void *rhs_)
+{
+    const unsigned long lhs = *static_cast<const unsigned long *> (lhs_);
+    const unsigned long rhs = *static_cast<const unsigned long *> (rhs_);
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *bind_to;
+    int connection_count;
+    int optimistic = 0;
+    void *ctx;
+    void *s;
+    unsigned long *latencies;
+    int rc;
+    int i;
+    zmq_msg_t msg;
+    double mean_latency;
+
+    if (argc != 3 && argc != 4) {
+        printf ("usage: connect_lat <bind-to> <connection-count> "
+                "[--optimistic]\n");
+        return 1;
+    }
+    bind_to = argv[1];
+    connection_count = atoi (argv[2]);
+    if (argc == 4 && strcmp (argv[3], "--optimistic") == 0)
+        optimistic = 1;
+
+    ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    s = zmq_socket (ctx, ZMQ_ROUTER);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+#ifdef ZMQ_OPTIMISTIC_HANDSHAKE
+    //  Lets the peers use TCP Fast Open.
+    rc = zmq_setsockopt (s, ZMQ_OPTIMISTIC_HANDSHAKE, &optimistic,
+                         sizeof (int));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+#endif
+
+    rc = zmq_bind (s, bind_to);
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    latencies = static_cast<unsigned long *> (
+      malloc (connection_count * sizeof (unsigned long)));
+    if (!latencies) {
+        printf ("error in malloc\n");
+        return -1;
+    }
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    for (i = 0; i != connection_count; i++) {
+        const int linger = 0;
+        void *peer;
+        void *watch;
+
+        peer = zmq_socket (ctx, ZMQ_DEALER);
+        if (!peer) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+
+        rc = zmq_setsockopt (peer, ZMQ_LINGER, &linger, sizeof (linger));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+
+#ifdef ZMQ_OPTIMISTIC_HANDSHAKE
+        rc = zmq_setsockopt (peer, ZMQ_OPTIMISTIC_HANDSHAKE, &optimistic,
+                             sizeof (int));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+#endif
+
+        watch = zmq_stopwatch_start ();
+
+        rc = zmq_connect (peer, bind_to);
+        if (rc != 0) {
+            printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_send (peer, &i, sizeof (i), 0);
+        if (rc < 0) {
+            printf ("error in zmq_send: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+
+        //  Routing id frame.
+        rc = zmq_msg_recv (&msg, s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_recv (&msg, s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+
+        latencies[i] = zmq_stopwatch_stop (watch);
+
+        if (zmq_msg_size (&msg) != sizeof (i)
+            || memcmp (zmq_msg_data (&msg), &i, sizeof (i)) != 0) {
+            printf ("message of incorrect size received\n");
+            return -1;
+        }
+
+        rc = zmq_close (peer);
+        if (rc != 0) {
+            printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    qsort (latencies, connection_count, sizeof (unsigned long),
+           compare_latency);
+    mean_latency = 0;
+    for (i = 0; i != connection_count; i++)
+        mean_latency += (double) latencies[i] / connection_count;
+
+    printf ("connection count: %d\n", connection_count);
+    printf ("optimistic handshake: %s\n", optimistic ? "yes" : "no");
+    printf ("mean connect latency: %.3f [us]\n", mean_latency);
+    printf ("median connect latency: %lu [us]\n",
+            latencies[connection_count / 2]);
+    printf ("99th percentile connect latency: %lu [us]\n",
+            latencies[(connection_count * 99) / 100]);
+
+    free (latencies);
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,292 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures how fast a listener accepts and handshakes a burst of incoming
+//  connections. All connections are opened at once; each peer queues one
+//  message carrying its index, which the listener receives as soon as that
+//  peer's handshake has completed. With --curve, the listener is a CURVE
+//  server, and <crypto-threads> worker threads may take over its handshake
+//  cryptography. The peers live in a context of their own, so that their
+//  side of the handshakes does not compete with the listener's I/O threads.
+
+static int compare_latency (const void *lhs_, const void *rhs_)
+{
+    const unsigned long lhs = *static_cast<const unsigned long *> (lhs_);
+    const unsigned long rhs = *static_cast<const unsigned long *> (rhs_);
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *bind_to;
+    int connection_count;
+    int io_threads = 1;
+    int accept_batch_size = 0;
+    int curve = 0;
+    int crypto_threads = 0;
+    char server_public[41];
+    char server_secret[41];
+    char peer_public[41];
+    char peer_secret[41];
+    void *ctx;
+    void *peer_ctx;
+    void *s;
+    void **peers;
+    unsigned long *started;
+    unsigned long *latencies;
+    int rc;
+    int i;
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long elapsed;
+    double throughput;
+    double mean_latency;
+
+    if (argc < 3 || argc > 7) {
+        printf ("usage: connect_thr <bind-to> <connection-count> "
+                "[<io-threads>] [<accept-batch-size>] [--curve] "
+                "[<crypto-threads>]\n");
+        return 1;
+    }
+    bind_to = argv[1];
+    connection_count = atoi (argv[2]);
+    if (argc >= 4)
+        io_threads = atoi (argv[3]);
+    if (argc >= 5)
+        accept_batch_size = atoi (argv[4]);
+    if (argc >= 6 && strcmp (argv[5], "--curve") == 0)
+        curve = 1;
+    if (argc >= 7)
+        crypto_threads = atoi (argv[6]);
+
+    if (curve) {
+        rc = zmq_curve_keypair (server_public, server_secret);
+        if (rc == 0)
+            rc = zmq_curve_keypair (peer_public, peer_secret);
+        if (rc != 0) {
+            printf ("error in zmq_curve_keypair: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_set (ctx, ZMQ_IO_THREADS, io_threads);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+#ifdef ZMQ_CRYPTO_THREADS
+    rc = zmq_ctx_set (ctx, ZMQ_CRYPTO_THREADS, crypto_threads);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+#endif
+
+    peer_ctx = zmq_ctx_new ();
+    if (!peer_ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_set (peer_ctx, ZMQ_IO_THREADS, io_threads);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_set (peer_ctx, ZMQ_MAX_SOCKETS, connection_count);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    s = zmq_socket (ctx, ZMQ_ROUTER);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  Make room for the whole burst so that dropped SYNs and their
+    //  retransmission timeouts do not dominate the results.
+    rc = zmq_setsockopt (s, ZMQ_BACKLOG, &connection_count, sizeof (int));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+#ifdef ZMQ_ACCEPT_BATCH_SIZE
+    if (accept_batch_size > 0) {
+        rc = zmq_setsockopt (s, ZMQ_ACCEPT_BATCH_SIZE, &accept_batch_size,
+                             sizeof (int));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+#endif
+
+    if (curve) {
+        const int as_server = 1;
+        rc = zmq_setsockopt (s, ZMQ_CURVE_SERVER, &as_server, sizeof (int));
+        if (rc == 0)
+            rc = zmq_setsockopt (s, ZMQ_CURVE_SECRETKEY, server_secret, 41);
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    rc = zmq_bind (s, bind_to);
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    peers = static_cast<void **> (malloc (connection_count * sizeof (void *)));
+    started = static_cast<unsigned long *> (
+      malloc (connection_count * sizeof (unsigned long)));
+    latencies = static_cast<unsigned long *> (
+      malloc (connection_count * sizeof (unsigned long)));
+    if (!peers || !started || !latencies) {
+        printf ("error in malloc\n");
+        return -1;
+    }
+
+    for (i = 0; i != connection_count; i++) {
+        peers[i] = zmq_socket (peer_ctx, ZMQ_DEALER);
+        if (!peers[i]) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        if (curve) {
+            rc = zmq_setsockopt (peers[i], ZMQ_CURVE_SERVERKEY, server_public,
+                                 41);
+            if (rc == 0)
+                rc = zmq_setsockopt (peers[i], ZMQ_CURVE_PUBLICKEY,
+                                     peer_public, 41);
+            if (rc == 0)
+                rc = zmq_setsockopt (peers[i], ZMQ_CURVE_SECRETKEY,
+                                     peer_secret, 41);
+            if (rc != 0) {
+                printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+                return -1;
+            }
+        }
+    }
+
+    watch = zmq_stopwatch_start ();
+
+    for (i = 0; i != connection_count; i++) {
+        started[i] = zmq_stopwatch_intermediate (watch);
+        rc = zmq_connect (peers[i], bind_to);
+        if (rc != 0) {
+            printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_send (peers[i], &i, sizeof (i), 0);
+        if (rc < 0) {
+            printf ("error in zmq_send: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    for (i = 0; i != connection_count; i++) {
+        int peer;
+
+        //  Routing id frame.
+        rc = zmq_msg_recv (&msg, s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_recv (&msg, s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        if (zmq_msg_size (&msg) != sizeof (peer)) {
+            printf ("message of incorrect size received\n");
+            return -1;
+        }
+        memcpy (&peer, zmq_msg_data (&msg), sizeof (peer));
+        latencies[i] = zmq_stopwatch_intermediate (watch) - started[peer];
+    }
+
+    elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    qsort (latencies, connection_count, sizeof (unsigned long),
+           compare_latency);
+    mean_latency = 0;
+    for (i = 0; i != connection_count; i++)
+        mean_latency += (double) latencies[i] / connection_count;
+    throughput = ((double) connection_count / (double) elapsed * 1000000);
+
+    printf ("connection count: %d\n", connection_count);
+    printf ("io threads: %d\n", io_threads);
+    if (curve)
+        printf ("crypto threads: %d\n", crypto_threads);
+    printf ("mean throughput: %d [conn/s]\n", (int) throughput);
+    printf ("mean handshake latency: %.3f [us]\n", mean_latency);
+    printf ("median handshake latency: %lu [us]\n",
+            latencies[connection_count / 2]);
+    printf ("99th percentile handshake latency: %lu [us]\n",
+            latencies[(connection_count * 99) / 100]);
+
+    for (i = 0; i != connection_count; i++) {
+        int linger = 0;
+        zmq_setsockopt (peers[i], ZMQ_LINGER, &linger, sizeof (linger));
+        rc = zmq_close (peers[i]);
+        if (rc != 0) {
+            printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+    free (peers);
+    free (started);
+    free (latencies);
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (peer_ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined __GLIBC__                                                          \
+  && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+
+//  Measures the memory an idle TCP connection costs. <connection-count>
+//  DEALER sockets connect to a ROUTER socket, all in this process, and
+//  exchange one message each way, so that both engines of each connection
+//  have used their buffers. The memory per connection is reported then,
+//  and again once the connections have been idle for long enough for the
+//  engines to give their buffers back. Both engines of a connection count,
+//  along with the sockets. Resident memory is only reported on Linux, and
+//  heap memory in use only with glibc.
+
+//  Resident memory of the process, in kB, or -1 if unknown.
+static long resident_kb ()
+{
+    long kb = -1;
+    FILE *f = fopen ("/proc/self/status", "r");
+    if (!f)
+        return kb;
+    char line[256];
+    while (fgets (line, sizeof line, f))
+        if (strncmp (line, "VmRSS:", 6) == 0) {
+            kb = atol (line + 6);
+            break;
+        }
+    fclose (f);
+    return kb;
+}
+
+//  Heap memory in use, in bytes, or -1 if unknown.
+static long long heap_bytes ()
+{
+#if defined HAVE_MALLINFO2
+    return static_cast<long long> (mallinfo2 ().uordblks);
+#else
+    return -1;
+#endif
+}
+
+struct sample_t
+{
+    long rss_kb;
+    long long heap;
+};
+
+static sample_t sample ()
+{
+    sample_t s;
+    s.rss_kb = resident_kb ();
+    s.heap = heap_bytes ();
+    return s;
+}
+
+static void report (const char *name_,
+                    const sample_t &base_,
+                    const sample_t &now_,
+                    int connection_count_)
+{
+    printf ("%s:", name_);
+    if (base_.rss_kb >= 0 && now_.rss_kb >= 0)
+        printf (" %.1f [kB resident/connection]",
+                (double) (now_.rss_kb - base_.rss_kb) / connection_count_);
+    if (base_.heap >= 0 && now_.heap >= 0)
+        printf (" %.1f [kB heap/connection]",
+                (double) (now_.heap - base_.heap) / 1024 / connection_count_);
+    printf ("\n");
+}
+
+int main (int argc, char *argv[])
+{
+    if (argc != 2) {
+        printf ("usage: idle_conn_mem <connection-count>\n");
+        return 1;
+    }
+    const int connection_count = atoi (argv[1]);
+    if (connection_count < 1) {
+        printf ("connection count must be positive\n");
+        return 1;
+    }
+
+    void *ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+    int rc = zmq_ctx_set (ctx, ZMQ_MAX_SOCKETS, connection_count + 1);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    void *router = zmq_socket (ctx, ZMQ_ROUTER);
+    if (!router) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+    char endpoint[256];
+    size_t size = sizeof endpoint;
+    rc = zmq_bind (router, "tcp://127.0.0.1:*");
+    if (rc == 0)
+        rc = zmq_getsockopt (router, ZMQ_LAST_ENDPOINT, endpoint, &size);
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    const sample_t base = sample ();
+
+    void **dealers =
+      static_cast<void **> (malloc (connection_count * sizeof (void *)));
+    for (int i = 0; i != connection_count; i++) {
+        dealers[i] = zmq_socket (ctx, ZMQ_DEALER);
+        if (!dealers[i]) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return 1;
+        }
+        rc = zmq_connect (dealers[i], endpoint);
+        if (rc == 0)
+            rc = zmq_send (dealers[i], "x", 1, 0);
+        if (rc < 0) {
+            printf ("error in zmq_connect or zmq_send: %s\n",
+                    zmq_strerror (errno));
+            return 1;
+        }
+    }
+
+    //  Bounce each message back to its sender.
+    zmq_msg_t routing_id;
+    zmq_msg_t msg;
+    zmq_msg_init (&routing_id);
+    zmq_msg_init (&msg);
+    for (int i = 0; i != connection_count; i++) {
+        rc = zmq_msg_recv (&routing_id, router, 0);
+        if (rc >= 0)
+            rc = zmq_msg_recv (&msg, router, 0);
+        if (rc >= 0)
+            rc = zmq_msg_send (&routing_id, router, ZMQ_SNDMORE);
+        if (rc >= 0)
+            rc = zmq_msg_send (&msg, router, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv or zmq_msg_send: %s\n",
+                    zmq_strerror (errno));
+            return 1;
+        }
+    }
+    char buffer[1];
+    for (int i = 0; i != connection_count; i++) {
+        rc = zmq_recv (dealers[i], buffer, sizeof buffer, 0);
+        if (rc != 1) {
+            printf ("error in zmq_recv: %s\n", zmq_strerror (errno));
+            return 1;
+        }
+    }
+
+    const sample_t active = sample ();
+
+    //  The engines keep their buffers for one to two seconds of idleness.
+    zmq_sleep (3);
+
+    const sample_t idle = sample ();
+
+    zmq_msg_close (&msg);
+    zmq_msg_close (&routing_id);
+    for (int i = 0; i != connection_count; i++)
+        zmq_close (dealers[i]);
+    free (dealers);
+    zmq_close (router);
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    printf ("connection count: %d\n", connection_count);
+    report ("after traffic", base, active, connection_count);
+    report ("after idling", base, idle, connection_count);
+
+    return 0;
+}
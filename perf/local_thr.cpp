@@ -3,6 +3,7 @@
 #include "../include/zmq.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // keys are arbitrary but must match remote_lat.cpp
 const char server_prvkey[] = "{X}#>t#jRGaQ}gMhv=30r(Mw+87YGs+5%kh=i@f8";
@@ -22,18 +23,21 @@ int main (int argc, char *argv[])
     double throughput;
     double megabits;
     int curve = 0;
+    int crypto_threads = 0;
 
-    if (argc != 4 && argc != 5) {
+    if (argc < 4 || argc > 6) {
         printf ("usage: local_thr <bind-to> <message-size> <message-count> "
-                "[<enable_curve>]\n");
+                "[--curve|<enable_curve>] [<crypto-threads>]\n");
         return 1;
     }
     bind_to = argv[1];
     message_size = atoi (argv[2]);
     message_count = atoi (argv[3]);
-    if (argc >= 5 && atoi (argv[4])) {
+    if (argc >= 5 && (strcmp (argv[4], "--curve") == 0 || atoi (argv[4]))) {
         curve = 1;
     }
+    if (argc >= 6)
+        crypto_threads = atoi (argv[5]);
 
     ctx = zmq_init (1);
     if (!ctx) {
@@ -41,6 +45,15 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+#ifdef ZMQ_CRYPTO_THREADS
+    //  Spread the CURVE encryption over worker threads.
+    rc = zmq_ctx_set (ctx, ZMQ_CRYPTO_THREADS, crypto_threads);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+#endif
+
     s = zmq_socket (ctx, ZMQ_PULL);
     if (!s) {
         printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
@@ -115,6 +128,8 @@ int main (int argc, char *argv[])
 
     printf ("message size: %d [B]\n", (int) message_size);
     printf ("message count: %d\n", (int) message_count);
+    if (curve)
+        printf ("crypto threads: %d\n", crypto_threads);
     printf ("mean throughput: %d [msg/s]\n", (int) throughput);
     printf ("mean throughput: %.3f [Mb/s]\n", (double) megabits);
 
@@ -0,0 +1,296 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the latency of request-reply round trips over TCP while another
+//  connection streams bulk data through the same I/O threads. The server
+//  context has a single I/O thread serving both a PULL socket, drained as
+//  fast as possible, and a REP socket echoing the requests. The client
+//  context, also with a single I/O thread, has a PUSH socket sending
+//  <bulk-size> byte messages without pause and a REQ socket doing
+//  <roundtrip-count> round trips of <message-size> byte messages. All the
+//  sockets get <io-budget> as ZMQ_IO_BUDGET, 0 meaning no budget.
+
+#if defined ZMQ_IO_BUDGET
+
+static size_t bulk_size;
+static int io_budget;
+static char bulk_endpoint[256];
+static char echo_endpoint[256];
+
+static void *new_socket (void *ctx_, int type_)
+{
+    void *s = zmq_socket (ctx_, type_);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    int rc = zmq_setsockopt (s, ZMQ_IO_BUDGET, &io_budget, sizeof (io_budget));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    //  The bulk data still queued at the end is of no interest.
+    const int linger = 0;
+    rc = zmq_setsockopt (s, ZMQ_LINGER, &linger, sizeof (linger));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    return s;
+}
+
+static void bind_socket (void *s_, char *endpoint_)
+{
+    size_t size = 256;
+    int rc = zmq_bind (s_, "tcp://127.0.0.1:*");
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    rc = zmq_getsockopt (s_, ZMQ_LAST_ENDPOINT, endpoint_, &size);
+    if (rc != 0) {
+        printf ("error in zmq_getsockopt: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+static void close_socket (void *s_)
+{
+    int rc = zmq_close (s_);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+//  The threads below run until their context is shut down.
+
+static void drain (void *s_)
+{
+    zmq_msg_t msg;
+    int rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    while (zmq_msg_recv (&msg, s_, 0) >= 0)
+        ;
+    if (errno != ETERM) {
+        printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    zmq_msg_close (&msg);
+    close_socket (s_);
+}
+
+static void echo (void *s_)
+{
+    zmq_msg_t msg;
+    int rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    while (zmq_msg_recv (&msg, s_, 0) >= 0)
+        if (zmq_msg_send (&msg, s_, 0) < 0)
+            break;
+    if (errno != ETERM) {
+        printf ("error in echo: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    zmq_msg_close (&msg);
+    close_socket (s_);
+}
+
+static void stream (void *s_)
+{
+    zmq_msg_t msg;
+    for (;;) {
+        int rc = zmq_msg_init_size (&msg, bulk_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+#if defined ZMQ_MAKE_VALGRIND_HAPPY
+        memset (zmq_msg_data (&msg), 0, bulk_size);
+#endif
+        rc = zmq_msg_send (&msg, s_, 0);
+        if (rc < 0) {
+            zmq_msg_close (&msg);
+            break;
+        }
+    }
+    if (errno != ETERM) {
+        printf ("error in zmq_msg_send: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    close_socket (s_);
+}
+
+static void *new_context ()
+{
+    void *ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    int rc = zmq_ctx_set (ctx, ZMQ_IO_THREADS, 1);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    return ctx;
+}
+
+int main (int argc, char *argv[])
+{
+    void *server_ctx;
+    void *client_ctx;
+    void *pull;
+    void *rep;
+    void *push;
+    void *req;
+    void *drain_thread;
+    void *echo_thread;
+    void *stream_thread;
+    size_t message_size;
+    int roundtrip_count;
+    int rc;
+    int i;
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long *latencies;
+    double total;
+
+    if (argc != 4 && argc != 5) {
+        printf ("usage: mixed_lat <message-size> <roundtrip-count> "
+                "<bulk-size> [<io-budget>]\n");
+        return 1;
+    }
+    message_size = atoi (argv[1]);
+    roundtrip_count = atoi (argv[2]);
+    bulk_size = atoi (argv[3]);
+    io_budget = argc == 5 ? atoi (argv[4]) : 0;
+    if (roundtrip_count < 1) {
+        printf ("roundtrip count must be positive\n");
+        return 1;
+    }
+
+    latencies = static_cast<unsigned long *> (
+      malloc (roundtrip_count * sizeof (unsigned long)));
+    if (!latencies) {
+        printf ("out of memory\n");
+        return -1;
+    }
+
+    server_ctx = new_context ();
+    client_ctx = new_context ();
+
+    pull = new_socket (server_ctx, ZMQ_PULL);
+    bind_socket (pull, bulk_endpoint);
+    rep = new_socket (server_ctx, ZMQ_REP);
+    bind_socket (rep, echo_endpoint);
+
+    push = new_socket (client_ctx, ZMQ_PUSH);
+    rc = zmq_connect (push, bulk_endpoint);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    req = new_socket (client_ctx, ZMQ_REQ);
+    rc = zmq_connect (req, echo_endpoint);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    drain_thread = zmq_threadstart (drain, pull);
+    echo_thread = zmq_threadstart (echo, rep);
+    stream_thread = zmq_threadstart (stream, push);
+
+    rc = zmq_msg_init_size (&msg, message_size);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    memset (zmq_msg_data (&msg), 0, message_size);
+
+    //  The first round trip also waits for the connection to be set up.
+    for (i = -1; i != roundtrip_count; i++) {
+        watch = zmq_stopwatch_start ();
+        rc = zmq_msg_send (&msg, req, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_send: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_recv (&msg, req, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        if (zmq_msg_size (&msg) != message_size) {
+            printf ("message of incorrect size received\n");
+            return -1;
+        }
+        const unsigned long elapsed = zmq_stopwatch_stop (watch);
+        if (i >= 0)
+            latencies[i] = elapsed;
+    }
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    close_socket (req);
+    zmq_ctx_shutdown (client_ctx);
+    zmq_ctx_shutdown (server_ctx);
+    zmq_threadclose (stream_thread);
+    zmq_threadclose (echo_thread);
+    zmq_threadclose (drain_thread);
+
+    total = 0;
+    for (i = 0; i != roundtrip_count; i++)
+        total += latencies[i];
+    std::sort (latencies, latencies + roundtrip_count);
+
+    printf ("message size: %d [B]\n", (int) message_size);
+    printf ("roundtrip count: %d\n", roundtrip_count);
+    printf ("bulk message size: %d [B]\n", (int) bulk_size);
+    printf ("io budget: %d [B]\n", io_budget);
+    printf ("average latency: %.3f [us]\n", total / roundtrip_count / 2);
+    printf ("99th percentile latency: %.3f [us]\n",
+            (double) latencies[roundtrip_count * 99 / 100] / 2);
+
+    free (latencies);
+
+    rc = zmq_ctx_term (client_ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (server_ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+#else
+
+int main ()
+{
+    printf ("mixed_lat needs libzmq built with the draft API\n");
+    return 1;
+}
+
+#endif
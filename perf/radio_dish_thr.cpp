@@ -0,0 +1,321 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the throughput of a RADIO socket sending to a DISH socket in
+//  the same process. The DISH binds to <endpoint> and joins <group-count>
+//  groups; the RADIO connects to it and sends <message-count> messages,
+//  cycling through the groups, so that each message is matched against
+//  the subscriptions on both sides. Over UDP, messages may be dropped; the
+//  receiver then gives up after a second without messages and reports how
+//  many made it.
+
+#if defined ZMQ_RADIO
+
+static const char *endpoint;
+static size_t message_size;
+static int message_count;
+static int group_count;
+
+//  The DISH joins this group last. Once a message sent to it gets through,
+//  all the other subscriptions have reached the RADIO too.
+static const char sync_group[] = "sync";
+
+static void group_name (char *buffer_, int index_)
+{
+    sprintf (buffer_, "group-%d", index_);
+}
+
+static void sender (void *ctx_)
+{
+    void *s;
+    void *control;
+    int rc;
+    int i;
+    int ready;
+    zmq_msg_t msg;
+    char group[16];
+    const int nodrop = 1;
+
+    control = zmq_socket (ctx_, ZMQ_PAIR);
+    if (!control) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    rc = zmq_connect (control, "inproc://radio_dish_thr_control");
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    s = zmq_socket (ctx_, ZMQ_RADIO);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    //  Wait for the receiver instead of dropping messages at the high water
+    //  mark.
+    rc = zmq_setsockopt (s, ZMQ_XPUB_NODROP, &nodrop, sizeof (nodrop));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    rc = zmq_connect (s, endpoint);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    //  Probe until the receiver has seen a message sent to the sync group.
+    ready = 0;
+    while (!ready) {
+        rc = zmq_msg_init (&msg);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        rc = zmq_msg_set_group (&msg, sync_group);
+        if (rc != 0) {
+            printf ("error in zmq_msg_set_group: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        rc = zmq_msg_send (&msg, s, ZMQ_DONTWAIT);
+        if (rc < 0) {
+            rc = zmq_msg_close (&msg);
+            if (rc != 0) {
+                printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+                exit (1);
+            }
+        }
+
+        zmq_pollitem_t item = {control, 0, ZMQ_POLLIN, 0};
+        rc = zmq_poll (&item, 1, 10);
+        if (rc < 0) {
+            printf ("error in zmq_poll: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        ready = rc;
+    }
+
+    for (i = 0; i != message_count; i++) {
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+#if defined ZMQ_MAKE_VALGRIND_HAPPY
+        memset (zmq_msg_data (&msg), 0, message_size);
+#endif
+
+        group_name (group, i % group_count);
+        rc = zmq_msg_set_group (&msg, group);
+        if (rc != 0) {
+            printf ("error in zmq_msg_set_group: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+
+        rc = zmq_msg_send (&msg, s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_send: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+    }
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    rc = zmq_close (control);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    void *ctx;
+    void *s;
+    void *control;
+    void *thread;
+    int rc;
+    int i;
+    int received;
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long elapsed;
+    double throughput;
+    double megabits;
+    char group[16];
+    const int timeout = 1000;
+
+    if (argc != 4 && argc != 5) {
+        printf ("usage: radio_dish_thr <endpoint> <message-size> "
+                "<message-count> [<group-count>]\n");
+        return 1;
+    }
+    endpoint = argv[1];
+    message_size = atoi (argv[2]);
+    message_count = atoi (argv[3]);
+    group_count = argc == 5 ? atoi (argv[4]) : 1;
+    if (group_count < 1) {
+        printf ("group count must be positive\n");
+        return 1;
+    }
+
+    ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    control = zmq_socket (ctx, ZMQ_PAIR);
+    if (!control) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_bind (control, "inproc://radio_dish_thr_control");
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    s = zmq_socket (ctx, ZMQ_DISH);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_setsockopt (s, ZMQ_RCVTIMEO, &timeout, sizeof (timeout));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_bind (s, endpoint);
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    for (i = 0; i != group_count; i++) {
+        group_name (group, i);
+        rc = zmq_join (s, group);
+        if (rc != 0) {
+            printf ("error in zmq_join: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+    rc = zmq_join (s, sync_group);
+    if (rc != 0) {
+        printf ("error in zmq_join: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    thread = zmq_threadstart (sender, ctx);
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  Wait for the first probe, then let the sender go.
+    do {
+        rc = zmq_msg_recv (&msg, s, 0);
+    } while (rc < 0 && errno == EAGAIN);
+    if (rc < 0) {
+        printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    watch = zmq_stopwatch_start ();
+
+    rc = zmq_send (control, "", 0, 0);
+    if (rc < 0) {
+        printf ("error in zmq_send: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  Stray probes do not count.
+    elapsed = 0;
+    received = 0;
+    while (received != message_count) {
+        rc = zmq_msg_recv (&msg, s, 0);
+        if (rc < 0 && errno == EAGAIN)
+            break;
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        if (strcmp (zmq_msg_group (&msg), sync_group) == 0)
+            continue;
+        if (zmq_msg_size (&msg) != message_size) {
+            printf ("message of incorrect size received\n");
+            return -1;
+        }
+        received++;
+        elapsed = zmq_stopwatch_intermediate (watch);
+    }
+
+    zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    zmq_threadclose (thread);
+
+    throughput = (double) received / (double) elapsed * 1000000;
+    megabits = throughput * message_size * 8 / 1000000;
+
+    printf ("message size: %d [B]\n", (int) message_size);
+    printf ("message count: %d\n", message_count);
+    printf ("group count: %d\n", group_count);
+    printf ("received: %d\n", received);
+    printf ("mean throughput: %d [msg/s]\n", (int) throughput);
+    printf ("mean throughput: %.3f [Mb/s]\n", megabits);
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_close (control);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+#else
+
+int main ()
+{
+    printf ("radio_dish_thr needs libzmq built with the draft API\n");
+    return 1;
+}
+
+#endif
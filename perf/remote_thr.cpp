@@ -21,18 +21,22 @@ int main (int argc, char *argv[])
     int i;
     zmq_msg_t msg;
     int curve = 0;
+    int crypto_threads = 0;
 
-    if (argc != 4 && argc != 5) {
+    if (argc < 4 || argc > 6) {
         printf ("usage: remote_thr <connect-to> <message-size> "
-                "<message-count> [<enable_curve>]\n");
+                "<message-count> [--curve|<enable_curve>] "
+                "[<crypto-threads>]\n");
         return 1;
     }
     connect_to = argv[1];
     message_size = atoi (argv[2]);
     message_count = atoi (argv[3]);
-    if (argc >= 5 && atoi (argv[4])) {
+    if (argc >= 5 && (strcmp (argv[4], "--curve") == 0 || atoi (argv[4]))) {
         curve = 1;
     }
+    if (argc >= 6)
+        crypto_threads = atoi (argv[5]);
 
     ctx = zmq_init (1);
     if (!ctx) {
@@ -40,6 +44,15 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+#ifdef ZMQ_CRYPTO_THREADS
+    //  Spread the CURVE encryption over worker threads.
+    rc = zmq_ctx_set (ctx, ZMQ_CRYPTO_THREADS, crypto_threads);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+#endif
+
     s = zmq_socket (ctx, ZMQ_PUSH);
     if (!s) {
         printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
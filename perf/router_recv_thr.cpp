@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the rate at which a ROUTER socket receives messages, routing id
+//  frame included. <peer-count> DEALER sockets, each with a routing id of
+//  <routing-id-size> bytes, send <message-count> one-byte messages in all
+//  to the ROUTER over inproc, from another thread, so that the cost of
+//  receiving, rather than of the transport, gets measured.
+
+static int peer_count;
+static int message_count;
+
+static void send_messages (void *dealers_)
+{
+    void **dealers = static_cast<void **> (dealers_);
+    for (int i = 0; i != message_count; i++) {
+        const int rc = zmq_send (dealers[i % peer_count], "x", 1, 0);
+        if (rc < 0) {
+            printf ("error in zmq_send: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    if (argc != 4) {
+        printf ("usage: router_recv_thr <routing-id-size> <peer-count> "
+                "<message-count>\n");
+        return 1;
+    }
+    const int routing_id_size = atoi (argv[1]);
+    peer_count = atoi (argv[2]);
+    message_count = atoi (argv[3]);
+    if (routing_id_size < 3 || routing_id_size > 255 || peer_count < 1
+        || peer_count > 0xffff || message_count < 1) {
+        printf ("routing id size must be 3 to 255, peer count 1 to 65535, "
+                "and message count positive\n");
+        return 1;
+    }
+
+    void *ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    //  The inproc pipes get to hold all of the messages.
+    const int hwm = 0;
+    void *router = zmq_socket (ctx, ZMQ_ROUTER);
+    if (!router) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+    int rc = zmq_setsockopt (router, ZMQ_RCVHWM, &hwm, sizeof hwm);
+    if (rc == 0)
+        rc = zmq_bind (router, "inproc://router_recv_thr");
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    void **dealers =
+      static_cast<void **> (malloc (peer_count * sizeof (void *)));
+    //  Routing ids must not start with a zero byte.
+    unsigned char routing_id[255];
+    memset (routing_id, 'r', sizeof routing_id);
+    for (int i = 0; i != peer_count; i++) {
+        dealers[i] = zmq_socket (ctx, ZMQ_DEALER);
+        if (!dealers[i]) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return 1;
+        }
+        routing_id[routing_id_size - 2] = static_cast<unsigned char> (i >> 8);
+        routing_id[routing_id_size - 1] = static_cast<unsigned char> (i);
+        rc = zmq_setsockopt (dealers[i], ZMQ_ROUTING_ID, routing_id,
+                             routing_id_size);
+        if (rc == 0)
+            rc = zmq_setsockopt (dealers[i], ZMQ_SNDHWM, &hwm, sizeof hwm);
+        if (rc == 0)
+            rc = zmq_connect (dealers[i], "inproc://router_recv_thr");
+        if (rc != 0) {
+            printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+            return 1;
+        }
+    }
+
+    void *sender = zmq_threadstart (send_messages, dealers);
+
+    zmq_msg_t msg;
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    void *watch = zmq_stopwatch_start ();
+    for (int i = 0; i != message_count; i++) {
+        rc = zmq_msg_recv (&msg, router, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return 1;
+        }
+        if (zmq_msg_size (&msg) != static_cast<size_t> (routing_id_size)
+            || !zmq_msg_more (&msg)) {
+            printf ("routing id frame of incorrect size received\n");
+            return 1;
+        }
+        rc = zmq_msg_recv (&msg, router, 0);
+        if (rc != 1) {
+            printf ("message of incorrect size received\n");
+            return 1;
+        }
+    }
+    unsigned long elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    zmq_msg_close (&msg);
+    zmq_threadclose (sender);
+
+    for (int i = 0; i != peer_count; i++)
+        zmq_close (dealers[i]);
+    free (dealers);
+    zmq_close (router);
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return 1;
+    }
+
+    const double throughput =
+      (double) message_count / (double) elapsed * 1000000;
+
+    printf ("routing id size: %d [B]\n", routing_id_size);
+    printf ("peer count: %d\n", peer_count);
+    printf ("message count: %d\n", message_count);
+    printf ("mean throughput: %d [msg/s]\n", (int) throughput);
+
+    return 0;
+}
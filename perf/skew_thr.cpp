@@ -0,0 +1,255 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the throughput of a set of TCP connections carrying deliberately
+//  skewed traffic: the first <heavy-count> connections each carry
+//  <message-count> messages while the remaining ones carry a hundredth of
+//  that. Connections are placed on the receiver's I/O threads by number of
+//  file descriptors, so the heavy ones may well end up sharing a thread.
+//  Run with a non-zero <rebalance-ivl> to let the I/O threads even out the
+//  load at runtime.
+
+static size_t message_size;
+
+struct connection_t
+{
+    void *ctx;
+    void *s;
+    char endpoint[256];
+    int message_count;
+};
+
+static void sender (void *arg_)
+{
+    connection_t *connection = static_cast<connection_t *> (arg_);
+    int rc;
+    int i;
+    zmq_msg_t msg;
+
+    void *s = zmq_socket (connection->ctx, ZMQ_PUSH);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    rc = zmq_connect (s, connection->endpoint);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    for (i = 0; i != connection->message_count; i++) {
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+#if defined ZMQ_MAKE_VALGRIND_HAPPY
+        memset (zmq_msg_data (&msg), 0, message_size);
+#endif
+
+        rc = zmq_msg_send (&msg, s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_send: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+    }
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+static void receiver (void *arg_)
+{
+    connection_t *connection = static_cast<connection_t *> (arg_);
+    int rc;
+    int i;
+    zmq_msg_t msg;
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    for (i = 0; i != connection->message_count; i++) {
+        rc = zmq_msg_recv (&msg, connection->s, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        if (zmq_msg_size (&msg) != message_size) {
+            printf ("message of incorrect size received\n");
+            exit (1);
+        }
+    }
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    const char *bind_to;
+    int connection_count;
+    int heavy_count;
+    int message_count;
+    int io_threads = 2;
+    int rebalance_ivl = 0;
+    void *ctx;
+    void *sender_ctx;
+    connection_t *connections;
+    void **threads;
+    int rc;
+    int i;
+    void *watch;
+    unsigned long elapsed;
+    double total_count;
+    double throughput;
+    double megabits;
+
+    if (argc < 6 || argc > 8) {
+        printf ("usage: skew_thr <bind-to> <connection-count> <heavy-count> "
+                "<message-size> <message-count> [<io-threads>] "
+                "[<rebalance-ivl>]\n");
+        return 1;
+    }
+    bind_to = argv[1];
+    connection_count = atoi (argv[2]);
+    heavy_count = atoi (argv[3]);
+    message_size = atoi (argv[4]);
+    message_count = atoi (argv[5]);
+    if (argc >= 7)
+        io_threads = atoi (argv[6]);
+    if (argc >= 8)
+        rebalance_ivl = atoi (argv[7]);
+
+    ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_set (ctx, ZMQ_IO_THREADS, io_threads);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+#ifdef ZMQ_IO_THREAD_REBALANCE_IVL
+    rc = zmq_ctx_set (ctx, ZMQ_IO_THREAD_REBALANCE_IVL, rebalance_ivl);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+#endif
+
+    //  Senders get an I/O thread each, so that only the receiving side
+    //  is affected by the skew.
+    sender_ctx = zmq_ctx_new ();
+    if (!sender_ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_set (sender_ctx, ZMQ_IO_THREADS, connection_count);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    connections = static_cast<connection_t *> (
+      malloc (connection_count * sizeof (connection_t)));
+    threads =
+      static_cast<void **> (malloc (2 * connection_count * sizeof (void *)));
+    if (!connections || !threads) {
+        printf ("error in malloc\n");
+        return -1;
+    }
+
+    total_count = 0;
+    for (i = 0; i != connection_count; i++) {
+        size_t endpoint_size = sizeof (connections[i].endpoint);
+
+        connections[i].ctx = sender_ctx;
+        connections[i].message_count =
+          i < heavy_count ? message_count : message_count / 100 + 1;
+        total_count += connections[i].message_count;
+
+        connections[i].s = zmq_socket (ctx, ZMQ_PULL);
+        if (!connections[i].s) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+
+        rc = zmq_bind (connections[i].s, bind_to);
+        if (rc != 0) {
+            printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+
+        rc = zmq_getsockopt (connections[i].s, ZMQ_LAST_ENDPOINT,
+                             connections[i].endpoint, &endpoint_size);
+        if (rc != 0) {
+            printf ("error in zmq_getsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    watch = zmq_stopwatch_start ();
+
+    for (i = 0; i != connection_count; i++) {
+        threads[2 * i] = zmq_threadstart (&receiver, &connections[i]);
+        threads[2 * i + 1] = zmq_threadstart (&sender, &connections[i]);
+    }
+    for (i = 0; i != 2 * connection_count; i++)
+        zmq_threadclose (threads[i]);
+
+    elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    throughput = total_count / (double) elapsed * 1000000;
+    megabits = (throughput * message_size * 8) / 1000000;
+
+    printf ("message size: %d [B]\n", (int) message_size);
+    printf ("connections: %d (%d heavy)\n", connection_count, heavy_count);
+    printf ("io threads: %d\n", io_threads);
+    printf ("rebalance interval: %d [ms]\n", rebalance_ivl);
+    printf ("mean throughput: %d [msg/s]\n", (int) throughput);
+    printf ("mean throughput: %.3f [Mb/s]\n", megabits);
+
+    for (i = 0; i != connection_count; i++) {
+        rc = zmq_close (connections[i].s);
+        if (rc != 0) {
+            printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+    free (connections);
+    free (threads);
+
+    rc = zmq_ctx_term (sender_ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    return 0;
+}
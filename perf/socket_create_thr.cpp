@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+//  Measures how fast sockets are created and closed. Creates
+//  <socket-count> sockets of the given type, PAIR by default, keeping them
+//  all open, then closes them all. As the sockets never wait for anything,
+//  they need no file descriptors, so the socket count is not bounded by
+//  the process's limit on open files.
+
+int main (int argc, char *argv[])
+{
+    int socket_count;
+    int socket_type;
+    void *ctx;
+    void **sockets;
+    void *watch;
+    unsigned long create_elapsed;
+    unsigned long close_elapsed;
+    int rc;
+    int i;
+
+    if (argc != 2 && argc != 3) {
+        printf ("usage: socket_create_thr <socket-count> [<socket-type>]\n");
+        return 1;
+    }
+    socket_count = atoi (argv[1]);
+    socket_type = argc == 3 ? atoi (argv[2]) : ZMQ_PAIR;
+    if (socket_count < 1) {
+        printf ("socket count must be positive\n");
+        return 1;
+    }
+
+    sockets = static_cast<void **> (malloc (socket_count * sizeof (void *)));
+    if (!sockets) {
+        printf ("out of memory\n");
+        return -1;
+    }
+
+    ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_set (ctx, ZMQ_MAX_SOCKETS, socket_count);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    watch = zmq_stopwatch_start ();
+    for (i = 0; i != socket_count; i++) {
+        sockets[i] = zmq_socket (ctx, socket_type);
+        if (!sockets[i]) {
+            printf ("error in zmq_socket after %d sockets: %s\n", i,
+                    zmq_strerror (errno));
+            return -1;
+        }
+    }
+    create_elapsed = zmq_stopwatch_stop (watch);
+
+    watch = zmq_stopwatch_start ();
+    for (i = 0; i != socket_count; i++) {
+        rc = zmq_close (sockets[i]);
+        if (rc != 0) {
+            printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    close_elapsed = zmq_stopwatch_stop (watch);
+
+    free (sockets);
+
+    if (create_elapsed == 0)
+        create_elapsed = 1;
+    if (close_elapsed == 0)
+        close_elapsed = 1;
+
+    printf ("socket count: %d\n", socket_count);
+    printf ("creation throughput: %d [sockets/s]\n",
+            (int) ((double) socket_count / create_elapsed * 1000000));
+    printf ("close throughput: %d [sockets/s]\n",
+            (int) ((double) socket_count / close_elapsed * 1000000));
+
+    return 0;
+}
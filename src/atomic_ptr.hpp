@@ -232,6 +232,22 @@ struct atomic_value_t
 #endif
     }
 
+    //  Sets the value and returns the old one.
+    int xchg (const int value_) ZMQ_NOEXCEPT
+    {
+#if defined ZMQ_ATOMIC_PTR_CXX11
+        return _value.exchange (value_, std::memory_order_acq_rel);
+#else
+        return (int) (ptrdiff_t) atomic_xchg_ptr ((void **) &_value,
+                                                  (void *) (ptrdiff_t) value_
+#if defined ZMQ_ATOMIC_PTR_MUTEX
+                                                  ,
+                                                  _sync
+#endif
+        );
+#endif
+    }
+
     int load () const ZMQ_NOEXCEPT
     {
 #if defined ZMQ_ATOMIC_PTR_CXX11
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "buffer_pool.hpp"
+#include "config.hpp"
+#include "err.hpp"
+
+#include <stdlib.h>
+
+zmq::buffer_pool_t::buffer_pool_t () : _count (0)
+{
+}
+
+zmq::buffer_pool_t::~buffer_pool_t ()
+{
+    for (buffers_t::iterator it = _buffers.begin (), end = _buffers.end ();
+         it != end; ++it)
+        for (size_t i = 0; i != it->second.size (); ++i)
+            free (it->second[i]);
+}
+
+void *zmq::buffer_pool_t::allocate (buffer_pool_t *pool_, size_t size_)
+{
+    if (pool_) {
+        const buffers_t::iterator it = pool_->_buffers.find (size_);
+        if (it != pool_->_buffers.end () && !it->second.empty ()) {
+            void *const buf = it->second.back ();
+            it->second.pop_back ();
+            pool_->_count--;
+            return buf;
+        }
+    }
+
+    void *const buf = malloc (size_);
+    alloc_assert (buf);
+    return buf;
+}
+
+void zmq::buffer_pool_t::release (buffer_pool_t *pool_,
+                                  void *buf_,
+                                  size_t size_)
+{
+    if (pool_ && pool_->_count < buffer_pool_size) {
+        pool_->_buffers[size_].push_back (buf_);
+        pool_->_count++;
+        return;
+    }
+    free (buf_);
+}
@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_BUFFER_POOL_HPP_INCLUDED__
+#define __ZMQ_BUFFER_POOL_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <map>
+#include <vector>
+
+#include "macros.hpp"
+
+namespace zmq
+{
+//  Buffers the engines of an I/O thread give back while their connection
+//  is idle, kept for the next engine needing a buffer of the same size.
+//  The buffers are allocated with malloc, so that those handed over to
+//  messages can be freed anywhere. The pool itself may only be used from
+//  its I/O thread.
+
+class buffer_pool_t
+{
+  public:
+    buffer_pool_t ();
+    ~buffer_pool_t ();
+
+    //  Returns a buffer of size_ bytes, reusing a pooled one if possible.
+    //  The pool may be NULL, in which case the buffer is just allocated.
+    static void *allocate (buffer_pool_t *pool_, size_t size_);
+
+    //  Gives back a buffer of size_ bytes, freeing it if the pool is NULL
+    //  or full.
+    static void release (buffer_pool_t *pool_, void *buf_, size_t size_);
+
+  private:
+    //  Pooled buffers by size.
+    typedef std::map<size_t, std::vector<void *> > buffers_t;
+    buffers_t _buffers;
+
+    //  Number of buffers pooled, of any size.
+    size_t _count;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (buffer_pool_t)
+};
+}
+
+#endif
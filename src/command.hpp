@@ -15,6 +15,7 @@ class own_t;
 struct i_engine;
 class pipe_t;
 class socket_base_t;
+class session_base_t;
 
 //  This structure defines the commands that can be sent between threads.
 
@@ -46,6 +47,8 @@ struct command_t
         conn_failed,
         pipe_peer_stats,
         pipe_stats_publish,
+        migrate,
+        crypto_done,
         done
     } type;
 
@@ -176,6 +179,19 @@ struct command_t
             endpoint_uri_pair_t *endpoint_pair;
         } pipe_stats_publish;
 
+        //  Sent by an I/O thread to another one to hand over a session
+        //  (and its engine) that was unplugged from the sender.
+        struct
+        {
+            zmq::session_base_t *session;
+        } migrate;
+
+        //  Sent by a crypto worker thread to a session to let it know that
+        //  an asynchronous handshake step of its engine has completed.
+        struct
+        {
+        } crypto_done;
+
         //  Sent by reaper thread to the term thread when all the sockets
         //  are successfully deallocated.
         struct
@@ -0,0 +1,265 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "completion_queue.hpp"
+#include "clock.hpp"
+#include "err.hpp"
+
+#include <algorithm>
+#include <limits.h>
+
+zmq::completion_queue_t::item_t::item_t (completion_queue_t *cq_,
+                                         socket_base_t *socket_,
+                                         void *user_data_,
+                                         short events_) :
+    cq (cq_),
+    socket (socket_),
+    user_data (user_data_),
+    events (events_),
+    next (NULL),
+    queued (0),
+    removed (false)
+{
+}
+
+void zmq::completion_queue_t::item_t::command_posted ()
+{
+    //  An item already queued gets checked anyway.
+    if (queued.xchg (1) == 0)
+        cq->push (this);
+}
+
+zmq::completion_queue_t::completion_queue_t () :
+    _tag (0xCAFEC0DE),
+    _signalled (0)
+{
+}
+
+zmq::completion_queue_t::~completion_queue_t ()
+{
+    //  Mark the completion queue as dead
+    _tag = 0xdeadbeef;
+
+    //  Once unregistered, the items are not pushed anymore.
+    for (items_t::iterator it = _items.begin (), end = _items.end (); it != end;
+         ++it)
+        if (it->first->check_tag ())
+            it->first->set_mailbox_events (NULL);
+
+    for (item_t *item = _ready.xchg (NULL); item; item = item->next)
+        _check.push_back (item);
+    for (std::vector<item_t *>::iterator it = _check.begin (),
+                                         end = _check.end ();
+         it != end; ++it)
+        if ((*it)->removed)
+            LIBZMQ_DELETE (*it);
+    for (items_t::iterator it = _items.begin (), end = _items.end (); it != end;
+         ++it)
+        LIBZMQ_DELETE (it->second);
+}
+
+bool zmq::completion_queue_t::valid () const
+{
+    return _signaler.valid ();
+}
+
+bool zmq::completion_queue_t::check_tag () const
+{
+    return _tag == 0xCAFEC0DE;
+}
+
+void zmq::completion_queue_t::push (item_t *item_)
+{
+    item_t *head = NULL;
+    while (true) {
+        item_->next = head;
+        item_t *const old = _ready.cas (head, item_);
+        if (old == head)
+            break;
+        head = old;
+    }
+
+    //  The waiting thread takes the whole stack at once, so only the
+    //  sender finding it empty may have to wake it up.
+    if (!head && _signalled.xchg (1) == 0)
+        _signaler.send ();
+}
+
+void zmq::completion_queue_t::queue_check (item_t *item_)
+{
+    if (item_->queued.xchg (1) == 0)
+        _check.push_back (item_);
+}
+
+int zmq::completion_queue_t::add (socket_base_t *socket_,
+                                  void *user_data_,
+                                  short events_)
+{
+    if (_items.find (socket_) != _items.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    item_t *item =
+      new (std::nothrow) item_t (this, socket_, user_data_, events_);
+    if (!item) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    //  A socket notifies a single completion queue.
+    if (!socket_->set_mailbox_events (item)) {
+        delete item;
+        errno = EINVAL;
+        return -1;
+    }
+
+    _items.insert (items_t::value_type (socket_, item));
+
+    //  The socket may be ready already.
+    queue_check (item);
+    return 0;
+}
+
+int zmq::completion_queue_t::modify (const socket_base_t *socket_,
+                                     short events_)
+{
+    const items_t::iterator it =
+      _items.find (const_cast<socket_base_t *> (socket_));
+    if (it == _items.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    it->second->events = events_;
+    queue_check (it->second);
+    return 0;
+}
+
+int zmq::completion_queue_t::remove (socket_base_t *socket_)
+{
+    const items_t::iterator it = _items.find (socket_);
+    if (it == _items.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    item_t *item = it->second;
+    _items.erase (it);
+
+    //  Unregistering waits for any sender still notifying the item, so
+    //  the item cannot get queued anymore.
+    socket_->set_mailbox_events (NULL);
+    if (item->queued.load ())
+        item->removed = true;
+    else
+        delete item;
+    return 0;
+}
+
+int zmq::completion_queue_t::check_events (event_t *events_, int n_events_)
+{
+    //  Append the items queued by the senders, oldest first.
+    const size_t first_ready = _check.size ();
+    for (item_t *item = _ready.xchg (NULL); item; item = item->next)
+        _check.push_back (item);
+    std::reverse (_check.begin () + first_ready, _check.end ());
+
+    //  The items reported go to the end of the list, for the next wait to
+    //  check them again.
+    std::vector<item_t *> reported;
+    int found = 0;
+    int rc = 0;
+    size_t checked = 0;
+    for (; checked < _check.size () && found < n_events_; ++checked) {
+        item_t *item = _check[checked];
+        if (item->removed) {
+            delete item;
+            continue;
+        }
+
+        //  Dequeue the item before checking it, so that the commands
+        //  posted from now on queue it again.
+        item->queued.xchg (0);
+
+        size_t events_size = sizeof (uint32_t);
+        uint32_t events;
+        if (item->socket->getsockopt (ZMQ_EVENTS, &events, &events_size)
+            == -1) {
+            //  Leave the item first in the list, unless queued again.
+            if (item->queued.xchg (1) != 0)
+                ++checked;
+            rc = -1;
+            break;
+        }
+
+        if (item->events & events) {
+            events_[found].socket = item->socket;
+            events_[found].fd = retired_fd;
+            events_[found].user_data = item->user_data;
+            events_[found].events = item->events & events;
+            ++found;
+            if (item->queued.xchg (1) == 0)
+                reported.push_back (item);
+        }
+    }
+    _check.erase (_check.begin (), _check.begin () + checked);
+    _check.insert (_check.end (), reported.begin (), reported.end ());
+
+    return rc == 0 ? found : -1;
+}
+
+int zmq::completion_queue_t::wait (event_t *events_,
+                                   int n_events_,
+                                   long timeout_)
+{
+    if (_items.empty () && timeout_ < 0) {
+        //  Fail instead of trying to sleep forever
+        errno = EFAULT;
+        return -1;
+    }
+
+    zmq::clock_t clock;
+    uint64_t end = 0;
+
+    while (true) {
+        const int found = check_events (events_, n_events_);
+        if (found == -1)
+            return -1;
+        if (found) {
+            for (int i = found; i < n_events_; ++i) {
+                events_[i].socket = NULL;
+                events_[i].fd = retired_fd;
+                events_[i].user_data = NULL;
+                events_[i].events = 0;
+            }
+            return found;
+        }
+
+        //  Compute the time left to wait, if any.
+        int timeout = -1;
+        if (timeout_ == 0)
+            break;
+        if (timeout_ > 0) {
+            const uint64_t now = clock.now_ms ();
+            if (end == 0)
+                end = now + timeout_;
+            else if (now >= end)
+                break;
+            timeout =
+              static_cast<int> (std::min<uint64_t> (end - now, INT_MAX));
+        }
+
+        //  Sleep until a sender pushes onto the empty ready stack.
+        if (_signaler.wait (timeout) == 0) {
+            _signaler.recv ();
+            _signalled.xchg (0);
+        } else if (errno == EINTR)
+            return -1;
+        else
+            errno_assert (errno == EAGAIN);
+    }
+
+    errno = EAGAIN;
+    return -1;
+}
@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_COMPLETION_QUEUE_HPP_INCLUDED__
+#define __ZMQ_COMPLETION_QUEUE_HPP_INCLUDED__
+
+#include <map>
+#include <vector>
+
+#include "socket_base.hpp"
+#include "signaler.hpp"
+#include "atomic_ptr.hpp"
+#include "i_mailbox_events.hpp"
+#include "macros.hpp"
+
+namespace zmq
+{
+//  Tells which of many sockets are ready without looking at the others.
+//  Rather than every socket getting a file descriptor to poll, the senders
+//  of commands to a registered socket push it onto a lock-free stack, and
+//  only the sockets found there, plus those found ready last time, get
+//  their events checked. The queue is level-triggered: a socket is
+//  reported for as long as it is ready.
+
+class completion_queue_t
+{
+  public:
+    completion_queue_t ();
+    ~completion_queue_t ();
+
+    typedef zmq_poller_event_t event_t;
+
+    int add (socket_base_t *socket_, void *user_data_, short events_);
+    int modify (const socket_base_t *socket_, short events_);
+    int remove (socket_base_t *socket_);
+
+    int wait (event_t *events_, int n_events_, long timeout_);
+
+    int size () const { return static_cast<int> (_items.size ()); }
+
+    //  False if the signaler could not be created.
+    bool valid () const;
+
+    //  Return false if object is not a completion queue.
+    bool check_tag () const;
+
+  private:
+    struct item_t ZMQ_FINAL : public i_mailbox_events
+    {
+        item_t (completion_queue_t *cq_,
+                socket_base_t *socket_,
+                void *user_data_,
+                short events_);
+
+        //  i_mailbox_events implementation.
+        void command_posted () ZMQ_FINAL;
+
+        completion_queue_t *const cq;
+        socket_base_t *const socket;
+        void *const user_data;
+        short events;
+
+        //  Link to the next item on the ready stack.
+        item_t *next;
+
+        //  Non-zero while the item is on the ready stack or on the list of
+        //  items to check.
+        atomic_value_t queued;
+
+        //  Set when the item was removed while queued; it is deleted when
+        //  taken off the queue.
+        bool removed;
+
+        ZMQ_NON_COPYABLE_NOR_MOVABLE (item_t)
+    };
+
+    //  Pushes the item onto the ready stack. Called by the senders.
+    void push (item_t *item_);
+
+    //  Queues the item to be checked by the next wait.
+    void queue_check (item_t *item_);
+
+    //  Returns the number of events stored, or -1 on error.
+    int check_events (event_t *events_, int n_events_);
+
+    //  Used to check whether the object is a completion queue.
+    uint32_t _tag;
+
+    typedef std::map<socket_base_t *, item_t *> items_t;
+    items_t _items;
+
+    //  Items queued by the senders, most recent first.
+    atomic_ptr_t<item_t> _ready;
+
+    //  Items to check, in order.
+    std::vector<item_t *> _check;
+
+    //  Wakes up the waiting thread when the ready stack stops being empty.
+    signaler_t _signaler;
+
+    //  Non-zero while the signaler holds a signal not received yet.
+    atomic_value_t _signalled;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (completion_queue_t)
+};
+}
+
+#endif
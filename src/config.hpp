@@ -14,17 +14,14 @@ enum
     //  memory allocation by approximately 99.6%
     message_pipe_granularity = 256,
 
+    //  Number of messages a message pipe allocates memory for at first, and
+    //  again whenever its reader has caught up. Keeps the pipes of idle
+    //  connections small.
+    message_pipe_min_granularity = 16,
+
     //  Commands in pipe per allocation event.
     command_pipe_granularity = 16,
 
-    //  Determines how often does socket poll for new commands when it
-    //  still has unprocessed messages to handle. Thus, if it is set to 100,
-    //  socket will process 100 inbound messages before doing the poll.
-    //  If there are no unprocessed messages available, poll is done
-    //  immediately. Decreasing the value trades overall latency for more
-    //  real-time behaviour (less latency peaks).
-    inbound_poll_rate = 100,
-
     //  Maximal delta between high and low watermark.
     max_wm_delta = 1024,
 
@@ -36,11 +33,21 @@ enum
     //  latency and fairness.
     proxy_burst_size = 1000,
 
-    //  Maximal delay to process command in API thread (in CPU ticks).
-    //  3,000,000 ticks equals to 1 - 2 milliseconds on current CPUs.
-    //  Note that delay is only applied when there is continuous stream of
-    //  messages to process. If not so, commands are processed immediately.
-    max_command_delay = 3000000,
+    //  Time, in milliseconds, after which a connection seeing no traffic
+    //  gives its engine's buffers back to the pool of its I/O thread.
+    buffer_idle_ivl = 1000,
+
+    //  Maximal number of idle buffers an I/O thread keeps for reuse.
+    buffer_pool_size = 256,
+
+    //  Number of times a receiving socket checks for a message between
+    //  two readings of the clock while spinning (see ZMQ_RCVSPIN).
+    spin_clock_interval = 16,
+
+    //  Interval, in milliseconds, at which the reaper checks a closed
+    //  socket's commands when no file descriptor could be created to poll
+    //  its mailbox, and tries creating one again.
+    reaper_retry_ivl = 100,
 
     //  Low-precision clock precision in CPU ticks. 1ms. Value of 1000000
     //  should be OK for CPU frequencies above 1GHz. If should work
@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+
+#include <algorithm>
+#include <new>
+#include <stdio.h>
+
+#include "crypto_pool.hpp"
+#include "ctx.hpp"
+#include "err.hpp"
+
+zmq::crypto_pool_t::crypto_pool_t (const thread_ctx_t &ctx_,
+                                   int thread_count_) :
+    _fn (NULL),
+    _arg (NULL),
+    _count (0),
+    _next (0),
+    _done (0),
+    _stopping (false)
+{
+    for (int i = 0; i != thread_count_; i++) {
+        thread_t *worker = new (std::nothrow) thread_t;
+        alloc_assert (worker);
+        _workers.push_back (worker);
+
+        //  Room for the prefix and any int, sign included.
+        char name[sizeof "Crypto/" + 11] = "";
+        snprintf (name, sizeof (name), "Crypto/%d", i);
+        ctx_.start_thread (*worker, worker_routine, this, name);
+    }
+}
+
+zmq::crypto_pool_t::~crypto_pool_t ()
+{
+    {
+        scoped_lock_t locker (_sync);
+        zmq_assert (_tasks.empty ());
+        _stopping = true;
+        _job_cond.broadcast ();
+    }
+
+    for (std::vector<thread_t *>::size_type i = 0; i != _workers.size ();
+         i++) {
+        _workers[i]->stop ();
+        LIBZMQ_DELETE (_workers[i]);
+    }
+}
+
+void zmq::crypto_pool_t::run (job_fn *fn_, void *arg_, size_t count_)
+{
+    _sync.lock ();
+
+    //  Another I/O thread is using the pool; rather than waiting for it,
+    //  do the work here.
+    if (_fn != NULL) {
+        _sync.unlock ();
+        for (size_t i = 0; i != count_; i++)
+            fn_ (arg_, i);
+        return;
+    }
+
+    _fn = fn_;
+    _arg = arg_;
+    _count = count_;
+    _next = 0;
+    _done = 0;
+    _job_cond.broadcast ();
+
+    //  The caller processes indexes alongside the workers.
+    while (_next < _count) {
+        const size_t index = _next++;
+        _sync.unlock ();
+        fn_ (arg_, index);
+        _sync.lock ();
+        _done++;
+    }
+
+    while (_done < _count) {
+        const int rc = _done_cond.wait (&_sync, -1);
+        errno_assert (rc == 0);
+    }
+
+    _fn = NULL;
+    _arg = NULL;
+    _sync.unlock ();
+}
+
+void zmq::crypto_pool_t::post (task_t *task_)
+{
+    task_->done = false;
+
+    scoped_lock_t locker (_sync);
+    _tasks.push_back (task_);
+    _job_cond.broadcast ();
+}
+
+bool zmq::crypto_pool_t::done (task_t *task_)
+{
+    scoped_lock_t locker (_sync);
+    return task_->done;
+}
+
+void zmq::crypto_pool_t::cancel (task_t *task_)
+{
+    _sync.lock ();
+    const std::deque<task_t *>::iterator it =
+      std::find (_tasks.begin (), _tasks.end (), task_);
+    if (it != _tasks.end ()) {
+        _tasks.erase (it);
+        _sync.unlock ();
+        task_->notify (task_->notify_arg);
+        return;
+    }
+    while (!task_->done) {
+        const int rc = _done_cond.wait (&_sync, -1);
+        errno_assert (rc == 0);
+    }
+    _sync.unlock ();
+}
+
+void zmq::crypto_pool_t::worker_routine (void *arg_)
+{
+    static_cast<crypto_pool_t *> (arg_)->worker_loop ();
+}
+
+void zmq::crypto_pool_t::worker_loop ()
+{
+    _sync.lock ();
+    while (true) {
+        while (!_stopping && (_fn == NULL || _next == _count)
+               && _tasks.empty ()) {
+            const int rc = _job_cond.wait (&_sync, -1);
+            errno_assert (rc == 0);
+        }
+        if (_stopping)
+            break;
+
+        //  Batches come first, as an I/O thread is waiting for them.
+        if (_fn != NULL && _next != _count) {
+            job_fn *fn = _fn;
+            void *arg = _arg;
+            const size_t index = _next++;
+            _sync.unlock ();
+            fn (arg, index);
+            _sync.lock ();
+            if (++_done == _count)
+                _done_cond.broadcast ();
+            continue;
+        }
+
+        task_t *task = _tasks.front ();
+        _tasks.pop_front ();
+        _sync.unlock ();
+        task->fn (task->arg, 0);
+
+        //  Once marked as done, the task may be deallocated by its owner.
+        notify_fn *notify = task->notify;
+        void *notify_arg = task->notify_arg;
+        _sync.lock ();
+        task->done = true;
+        _done_cond.broadcast ();
+        _sync.unlock ();
+        notify (notify_arg);
+        _sync.lock ();
+    }
+    _sync.unlock ();
+}
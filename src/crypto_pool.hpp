@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_CRYPTO_POOL_HPP_INCLUDED__
+#define __ZMQ_CRYPTO_POOL_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <deque>
+#include <vector>
+
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "thread.hpp"
+
+namespace zmq
+{
+class thread_ctx_t;
+
+//  Pool of worker threads that the I/O threads use to spread the
+//  per-message cryptography of a batch of messages over several cores.
+//  A job is a function applied to each index in [0, count). The calling
+//  thread takes part in the job and does not return before all the
+//  indexes have been processed, so the caller is free to use the results
+//  in the order of its choice.
+//  The pool also runs single tasks asynchronously, for work that the
+//  I/O thread can continue without, such as the handshake cryptography.
+
+class crypto_pool_t
+{
+  public:
+    typedef void(job_fn) (void *arg_, size_t index_);
+    typedef void(notify_fn) (void *arg_);
+
+    //  Asynchronous task. The owner keeps it alive until it is complete
+    //  or cancelled, and must not post it again before that.
+    struct task_t
+    {
+        //  Work to be done, invoked as fn (arg, 0) on a worker thread.
+        job_fn *fn;
+        void *arg;
+
+        //  Invoked exactly once after the work is done or the task is
+        //  cancelled, on whichever thread got there. The task may already
+        //  be deallocated when it runs.
+        notify_fn *notify;
+        void *notify_arg;
+
+        bool done;
+    };
+
+    crypto_pool_t (const thread_ctx_t &ctx_, int thread_count_);
+
+    //  Stops and joins the worker threads.
+    ~crypto_pool_t ();
+
+    //  Runs fn_ (arg_, i) for each i in [0, count_) and waits for all of
+    //  them to complete. If the pool is already busy with a job of another
+    //  caller, the job is run on the calling thread instead.
+    void run (job_fn *fn_, void *arg_, size_t count_);
+
+    //  Queues the task to be run by one of the workers.
+    void post (task_t *task_);
+
+    //  Returns true if the work of the task has been done.
+    bool done (task_t *task_);
+
+    //  Ensures the task does not run anymore: removes it from the queue if
+    //  it has not been started yet, otherwise waits for it to complete.
+    void cancel (task_t *task_);
+
+  private:
+    static void worker_routine (void *arg_);
+
+    void worker_loop ();
+
+    std::vector<thread_t *> _workers;
+
+    //  Synchronisation of access to the current job.
+    mutex_t _sync;
+
+    //  Signaled when a new job is posted or when the pool is stopping.
+    condition_variable_t _job_cond;
+
+    //  Signaled when the last index of the current job is processed or
+    //  when a task completes.
+    condition_variable_t _done_cond;
+
+    //  Current job; _fn is NULL when the pool is idle.
+    job_fn *_fn;
+    void *_arg;
+    size_t _count;
+
+    //  Next index to hand out and number of indexes processed so far.
+    size_t _next;
+    size_t _done;
+
+    //  Tasks waiting for a worker.
+    std::deque<task_t *> _tasks;
+
+    bool _stopping;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (crypto_pool_t)
+};
+}
+
+#endif
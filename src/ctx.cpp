@@ -16,6 +16,7 @@
 #include "socket_base.hpp"
 #include "io_thread.hpp"
 #include "reaper.hpp"
+#include "crypto_pool.hpp"
 #include "pipe.hpp"
 #include "err.hpp"
 #include "msg.hpp"
@@ -55,12 +56,16 @@ zmq::ctx_t::ctx_t () :
     _starting (true),
     _terminating (false),
     _reaper (NULL),
+    _crypto_pool (NULL),
     _max_sockets (clipped_maxsocket (ZMQ_MAX_SOCKETS_DFLT)),
     _max_msgsz (INT_MAX),
     _io_thread_count (ZMQ_IO_THREADS_DFLT),
     _blocky (true),
     _ipv6 (false),
-    _zero_copy (true)
+    _zero_copy (true),
+    _rebalance_ivl (0),
+    _crypto_thread_count (0),
+    _edge_triggered (false)
 {
 #ifdef HAVE_FORK
     _pid = getpid ();
@@ -70,6 +75,10 @@ zmq::ctx_t::ctx_t () :
     _vmci_family = -1;
 #endif
 
+    //  The thread terminating the context waits on the mailbox, so create
+    //  its signaler up front, for valid () to report a failure to do so.
+    _term_mailbox.get_fd ();
+
     //  Initialise crypto library, if needed.
     zmq::random_open ();
 
@@ -107,6 +116,9 @@ zmq::ctx_t::~ctx_t ()
     //  Deallocate the reaper thread object.
     LIBZMQ_DELETE (_reaper);
 
+    //  Stop the crypto worker threads. No engine uses them any more.
+    LIBZMQ_DELETE (_crypto_pool);
+
     //  The mailboxes in _slots themselves were deallocated with their
     //  corresponding io_thread/socket objects.
 
@@ -288,6 +300,37 @@ int zmq::ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             break;
 
+        case ZMQ_IO_THREAD_REBALANCE_IVL:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _rebalance_ivl = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CRYPTO_THREADS:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _crypto_thread_count = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_ZAP_CACHE_TTL:
+            if (is_int && value >= 0) {
+                _zap_cache.set_ttl (value);
+                return 0;
+            }
+            break;
+
+        case ZMQ_EDGE_TRIGGERED:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _edge_triggered = (value != 0);
+                return 0;
+            }
+            break;
+
         default: {
             return thread_ctx_t::set (option_, optval_, optvallen_);
         }
@@ -366,6 +409,66 @@ int zmq::ctx_t::get (int option_, void *optval_, const size_t *optvallen_)
             }
             break;
 
+        case ZMQ_IO_THREAD_REBALANCE_IVL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _rebalance_ivl;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CRYPTO_THREADS:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _crypto_thread_count;
+                return 0;
+            }
+            break;
+
+        case ZMQ_ZAP_CACHE_TTL:
+            if (is_int) {
+                *value = _zap_cache.get_ttl ();
+                return 0;
+            }
+            break;
+
+        case ZMQ_EDGE_TRIGGERED:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _edge_triggered;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_STATS: {
+            //  One entry per I/O thread. Before the I/O threads are started,
+            //  they are all zeroed.
+            scoped_lock_t locker (_slot_sync);
+            _opt_sync.lock ();
+            const size_t count =
+              _starting ? _io_thread_count : _io_threads.size ();
+            _opt_sync.unlock ();
+            if (*optvallen_ < count * sizeof (zmq_io_thread_stats_t))
+                break;
+            zmq_io_thread_stats_t *stats =
+              static_cast<zmq_io_thread_stats_t *> (optval_);
+            for (size_t i = 0; i != count; i++) {
+                poller_t::stats_t thread_stats;
+                memset (&thread_stats, 0, sizeof thread_stats);
+                if (!_starting)
+                    _io_threads[i]->get_stats (&thread_stats);
+                stats[i].busy_time = thread_stats.busy_time;
+                stats[i].idle_time = thread_stats.idle_time;
+                stats[i].events = thread_stats.events;
+                stats[i].commands = thread_stats.commands;
+                stats[i].timers = thread_stats.timers;
+                stats[i].bytes_read = thread_stats.bytes_read;
+                stats[i].bytes_written = thread_stats.bytes_written;
+                stats[i].migrations = thread_stats.migrations;
+            }
+            return 0;
+        }
+
         default: {
             return thread_ctx_t::get (option_, optval_, optvallen_);
         }
@@ -395,6 +498,7 @@ bool zmq::ctx_t::start ()
     const int term_and_reaper_threads_count = 2;
     const int mazmq = _max_sockets;
     const int ios = _io_thread_count;
+    const int crypto_threads = _crypto_thread_count;
     _opt_sync.unlock ();
     const int slot_count = mazmq + ios + term_and_reaper_threads_count;
     try {
@@ -421,6 +525,16 @@ bool zmq::ctx_t::start ()
     _slots[reaper_tid] = _reaper->get_mailbox ();
     _reaper->start ();
 
+    //  Create the crypto worker threads, if requested.
+    if (crypto_threads > 0) {
+        _crypto_pool =
+          new (std::nothrow) crypto_pool_t (*this, crypto_threads);
+        if (!_crypto_pool) {
+            errno = ENOMEM;
+            goto fail_cleanup_reaper;
+        }
+    }
+
     //  Create I/O thread objects and launch them.
     _slots.resize (slot_count, NULL);
 
@@ -453,6 +567,7 @@ fail_cleanup_reaper:
     _reaper->stop ();
     delete _reaper;
     _reaper = NULL;
+    LIBZMQ_DELETE (_crypto_pool);
 
 fail_cleanup_slots:
     _slots.clear ();
@@ -523,6 +638,16 @@ zmq::object_t *zmq::ctx_t::get_reaper () const
     return _reaper;
 }
 
+zmq::crypto_pool_t *zmq::ctx_t::get_crypto_pool () const
+{
+    return _crypto_pool;
+}
+
+zmq::zap_cache_t *zmq::ctx_t::get_zap_cache ()
+{
+    return &_zap_cache;
+}
+
 zmq::thread_ctx_t::thread_ctx_t () :
     _thread_priority (ZMQ_THREAD_PRIORITY_DFLT),
     _thread_sched_policy (ZMQ_THREAD_SCHED_POLICY_DFLT)
@@ -653,14 +778,20 @@ zmq::io_thread_t *zmq::ctx_t::choose_io_thread (uint64_t affinity_)
     if (_io_threads.empty ())
         return NULL;
 
-    //  Find the I/O thread with minimum load.
+    //  Find the I/O thread with minimum load. The traffic is only measured
+    //  when rebalancing is enabled; it takes precedence over the number
+    //  of file descriptors.
+    uint32_t min_traffic = 0;
     int min_load = -1;
     io_thread_t *selected_io_thread = NULL;
     for (io_threads_t::size_type i = 0, size = _io_threads.size (); i != size;
          i++) {
         if (!affinity_ || (affinity_ & (uint64_t (1) << i))) {
+            const uint32_t traffic = _io_threads[i]->get_traffic ();
             const int load = _io_threads[i]->get_load ();
-            if (selected_io_thread == NULL || load < min_load) {
+            if (selected_io_thread == NULL || traffic < min_traffic
+                || (traffic == min_traffic && load < min_load)) {
+                min_traffic = traffic;
                 min_load = load;
                 selected_io_thread = _io_threads[i];
             }
@@ -669,6 +800,19 @@ zmq::io_thread_t *zmq::ctx_t::choose_io_thread (uint64_t affinity_)
     return selected_io_thread;
 }
 
+void zmq::ctx_t::choose_io_threads (uint64_t affinity_,
+                                    int count_,
+                                    std::vector<io_thread_t *> &io_threads_)
+{
+    io_threads_.clear ();
+    for (io_threads_t::size_type i = 0, size = _io_threads.size ();
+         i != size && io_threads_.size () != static_cast<size_t> (count_);
+         i++) {
+        if (!affinity_ || (affinity_ & (uint64_t (1) << i)))
+            io_threads_.push_back (_io_threads[i]);
+    }
+}
+
 int zmq::ctx_t::register_endpoint (const char *addr_,
                                    const endpoint_t &endpoint_)
 {
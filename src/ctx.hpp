@@ -16,6 +16,7 @@
 #include "options.hpp"
 #include "atomic_counter.hpp"
 #include "thread.hpp"
+#include "zap_cache.hpp"
 
 namespace zmq
 {
@@ -23,6 +24,7 @@ class object_t;
 class io_thread_t;
 class socket_base_t;
 class reaper_t;
+class crypto_pool_t;
 class pipe_t;
 
 //  Information associated with inproc endpoint. Note that endpoint options
@@ -104,9 +106,23 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     //  Returns NULL if no I/O thread is available.
     zmq::io_thread_t *choose_io_thread (uint64_t affinity_);
 
+    //  Fills io_threads_ with up to count_ distinct I/O threads eligible
+    //  under affinity_ (0 = all), in I/O thread index order. A negative
+    //  count_ selects every eligible I/O thread.
+    void choose_io_threads (uint64_t affinity_,
+                            int count_,
+                            std::vector<zmq::io_thread_t *> &io_threads_);
+
     //  Returns reaper thread object.
     zmq::object_t *get_reaper () const;
 
+    //  Returns the pool of crypto worker threads, or NULL if the context
+    //  has none.
+    zmq::crypto_pool_t *get_crypto_pool () const;
+
+    //  Returns the cache of ZAP replies shared by the sockets.
+    zmq::zap_cache_t *get_zap_cache ();
+
     //  Management of inproc endpoints.
     int register_endpoint (const char *addr_, const endpoint_t &endpoint_);
     int unregister_endpoint (const std::string &addr_,
@@ -176,6 +192,9 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     //  The reaper thread.
     zmq::reaper_t *_reaper;
 
+    //  Crypto worker threads. NULL if ZMQ_CRYPTO_THREADS is 0.
+    zmq::crypto_pool_t *_crypto_pool;
+
     //  I/O threads.
     typedef std::vector<zmq::io_thread_t *> io_threads_t;
     io_threads_t _io_threads;
@@ -219,6 +238,18 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     // Should we use zero copy message decoding in this context?
     bool _zero_copy;
 
+    //  Interval at which I/O threads rebalance their load, in milliseconds.
+    int _rebalance_ivl;
+
+    //  Number of crypto worker threads to launch.
+    int _crypto_thread_count;
+
+    //  Do the engines of this context poll their sockets edge-triggered?
+    bool _edge_triggered;
+
+    //  Replies of the ZAP handler, disabled unless ZMQ_ZAP_CACHE_TTL is set.
+    zap_cache_t _zap_cache;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (ctx_t)
 
 #ifdef HAVE_FORK
@@ -27,6 +27,20 @@ zmq::curve_client_t::curve_client_t (session_base_t *session_,
             options_.curve_secret_key,
             options_.curve_server_key)
 {
+    //  Offer the AEAD cipher preferred first, then the other one.
+    if (options_.curve_aead != 0) {
+        const cipher_t preferred = aead_cipher (options_.curve_aead);
+        const cipher_t other = preferred == cipher_aes256gcm
+                                 ? cipher_chacha20poly1305
+                                 : cipher_aes256gcm;
+        if (cipher_available (preferred))
+            _cipher_property = cipher_name (preferred);
+        if (cipher_available (other)) {
+            if (!_cipher_property.empty ())
+                _cipher_property += ' ';
+            _cipher_property += cipher_name (other);
+        }
+    }
 }
 
 zmq::curve_client_t::~curve_client_t ()
@@ -151,11 +165,15 @@ int zmq::curve_client_t::process_welcome (const uint8_t *msg_data_,
 
 int zmq::curve_client_t::produce_initiate (msg_t *msg_)
 {
-    const size_t metadata_length = basic_properties_len ();
+    const size_t metadata_length =
+      basic_properties_len () + cipher_property_len ();
     std::vector<unsigned char, secure_allocator_t<unsigned char> >
       metadata_plaintext (metadata_length);
 
-    add_basic_properties (&metadata_plaintext[0], metadata_length);
+    const size_t basic_length =
+      add_basic_properties (&metadata_plaintext[0], metadata_length);
+    add_cipher_property (&metadata_plaintext[basic_length],
+                         metadata_length - basic_length);
 
     const size_t msg_size =
       113 + 128 + crypto_box_BOXZEROBYTES + metadata_length;
@@ -215,6 +233,8 @@ int zmq::curve_client_t::process_ready (const uint8_t *msg_data_,
 
     rc = parse_metadata (&ready_plaintext[crypto_box_ZEROBYTES],
                          clen - crypto_box_ZEROBYTES);
+    if (rc == 0)
+        rc = accept_cipher ();
 
     if (rc == 0)
         _state = connected;
@@ -227,6 +247,24 @@ int zmq::curve_client_t::process_ready (const uint8_t *msg_data_,
     return rc;
 }
 
+int zmq::curve_client_t::accept_cipher ()
+{
+    //  A server not naming an AEAD cipher keeps CURVE's own.
+    std::vector<cipher_t> ciphers;
+    if (!peer_ciphers (&ciphers))
+        return 0;
+
+    //  Otherwise it must have chosen one of those offered.
+    if (ciphers.size () != 1
+        || _cipher_property.find (cipher_name (ciphers[0]))
+             == std::string::npos) {
+        errno = EPROTO;
+        return -1;
+    }
+    set_cipher (ciphers[0]);
+    return 0;
+}
+
 int zmq::curve_client_t::process_error (const uint8_t *msg_data_,
                                         size_t msg_size_)
 {
@@ -50,6 +50,9 @@ class curve_client_t ZMQ_FINAL : public curve_mechanism_base_t
     int process_welcome (const uint8_t *msg_data_, size_t msg_size_);
     int produce_initiate (msg_t *msg_);
     int process_ready (const uint8_t *msg_data_, size_t msg_size_);
+
+    //  Switches to the AEAD cipher the server chose, if any.
+    int accept_cipher ();
     int process_error (const uint8_t *msg_data_, size_t msg_size_);
 };
 }
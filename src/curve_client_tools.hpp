@@ -26,10 +26,9 @@ namespace zmq
 struct curve_client_tools_t
 {
     static int produce_hello (void *data_,
-                              const uint8_t *server_key_,
+                              const uint8_t *hello_precom_,
                               const uint64_t cn_nonce_,
-                              const uint8_t *cn_public_,
-                              const uint8_t *cn_secret_)
+                              const uint8_t *cn_public_)
     {
         uint8_t hello_nonce[crypto_box_NONCEBYTES];
         std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
@@ -41,9 +40,9 @@ struct curve_client_tools_t
         put_uint64 (hello_nonce + 16, cn_nonce_);
 
         //  Create Box [64 * %x0](C'->S)
-        const int rc =
-          crypto_box (hello_box, &hello_plaintext[0], hello_plaintext.size (),
-                      hello_nonce, server_key_, cn_secret_);
+        const int rc = crypto_box_afternm (hello_box, &hello_plaintext[0],
+                                           hello_plaintext.size (),
+                                           hello_nonce, hello_precom_);
         if (rc == -1)
             return -1;
 
@@ -66,7 +65,7 @@ struct curve_client_tools_t
 
     static int process_welcome (const uint8_t *msg_data_,
                                 size_t msg_size_,
-                                const uint8_t *server_key_,
+                                const uint8_t *hello_precom_,
                                 const uint8_t *cn_secret_,
                                 uint8_t *cn_server_,
                                 uint8_t *cn_cookie_,
@@ -89,9 +88,9 @@ struct curve_client_tools_t
         memcpy (welcome_nonce, "WELCOME-", 8);
         memcpy (welcome_nonce + 8, msg_data_ + 8, 16);
 
-        int rc = crypto_box_open (&welcome_plaintext[0], welcome_box,
-                                  sizeof welcome_box, welcome_nonce,
-                                  server_key_, cn_secret_);
+        int rc = crypto_box_open_afternm (&welcome_plaintext[0], welcome_box,
+                                          sizeof welcome_box, welcome_nonce,
+                                          hello_precom_);
         if (rc != 0) {
             errno = EPROTO;
             return -1;
@@ -232,19 +231,26 @@ struct curve_client_tools_t
         memset (cn_public, 0, crypto_box_PUBLICKEYBYTES);
         rc = crypto_box_keypair (cn_public, cn_secret);
         zmq_assert (rc == 0);
+
+        //  HELLO and WELCOME are both boxed between C' and S, so their
+        //  shared key is computed once. This fails for a degenerate server
+        //  key, which produce_hello reports.
+        hello_precom_rc =
+          crypto_box_beforenm (hello_precom, server_key, cn_secret);
     }
 
     int produce_hello (void *data_, const uint64_t cn_nonce_) const
     {
-        return produce_hello (data_, server_key, cn_nonce_, cn_public,
-                              cn_secret);
+        if (hello_precom_rc != 0)
+            return -1;
+        return produce_hello (data_, hello_precom, cn_nonce_, cn_public);
     }
 
     int process_welcome (const uint8_t *msg_data_,
                          size_t msg_size_,
                          uint8_t *cn_precom_)
     {
-        return process_welcome (msg_data_, msg_size_, server_key, cn_secret,
+        return process_welcome (msg_data_, msg_size_, hello_precom, cn_secret,
                                 cn_server, cn_cookie, cn_precom_);
     }
 
@@ -281,6 +287,10 @@ struct curve_client_tools_t
     //  Cookie received from server
     uint8_t cn_cookie[16 + 80];
 
+    //  Shared key of c' and S, boxing HELLO and opening WELCOME
+    uint8_t hello_precom[crypto_box_BEFORENMBYTES];
+    int hello_precom_rc;
+
   private:
     template <size_t N>
     static bool is_handshake_command (const uint8_t *msg_data_,
@@ -6,6 +6,9 @@
 #include "msg.hpp"
 #include "wire.hpp"
 #include "session_base.hpp"
+#include "crypto_pool.hpp"
+
+#include <vector>
 
 #ifdef ZMQ_HAVE_CURVE
 
@@ -51,6 +54,33 @@ int zmq::curve_mechanism_base_t::decode (msg_t *msg_)
     return rc;
 }
 
+int zmq::curve_mechanism_base_t::encode_batch (msg_t *msgs_,
+                                               size_t count_,
+                                               crypto_pool_t *pool_)
+{
+    return curve_encoding_t::encode_batch (msgs_, count_, pool_);
+}
+
+int zmq::curve_mechanism_base_t::decode_batch (msg_t *msgs_,
+                                               size_t count_,
+                                               crypto_pool_t *pool_,
+                                               size_t *decoded_)
+{
+    int error_event_code;
+    const int rc = curve_encoding_t::decode_batch (msgs_, count_, pool_,
+                                                   decoded_, &error_event_code);
+
+    //  The message that failed is left as received, so report the same
+    //  error decode would have reported for it.
+    if (-1 == rc && check_basic_command_structure (&msgs_[*decoded_]) == 0) {
+        session->get_socket ()->event_handshake_failed_protocol (
+          session->get_endpoint (), error_event_code);
+        errno = EPROTO;
+    }
+
+    return rc;
+}
+
 zmq::curve_encoding_t::curve_encoding_t (const char *encode_nonce_prefix_,
                                          const char *decode_nonce_prefix_,
                                          const bool downgrade_sub_) :
@@ -58,6 +88,7 @@ zmq::curve_encoding_t::curve_encoding_t (const char *encode_nonce_prefix_,
     _decode_nonce_prefix (decode_nonce_prefix_),
     _cn_nonce (1),
     _cn_peer_nonce (1),
+    _cipher (cipher_xsalsa20poly1305),
     _downgrade_sub (downgrade_sub_)
 {
 }
@@ -73,10 +104,55 @@ static const size_t message_command_len = sizeof (message_command) - 1;
 static const size_t message_header_len =
   message_command_len + sizeof (zmq::curve_encoding_t::nonce_t);
 
+//  Name of the handshake metadata property negotiating the AEAD cipher.
+static const char cipher_property_name[] = "Cipher";
+static const char aes256gcm_name[] = "AES-256-GCM";
+static const char chacha20poly1305_name[] = "ChaCha20-Poly1305";
+
 #ifndef ZMQ_USE_LIBSODIUM
 static const size_t crypto_box_MACBYTES = 16;
 #endif
 
+//  Total payload, in bytes, from which a batch of messages is worth
+//  spreading over the crypto worker threads.
+static const size_t parallel_batch_size = 16384;
+
+namespace
+{
+struct encrypt_batch_t
+{
+    const zmq::curve_encoding_t *encoding;
+    zmq::msg_t *msgs;
+    zmq::curve_encoding_t::nonce_t first_nonce;
+};
+
+struct decrypt_result_t
+{
+    int rc;
+    int error_event_code;
+};
+
+struct decrypt_batch_t
+{
+    const zmq::curve_encoding_t *encoding;
+    zmq::msg_t *msgs;
+    decrypt_result_t *results;
+};
+}
+
+static bool worth_parallel (const zmq::msg_t *msgs_,
+                            size_t count_,
+                            const zmq::crypto_pool_t *pool_)
+{
+    if (pool_ == NULL || count_ < 2)
+        return false;
+
+    size_t size = 0;
+    for (size_t i = 0; i != count_ && size < parallel_batch_size; i++)
+        size += msgs_[i].size ();
+    return size >= parallel_batch_size;
+}
+
 int zmq::curve_encoding_t::check_validity (msg_t *msg_, int *error_event_code_)
 {
     const size_t size = msg_->size ();
@@ -109,11 +185,42 @@ int zmq::curve_encoding_t::check_validity (msg_t *msg_, int *error_event_code_)
 }
 
 int zmq::curve_encoding_t::encode (msg_t *msg_)
+{
+    encrypt (msg_, get_and_inc_nonce ());
+    return 0;
+}
+
+int zmq::curve_encoding_t::encode_batch (msg_t *msgs_,
+                                         size_t count_,
+                                         crypto_pool_t *pool_)
+{
+    //  Nonces are handed out up front, so that they follow message order
+    //  whichever thread ends up encrypting each message.
+    encrypt_batch_t batch = {this, msgs_, _cn_nonce};
+    _cn_nonce += count_;
+
+    if (worth_parallel (msgs_, count_, pool_))
+        pool_->run (encrypt_job, &batch, count_);
+    else
+        for (size_t i = 0; i != count_; i++)
+            encrypt_job (&batch, i);
+
+    return 0;
+}
+
+void zmq::curve_encoding_t::encrypt_job (void *arg_, size_t index_)
+{
+    const encrypt_batch_t *batch = static_cast<encrypt_batch_t *> (arg_);
+    batch->encoding->encrypt (&batch->msgs[index_],
+                              batch->first_nonce + index_);
+}
+
+void zmq::curve_encoding_t::encrypt (msg_t *msg_, nonce_t nonce_) const
 {
     size_t sub_cancel_len = 0;
     uint8_t message_nonce[crypto_box_NONCEBYTES];
     memcpy (message_nonce, _encode_nonce_prefix, nonce_prefix_len);
-    put_uint64 (message_nonce + nonce_prefix_len, get_and_inc_nonce ());
+    put_uint64 (message_nonce + nonce_prefix_len, nonce_);
 
     if (msg_->is_subscribe () || msg_->is_cancel ()) {
         if (_downgrade_sub)
@@ -124,6 +231,34 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
                                : zmq::msg_t::sub_cmd_name_size;
     }
 
+    //  The box puts its MAC in front of the ciphertext, itself as long as
+    //  the plaintext, so a message with room for the header, the MAC and
+    //  the flags in front of its data is encrypted where it is.
+    const size_t prefix_len =
+      message_header_len + crypto_box_MACBYTES + flags_len + sub_cancel_len;
+    if (msg_->headroom () >= prefix_len) {
+        encrypt_in_place (msg_, message_nonce, sub_cancel_len);
+        return;
+    }
+
+    if (_cipher != cipher_xsalsa20poly1305) {
+        //  The AEAD ciphers need no zero bytes nor scratch buffer, so the
+        //  plaintext is copied straight behind the prefix of the message
+        //  sent, and sealed there.
+        msg_t msg_box;
+        int rc = msg_box.init_size (prefix_len + msg_->size ());
+        zmq_assert (rc == 0);
+        uint8_t *const message = static_cast<uint8_t *> (msg_box.data ());
+        put_flags (msg_, message + message_header_len + crypto_box_MACBYTES,
+                   sub_cancel_len);
+        if (msg_->size () > 0)
+            memcpy (message + prefix_len, msg_->data (), msg_->size ());
+        seal_aead (message, flags_len + sub_cancel_len + msg_->size (),
+                   message_nonce);
+        msg_->move (msg_box);
+        return;
+    }
+
 #ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
     const size_t mlen = flags_len + sub_cancel_len + msg_->size ();
     std::vector<uint8_t> message_plaintext (mlen);
@@ -139,23 +274,7 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
                0);
 #endif
 
-    const uint8_t flags = msg_->flags () & flag_mask;
-    message_plaintext[0] = flags;
-
-    // For backward compatibility subscribe/cancel command messages are not stored with
-    // the message flags, and are encoded in the encoder, so that messages for < 3.0 peers
-    // can be encoded in the "old" 0/1 way rather than as commands.
-    if (sub_cancel_len == 1)
-        message_plaintext[flags_len] = msg_->is_subscribe () ? 1 : 0;
-    else if (sub_cancel_len == zmq::msg_t::sub_cmd_name_size) {
-        message_plaintext[0] |= zmq::msg_t::command;
-        memcpy (&message_plaintext[flags_len], zmq::sub_cmd_name,
-                zmq::msg_t::sub_cmd_name_size);
-    } else if (sub_cancel_len == zmq::msg_t::cancel_cmd_name_size) {
-        message_plaintext[0] |= zmq::msg_t::command;
-        memcpy (&message_plaintext[flags_len], zmq::cancel_cmd_name,
-                zmq::msg_t::cancel_cmd_name_size);
-    }
+    put_flags (msg_, &message_plaintext[0], sub_cancel_len);
 
     // this is copying the data from insecure memory, so there is no point in
     // using secure_allocator_t for message_plaintext
@@ -200,17 +319,130 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
     memcpy (message, message_command, message_command_len);
     memcpy (message + message_command_len, message_nonce + nonce_prefix_len,
             sizeof (nonce_t));
+}
 
-    return 0;
+void zmq::curve_encoding_t::encrypt_in_place (msg_t *msg_,
+                                              const uint8_t *message_nonce_,
+                                              size_t sub_cancel_len_) const
+{
+    const size_t size = msg_->size ();
+    msg_->expand_front (message_header_len + crypto_box_MACBYTES + flags_len
+                        + sub_cancel_len_);
+    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
+    uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
+    put_flags (msg_, message_plaintext, sub_cancel_len_);
+
+    const size_t mlen = flags_len + sub_cancel_len_ + size;
+    if (_cipher != cipher_xsalsa20poly1305) {
+        seal_aead (message, mlen, message_nonce_);
+        return;
+    }
+
+#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
+    int rc =
+      crypto_box_easy_afternm (message + message_header_len, message_plaintext,
+                               mlen, message_nonce_, _cn_precom);
+#else
+    //  The zero bytes in front of the plaintext overlay the MAC and the
+    //  header, and those of the box the header only.
+    memset (message, 0, crypto_box_ZEROBYTES);
+    int rc = crypto_box_afternm (message, message, crypto_box_ZEROBYTES + mlen,
+                                 message_nonce_, _cn_precom);
+#endif
+    zmq_assert (rc == 0);
+
+    memcpy (message, message_command, message_command_len);
+    memcpy (message + message_command_len, message_nonce_ + nonce_prefix_len,
+            sizeof (nonce_t));
+}
+
+void zmq::curve_encoding_t::put_flags (msg_t *msg_,
+                                       uint8_t *message_plaintext_,
+                                       size_t sub_cancel_len_)
+{
+    const uint8_t flags = msg_->flags () & flag_mask;
+    message_plaintext_[0] = flags;
+
+    // For backward compatibility subscribe/cancel command messages are not stored with
+    // the message flags, and are encoded in the encoder, so that messages for < 3.0 peers
+    // can be encoded in the "old" 0/1 way rather than as commands.
+    if (sub_cancel_len_ == 1)
+        message_plaintext_[flags_len] = msg_->is_subscribe () ? 1 : 0;
+    else if (sub_cancel_len_ == zmq::msg_t::sub_cmd_name_size) {
+        message_plaintext_[0] |= zmq::msg_t::command;
+        memcpy (&message_plaintext_[flags_len], zmq::sub_cmd_name,
+                zmq::msg_t::sub_cmd_name_size);
+    } else if (sub_cancel_len_ == zmq::msg_t::cancel_cmd_name_size) {
+        message_plaintext_[0] |= zmq::msg_t::command;
+        memcpy (&message_plaintext_[flags_len], zmq::cancel_cmd_name,
+                zmq::msg_t::cancel_cmd_name_size);
+    }
 }
 
 int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
 {
-    int rc = check_validity (msg_, error_event_code_);
+    const int rc = check_validity (msg_, error_event_code_);
     if (0 != rc) {
         return rc;
     }
 
+    return decrypt (msg_, error_event_code_);
+}
+
+int zmq::curve_encoding_t::decode_batch (msg_t *msgs_,
+                                         size_t count_,
+                                         crypto_pool_t *pool_,
+                                         size_t *decoded_,
+                                         int *error_event_code_)
+{
+    //  Nonce sequence checks depend on the preceding message, so they are
+    //  made in order before any decryption starts. They do not modify the
+    //  messages.
+    size_t valid = 0;
+    int invalid_event_code = 0;
+    while (valid != count_
+           && check_validity (&msgs_[valid], &invalid_event_code) == 0)
+        valid++;
+
+    if (valid > 0) {
+        std::vector<decrypt_result_t> results (valid);
+        decrypt_batch_t batch = {this, msgs_, &results[0]};
+
+        if (worth_parallel (msgs_, valid, pool_))
+            pool_->run (decrypt_job, &batch, valid);
+        else
+            for (size_t i = 0; i != valid; i++)
+                decrypt_job (&batch, i);
+
+        for (size_t i = 0; i != valid; i++)
+            if (results[i].rc != 0) {
+                *decoded_ = i;
+                *error_event_code_ = results[i].error_event_code;
+                errno = EPROTO;
+                return -1;
+            }
+    }
+
+    *decoded_ = valid;
+    if (valid != count_) {
+        *error_event_code_ = invalid_event_code;
+        errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
+
+void zmq::curve_encoding_t::decrypt_job (void *arg_, size_t index_)
+{
+    const decrypt_batch_t *batch = static_cast<decrypt_batch_t *> (arg_);
+    decrypt_result_t &result = batch->results[index_];
+    result.rc = batch->encoding->decrypt (&batch->msgs[index_],
+                                          &result.error_event_code);
+}
+
+int zmq::curve_encoding_t::decrypt (msg_t *msg_, int *error_event_code_) const
+{
     uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
 
     uint8_t message_nonce[crypto_box_NONCEBYTES];
@@ -218,69 +450,211 @@ int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
     memcpy (message_nonce + nonce_prefix_len, message + message_command_len,
             sizeof (nonce_t));
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    const size_t clen = msg_->size () - message_header_len;
-
-    uint8_t *const message_plaintext = message + message_header_len;
+    //  The box is opened where it is, the plaintext ending up right after
+    //  the MAC, and the header, MAC and flags are then trimmed off.
+    uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
 
-    rc = crypto_box_open_easy_afternm (message_plaintext,
-                                       message + message_header_len, clen,
-                                       message_nonce, _cn_precom);
+    const size_t clen = msg_->size () - message_header_len;
+    int rc;
+    if (_cipher != cipher_xsalsa20poly1305)
+        rc = open_aead (message, clen - crypto_box_MACBYTES, message_nonce);
+    else {
+#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
+        rc = crypto_box_open_easy_afternm (message_plaintext,
+                                           message + message_header_len,
+                                           clen, message_nonce, _cn_precom);
 #else
-    const size_t clen =
-      crypto_box_BOXZEROBYTES + msg_->size () - message_header_len;
-
-    std::vector<uint8_t> message_plaintext_with_zerobytes (clen);
-    std::vector<uint8_t> message_box (clen);
-
-    std::fill (message_box.begin (),
-               message_box.begin () + crypto_box_BOXZEROBYTES, 0);
-    memcpy (&message_box[crypto_box_BOXZEROBYTES], message + message_header_len,
-            msg_->size () - message_header_len);
-
-    rc = crypto_box_open_afternm (&message_plaintext_with_zerobytes[0],
-                                  &message_box[0], clen, message_nonce,
-                                  _cn_precom);
-
-    const uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
+        //  The zero bytes expected in front of the box overlay the header,
+        //  which is put back should the box fail to open.
+        uint8_t header[crypto_box_BOXZEROBYTES];
+        memcpy (header, message, crypto_box_BOXZEROBYTES);
+        memset (message, 0, crypto_box_BOXZEROBYTES);
+
+        rc = crypto_box_open_afternm (message, message, msg_->size (),
+                                      message_nonce, _cn_precom);
+        if (rc != 0)
+            memcpy (message, header, crypto_box_BOXZEROBYTES);
 #endif
+    }
 
     if (rc == 0) {
         const uint8_t flags = message_plaintext[0];
+        msg_->trim_front (message_header_len + crypto_box_MACBYTES
+                          + flags_len);
+        msg_->set_flags (flags & flag_mask);
+    } else {
+        // CURVE I : connection key used for MESSAGE is wrong
+        *error_event_code_ = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        errno = EPROTO;
+    }
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-        const size_t plaintext_size = clen - flags_len - crypto_box_MACBYTES;
+    return rc;
+}
 
-        if (plaintext_size > 0) {
-            memmove (msg_->data (), &message_plaintext[flags_len],
-                     plaintext_size);
-        }
+void zmq::curve_encoding_t::seal_aead (uint8_t *message_,
+                                       size_t mlen_,
+                                       const uint8_t *message_nonce_) const
+{
+#ifdef ZMQ_HAVE_CURVE_AEAD
+    //  Both directions share the key, so the AEAD nonce keeps the end of
+    //  the nonce prefix, which tells them apart, along with the short nonce.
+    const uint8_t *const aead_nonce =
+      message_nonce_ + crypto_box_NONCEBYTES
+      - crypto_aead_chacha20poly1305_ietf_NPUBBYTES;
+    uint8_t *const mac = message_ + message_header_len;
+    uint8_t *const message_plaintext = mac + crypto_box_MACBYTES;
+
+    int rc;
+    if (_cipher == cipher_aes256gcm)
+        rc = crypto_aead_aes256gcm_encrypt_detached_afternm (
+          message_plaintext, mac, NULL, message_plaintext, mlen_, NULL, 0,
+          NULL, aead_nonce, &_aes256gcm_state);
+    else
+        rc = crypto_aead_chacha20poly1305_ietf_encrypt_detached (
+          message_plaintext, mac, NULL, message_plaintext, mlen_, NULL, 0,
+          NULL, aead_nonce, _aead_key);
+    zmq_assert (rc == 0);
 
-        msg_->shrink (plaintext_size);
+    memcpy (message_, message_command, message_command_len);
+    memcpy (message_ + message_command_len, message_nonce_ + nonce_prefix_len,
+            sizeof (nonce_t));
 #else
-        rc = msg_->close ();
-        zmq_assert (rc == 0);
+    LIBZMQ_UNUSED (message_);
+    LIBZMQ_UNUSED (mlen_);
+    LIBZMQ_UNUSED (message_nonce_);
+    zmq_assert (false);
+#endif
+}
+
+int zmq::curve_encoding_t::open_aead (uint8_t *message_,
+                                      size_t mlen_,
+                                      const uint8_t *message_nonce_) const
+{
+#ifdef ZMQ_HAVE_CURVE_AEAD
+    const uint8_t *const aead_nonce =
+      message_nonce_ + crypto_box_NONCEBYTES
+      - crypto_aead_chacha20poly1305_ietf_NPUBBYTES;
+    const uint8_t *const mac = message_ + message_header_len;
+    uint8_t *const message_plaintext = message_ + message_header_len
+                                       + crypto_box_MACBYTES;
+
+    if (_cipher == cipher_aes256gcm)
+        return crypto_aead_aes256gcm_decrypt_detached_afternm (
+          message_plaintext, NULL, message_plaintext, mlen_, mac, NULL, 0,
+          aead_nonce, &_aes256gcm_state);
+    return crypto_aead_chacha20poly1305_ietf_decrypt_detached (
+      message_plaintext, NULL, message_plaintext, mlen_, mac, NULL, 0,
+      aead_nonce, _aead_key);
+#else
+    LIBZMQ_UNUSED (message_);
+    LIBZMQ_UNUSED (mlen_);
+    LIBZMQ_UNUSED (message_nonce_);
+    zmq_assert (false);
+    return -1;
+#endif
+}
+
+void zmq::curve_encoding_t::set_cipher (cipher_t cipher_)
+{
+    zmq_assert (cipher_available (cipher_));
+    _cipher = cipher_;
+
+#ifdef ZMQ_HAVE_CURVE_AEAD
+    if (cipher_ == cipher_xsalsa20poly1305)
+        return;
+
+    //  The key is derived from the precomputed key of the handshake, and
+    //  differs from a cipher to the other.
+    const char *const name = cipher_ == cipher_aes256gcm
+                               ? aes256gcm_name
+                               : chacha20poly1305_name;
+    int rc = crypto_generichash (
+      _aead_key, sizeof _aead_key, reinterpret_cast<const uint8_t *> (name),
+      strlen (name), _cn_precom, sizeof _cn_precom);
+    zmq_assert (rc == 0);
 
-        rc = msg_->init_size (clen - flags_len - crypto_box_ZEROBYTES);
+    if (cipher_ == cipher_aes256gcm) {
+        rc = crypto_aead_aes256gcm_beforenm (&_aes256gcm_state, _aead_key);
         zmq_assert (rc == 0);
+        sodium_memzero (_aead_key, sizeof _aead_key);
+    }
+#endif
+}
 
-        // this is copying the data to insecure memory, so there is no point in
-        // using secure_allocator_t for message_plaintext
-        if (msg_->size () > 0) {
-            memcpy (msg_->data (), &message_plaintext[flags_len],
-                    msg_->size ());
-        }
+bool zmq::curve_encoding_t::cipher_available (cipher_t cipher_)
+{
+    switch (cipher_) {
+        case cipher_xsalsa20poly1305:
+            return true;
+#ifdef ZMQ_HAVE_CURVE_AEAD
+        case cipher_aes256gcm:
+            return crypto_aead_aes256gcm_is_available () == 1;
+        case cipher_chacha20poly1305:
+            return true;
 #endif
+        default:
+            return false;
+    }
+}
 
-        msg_->set_flags (flags & flag_mask);
-    } else {
-        // CURVE I : connection key used for MESSAGE is wrong
-        *error_event_code_ = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
-        errno = EPROTO;
+zmq::curve_encoding_t::cipher_t
+zmq::curve_mechanism_base_t::aead_cipher (int curve_aead_)
+{
+    zmq_assert (curve_aead_ == ZMQ_CURVE_AEAD_AES256GCM
+                || curve_aead_ == ZMQ_CURVE_AEAD_CHACHA20POLY1305);
+    return curve_aead_ == ZMQ_CURVE_AEAD_AES256GCM ? cipher_aes256gcm
+                                                   : cipher_chacha20poly1305;
+}
+
+const char *zmq::curve_mechanism_base_t::cipher_name (cipher_t cipher_)
+{
+    zmq_assert (cipher_ != cipher_xsalsa20poly1305);
+    return cipher_ == cipher_aes256gcm ? aes256gcm_name
+                                       : chacha20poly1305_name;
+}
+
+bool zmq::curve_mechanism_base_t::peer_ciphers (
+  std::vector<cipher_t> *ciphers_) const
+{
+    const metadata_t::dict_t &properties = get_zmtp_properties ();
+    const metadata_t::dict_t::const_iterator it =
+      properties.find (cipher_property_name);
+    if (it == properties.end ())
+        return false;
+
+    //  The names are separated by spaces.
+    const std::string &value = it->second;
+    size_t pos = 0;
+    while (pos < value.size ()) {
+        size_t end = value.find (' ', pos);
+        if (end == std::string::npos)
+            end = value.size ();
+        const std::string name = value.substr (pos, end - pos);
+        if (name == aes256gcm_name)
+            ciphers_->push_back (cipher_aes256gcm);
+        else if (name == chacha20poly1305_name)
+            ciphers_->push_back (cipher_chacha20poly1305);
+        pos = end + 1;
     }
+    return true;
+}
 
-    return rc;
+size_t zmq::curve_mechanism_base_t::cipher_property_len () const
+{
+    if (_cipher_property.empty ())
+        return 0;
+    return property_len (cipher_property_name, _cipher_property.size ());
+}
+
+size_t
+zmq::curve_mechanism_base_t::add_cipher_property (unsigned char *ptr_,
+                                                  size_t ptr_capacity_) const
+{
+    if (_cipher_property.empty ())
+        return 0;
+    return add_property (ptr_, ptr_capacity_, cipher_property_name,
+                         _cipher_property.c_str (), _cipher_property.size ());
 }
 
 #endif
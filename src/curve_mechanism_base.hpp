@@ -16,13 +16,29 @@
 #error "CURVE library not built properly"
 #endif
 
+//  libsodium 1.0.15 and later provide the AEAD constructions in detached
+//  mode, and the precomputation interface of AES-256-GCM.
+#if defined(ZMQ_USE_LIBSODIUM) && SODIUM_LIBRARY_VERSION_MAJOR >= 10
+#define ZMQ_HAVE_CURVE_AEAD 1
+#if crypto_aead_aes256gcm_ABYTES != 16                                         \
+  || crypto_aead_chacha20poly1305_ietf_ABYTES != 16                            \
+  || crypto_aead_aes256gcm_NPUBBYTES != 12                                     \
+  || crypto_aead_chacha20poly1305_ietf_NPUBBYTES != 12
+#error "CURVE library not built properly"
+#endif
+#endif
+
 #include "mechanism_base.hpp"
 #include "options.hpp"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace zmq
 {
+class crypto_pool_t;
+
 class curve_encoding_t
 {
   public:
@@ -33,17 +49,72 @@ class curve_encoding_t
     int encode (msg_t *msg_);
     int decode (msg_t *msg_, int *error_event_code_);
 
+    //  Batch variants of encode and decode. Nonces are assigned in message
+    //  order; the encryption and decryption themselves are spread over
+    //  the threads of pool_ when the batch is large enough to benefit.
+    int encode_batch (msg_t *msgs_, size_t count_, crypto_pool_t *pool_);
+    int decode_batch (msg_t *msgs_,
+                      size_t count_,
+                      crypto_pool_t *pool_,
+                      size_t *decoded_,
+                      int *error_event_code_);
+
     uint8_t *get_writable_precom_buffer () { return _cn_precom; }
     const uint8_t *get_precom_buffer () const { return _cn_precom; }
 
     typedef uint64_t nonce_t;
 
+    //  Ciphers of the data phase. The AEAD ones replace CURVE's own when
+    //  both peers agree on one during the handshake.
+    enum cipher_t
+    {
+        cipher_xsalsa20poly1305,
+        cipher_aes256gcm,
+        cipher_chacha20poly1305
+    };
+
+    //  Switches the data phase to cipher_, keyed from the precomputed
+    //  key, which must be set already.
+    void set_cipher (cipher_t cipher_);
+    cipher_t get_cipher () const { return _cipher; }
+
+    //  Whether the library, and for AES-256-GCM the CPU, support cipher_.
+    static bool cipher_available (cipher_t cipher_);
+
     nonce_t get_and_inc_nonce () { return _cn_nonce++; }
     void set_peer_nonce (nonce_t peer_nonce_) { _cn_peer_nonce = peer_nonce_; };
 
   private:
     int check_validity (msg_t *msg_, int *error_event_code_);
 
+    //  Encryption and decryption proper. These only read the state of the
+    //  encoding and can run concurrently on distinct messages.
+    void encrypt (msg_t *msg_, nonce_t nonce_) const;
+    int decrypt (msg_t *msg_, int *error_event_code_) const;
+
+    //  Encrypts a message with enough headroom without copying it.
+    void encrypt_in_place (msg_t *msg_,
+                           const uint8_t *message_nonce_,
+                           size_t sub_cancel_len_) const;
+
+    //  Seals and opens, with an AEAD cipher, the plaintext of mlen_ bytes
+    //  found after the header and the MAC of message_.
+    void seal_aead (uint8_t *message_,
+                    size_t mlen_,
+                    const uint8_t *message_nonce_) const;
+    int open_aead (uint8_t *message_,
+                   size_t mlen_,
+                   const uint8_t *message_nonce_) const;
+
+    //  Writes the flags byte, and the subscribe or cancel command name if
+    //  any, in front of the plaintext.
+    static void put_flags (msg_t *msg_,
+                           uint8_t *message_plaintext_,
+                           size_t sub_cancel_len_);
+
+    static void encrypt_job (void *arg_, size_t index_);
+    static void decrypt_job (void *arg_, size_t index_);
+
     const char *_encode_nonce_prefix;
     const char *_decode_nonce_prefix;
 
@@ -53,6 +124,14 @@ class curve_encoding_t
     //  Intermediary buffer used to speed up boxing and unboxing.
     uint8_t _cn_precom[crypto_box_BEFORENMBYTES];
 
+    cipher_t _cipher;
+
+#ifdef ZMQ_HAVE_CURVE_AEAD
+    //  Key of ChaCha20-Poly1305, and that of AES-256-GCM expanded.
+    uint8_t _aead_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES];
+    crypto_aead_aes256gcm_state _aes256gcm_state;
+#endif
+
     const bool _downgrade_sub;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (curve_encoding_t)
@@ -71,6 +150,35 @@ class curve_mechanism_base_t : public virtual mechanism_base_t,
     // mechanism implementation
     int encode (msg_t *msg_) ZMQ_OVERRIDE;
     int decode (msg_t *msg_) ZMQ_OVERRIDE;
+    int encode_batch (msg_t *msgs_,
+                      size_t count_,
+                      crypto_pool_t *pool_) ZMQ_OVERRIDE;
+    int decode_batch (msg_t *msgs_,
+                      size_t count_,
+                      crypto_pool_t *pool_,
+                      size_t *decoded_) ZMQ_OVERRIDE;
+    bool parallel_batches () const ZMQ_OVERRIDE { return true; }
+
+  protected:
+    //  Maps a ZMQ_CURVE_AEAD option value to its cipher.
+    static cipher_t aead_cipher (int curve_aead_);
+
+    //  Name of a cipher in the Cipher property.
+    static const char *cipher_name (cipher_t cipher_);
+
+    //  Fetches the ciphers named by the Cipher property of the peer, in
+    //  order, leaving out those unknown. Returns false if the peer sent
+    //  no Cipher property.
+    bool peer_ciphers (std::vector<cipher_t> *ciphers_) const;
+
+    size_t cipher_property_len () const;
+    size_t add_cipher_property (unsigned char *ptr_,
+                                size_t ptr_capacity_) const;
+
+    //  Value of the Cipher property sent in the handshake metadata: the
+    //  AEAD ciphers the client accepts, by order of preference, or the one
+    //  the server chose. Empty to keep CURVE's own cipher.
+    std::string _cipher_property;
 };
 }
 
@@ -7,11 +7,14 @@
 
 #include "msg.hpp"
 #include "session_base.hpp"
+#include "ctx.hpp"
 #include "err.hpp"
 #include "curve_server.hpp"
 #include "wire.hpp"
 #include "secure_allocator.hpp"
 
+#include <algorithm>
+
 zmq::curve_server_t::curve_server_t (session_base_t *session_,
                                      const std::string &peer_address_,
                                      const options_t &options_,
@@ -23,21 +26,29 @@ zmq::curve_server_t::curve_server_t (session_base_t *session_,
                             options_,
                             "CurveZMQMESSAGES",
                             "CurveZMQMESSAGEC",
-                            downgrade_sub_)
+                            downgrade_sub_),
+    _crypto_pool (session_->get_ctx ()->get_crypto_pool ()),
+    _step_pending (false),
+    _step_error (0)
 {
-    int rc;
     //  Fetch our secret key from socket options
     memcpy (_secret_key, options_.curve_secret_key, crypto_box_SECRETKEYBYTES);
 
-    //  Generate short-term key pair
+    //  The short-term key pair is generated along with the WELCOME.
     memset (_cn_secret, 0, crypto_box_SECRETKEYBYTES);
     memset (_cn_public, 0, crypto_box_PUBLICKEYBYTES);
-    rc = crypto_box_keypair (_cn_public, _cn_secret);
-    zmq_assert (rc == 0);
+
+    _step.fn = NULL;
+    _step.arg = this;
+    _step.notify = &session_base_t::notify_crypto_done;
+    _step.notify_arg = session_;
+    _step.done = false;
 }
 
 zmq::curve_server_t::~curve_server_t ()
 {
+    if (_step_pending)
+        _crypto_pool->cancel (&_step);
 }
 
 int zmq::curve_server_t::next_handshake_command (msg_t *msg_)
@@ -72,6 +83,14 @@ int zmq::curve_server_t::process_handshake_command (msg_t *msg_)
 {
     int rc = 0;
 
+    if (_step_pending) {
+        //  The client does not wait for our reply to the previous command.
+        session->get_socket ()->event_handshake_failed_protocol (
+          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_UNEXPECTED_COMMAND);
+        errno = EPROTO;
+        return -1;
+    }
+
     switch (state) {
         case waiting_for_hello:
             rc = process_hello (msg_);
@@ -102,6 +121,17 @@ int zmq::curve_server_t::process_handshake_command (msg_t *msg_)
     return rc;
 }
 
+int zmq::curve_server_t::crypto_done ()
+{
+    //  The notification may be meant for a previous mechanism of the
+    //  session.
+    if (!_step_pending || !_crypto_pool->done (&_step))
+        return 0;
+
+    _step_pending = false;
+    return complete_step ();
+}
+
 int zmq::curve_server_t::encode (msg_t *msg_)
 {
     zmq_assert (state == ready);
@@ -153,35 +183,39 @@ int zmq::curve_server_t::process_hello (msg_t *msg_)
     //  Save client's short-term public key (C')
     memcpy (_cn_client, hello + 80, 32);
 
-    uint8_t hello_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
-      crypto_box_ZEROBYTES + 64);
-    uint8_t hello_box[crypto_box_BOXZEROBYTES + 80];
-
-    memcpy (hello_nonce, "CurveZMQHELLO---", 16);
-    memcpy (hello_nonce + 16, hello + 112, 8);
+    memcpy (_hello_nonce, "CurveZMQHELLO---", 16);
+    memcpy (_hello_nonce + 16, hello + 112, 8);
     set_peer_nonce (get_uint64 (hello + 112));
 
-    memset (hello_box, 0, crypto_box_BOXZEROBYTES);
-    memcpy (hello_box + crypto_box_BOXZEROBYTES, hello + 120, 80);
+    memset (_hello_box, 0, crypto_box_BOXZEROBYTES);
+    memcpy (_hello_box + crypto_box_BOXZEROBYTES, hello + 120, 80);
+
+    return run_step (&hello_step);
+}
+
+int zmq::curve_server_t::open_hello ()
+{
+    //  Generate short-term key pair
+    int rc = crypto_box_keypair (_cn_public, _cn_secret);
+    zmq_assert (rc == 0);
+
+    //  C' and s are used both to open HELLO and to box WELCOME, so the
+    //  shared key is computed only once.
+    rc = crypto_box_beforenm (_hello_precom, _cn_client, _secret_key);
+    zmq_assert (rc == 0);
+
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
+      crypto_box_ZEROBYTES + 64);
 
     //  Open Box [64 * %x0](C'->S)
-    rc = crypto_box_open (&hello_plaintext[0], hello_box, sizeof hello_box,
-                          hello_nonce, _cn_client, _secret_key);
+    rc = crypto_box_open_afternm (&hello_plaintext[0], _hello_box,
+                                  sizeof _hello_box, _hello_nonce,
+                                  _hello_precom);
     if (rc != 0) {
         // CURVE I: cannot open client HELLO -- wrong server key?
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
+        return ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
     }
 
-    state = sending_welcome;
-    return rc;
-}
-
-int zmq::curve_server_t::produce_welcome (msg_t *msg_)
-{
     uint8_t cookie_nonce[crypto_secretbox_NONCEBYTES];
     std::vector<uint8_t, secure_allocator_t<uint8_t> > cookie_plaintext (
       crypto_secretbox_ZEROBYTES + 64);
@@ -204,7 +238,7 @@ int zmq::curve_server_t::produce_welcome (msg_t *msg_)
     randombytes (_cookie_key, crypto_secretbox_KEYBYTES);
 
     //  Encrypt using symmetric cookie key
-    int rc =
+    rc =
       crypto_secretbox (cookie_ciphertext, &cookie_plaintext[0],
                         cookie_plaintext.size (), cookie_nonce, _cookie_key);
     zmq_assert (rc == 0);
@@ -229,27 +263,23 @@ int zmq::curve_server_t::produce_welcome (msg_t *msg_)
     memcpy (&welcome_plaintext[crypto_box_ZEROBYTES + 48],
             cookie_ciphertext + crypto_secretbox_BOXZEROBYTES, 80);
 
-    rc = crypto_box (welcome_ciphertext, &welcome_plaintext[0],
-                     welcome_plaintext.size (), welcome_nonce, _cn_client,
-                     _secret_key);
+    rc = crypto_box_afternm (welcome_ciphertext, &welcome_plaintext[0],
+                             welcome_plaintext.size (), welcome_nonce,
+                             _hello_precom);
+    zmq_assert (rc == 0);
 
-    //  TODO I think we should change this back to zmq_assert (rc == 0);
-    //  as it was before https://github.com/zeromq/libzmq/pull/1832
-    //  The reason given there was that secret_key might be 0ed.
-    //  But if it were, we would never get this far, since we could
-    //  not have opened the client's hello box with a 0ed key.
+    memcpy (_welcome, "\x07WELCOME", 8);
+    memcpy (_welcome + 8, welcome_nonce + 8, 16);
+    memcpy (_welcome + 24, welcome_ciphertext + crypto_box_BOXZEROBYTES, 144);
 
-    if (rc == -1)
-        return -1;
+    return 0;
+}
 
-    rc = msg_->init_size (168);
+int zmq::curve_server_t::produce_welcome (msg_t *msg_)
+{
+    const int rc = msg_->init_size (sizeof _welcome);
     errno_assert (rc == 0);
-
-    uint8_t *const welcome = static_cast<uint8_t *> (msg_->data ());
-    memcpy (welcome, "\x07WELCOME", 8);
-    memcpy (welcome + 8, welcome_nonce + 8, 16);
-    memcpy (welcome + 24, welcome_ciphertext + crypto_box_BOXZEROBYTES, 144);
-
+    memcpy (msg_->data (), _welcome, sizeof _welcome);
     return 0;
 }
 
@@ -277,6 +307,18 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         return -1;
     }
 
+    set_peer_nonce (get_uint64 (initiate + 105));
+
+    _initiate.assign (initiate, initiate + size);
+
+    return run_step (&initiate_step);
+}
+
+int zmq::curve_server_t::open_initiate ()
+{
+    const size_t size = _initiate.size ();
+    const uint8_t *initiate = &_initiate[0];
+
     uint8_t cookie_nonce[crypto_secretbox_NONCEBYTES];
     uint8_t cookie_plaintext[crypto_secretbox_ZEROBYTES + 64];
     uint8_t cookie_box[crypto_secretbox_BOXZEROBYTES + 80];
@@ -288,14 +330,12 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
     memcpy (cookie_nonce, "COOKIE--", 8);
     memcpy (cookie_nonce + 8, initiate + 9, 16);
 
-    rc = crypto_secretbox_open (cookie_plaintext, cookie_box, sizeof cookie_box,
-                                cookie_nonce, _cookie_key);
+    int rc = crypto_secretbox_open (cookie_plaintext, cookie_box,
+                                    sizeof cookie_box, cookie_nonce,
+                                    _cookie_key);
     if (rc != 0) {
         // CURVE I: cannot open client INITIATE cookie
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
+        return ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
     }
 
     //  Check cookie plain text is as expected [C' + s']
@@ -306,17 +346,13 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         //  client that knows the server's secret temporary cookie key
 
         // CURVE I: client INITIATE cookie is not valid
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
+        return ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
     }
 
     const size_t clen = (size - 113) + crypto_box_BOXZEROBYTES;
 
     uint8_t initiate_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > initiate_plaintext (
-      crypto_box_ZEROBYTES + clen);
+    _initiate_plaintext.assign (crypto_box_ZEROBYTES + clen, 0);
     std::vector<uint8_t> initiate_box (crypto_box_BOXZEROBYTES + clen);
 
     //  Open Box [C + vouch + metadata](C'->S')
@@ -327,18 +363,20 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
 
     memcpy (initiate_nonce, "CurveZMQINITIATE", 16);
     memcpy (initiate_nonce + 16, initiate + 105, 8);
-    set_peer_nonce (get_uint64 (initiate + 105));
 
-    const uint8_t *client_key = &initiate_plaintext[crypto_box_ZEROBYTES];
+    //  Precompute connection secret from client key; it opens INITIATE
+    //  before it is used for the message flow.
+    rc = crypto_box_beforenm (get_writable_precom_buffer (), _cn_client,
+                              _cn_secret);
+    zmq_assert (rc == 0);
+
+    const uint8_t *client_key = &_initiate_plaintext[crypto_box_ZEROBYTES];
 
-    rc = crypto_box_open (&initiate_plaintext[0], &initiate_box[0], clen,
-                          initiate_nonce, _cn_client, _cn_secret);
+    rc = crypto_box_open_afternm (&_initiate_plaintext[0], &initiate_box[0],
+                                  clen, initiate_nonce, get_precom_buffer ());
     if (rc != 0) {
         // CURVE I: cannot open client INITIATE
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
+        return ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
     }
 
     uint8_t vouch_nonce[crypto_box_NONCEBYTES];
@@ -349,21 +387,18 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
     //  Open Box Box [C',S](C->S') and check contents
     memset (vouch_box, 0, crypto_box_BOXZEROBYTES);
     memcpy (vouch_box + crypto_box_BOXZEROBYTES,
-            &initiate_plaintext[crypto_box_ZEROBYTES + 48], 80);
+            &_initiate_plaintext[crypto_box_ZEROBYTES + 48], 80);
 
     memset (vouch_nonce, 0, crypto_box_NONCEBYTES);
     memcpy (vouch_nonce, "VOUCH---", 8);
-    memcpy (vouch_nonce + 8, &initiate_plaintext[crypto_box_ZEROBYTES + 32],
+    memcpy (vouch_nonce + 8, &_initiate_plaintext[crypto_box_ZEROBYTES + 32],
             16);
 
     rc = crypto_box_open (&vouch_plaintext[0], vouch_box, sizeof vouch_box,
                           vouch_nonce, client_key, _cn_secret);
     if (rc != 0) {
         // CURVE I: cannot open client INITIATE vouch
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
+        return ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
     }
 
     //  What we decrypted must be the client's short-term public key
@@ -372,16 +407,16 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         //  client that knows the server's secret short-term key
 
         // CURVE I: invalid handshake from client (public key)
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_KEY_EXCHANGE);
-        errno = EPROTO;
-        return -1;
+        return ZMQ_PROTOCOL_ERROR_ZMTP_KEY_EXCHANGE;
     }
 
-    //  Precompute connection secret from client key
-    rc = crypto_box_beforenm (get_writable_precom_buffer (), _cn_client,
-                              _cn_secret);
-    zmq_assert (rc == 0);
+    return 0;
+}
+
+int zmq::curve_server_t::complete_initiate ()
+{
+    const uint8_t *client_key = &_initiate_plaintext[crypto_box_ZEROBYTES];
+    int rc;
 
     //  Given this is a backward-incompatible change, it's behind a socket
     //  option disabled by default.
@@ -412,13 +447,86 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         state = sending_ready;
     }
 
-    return parse_metadata (&initiate_plaintext[crypto_box_ZEROBYTES + 128],
-                           clen - crypto_box_ZEROBYTES - 128);
+    //  The plaintext is crypto_box_ZEROBYTES longer than the box (clen)
+    const size_t clen = _initiate_plaintext.size () - crypto_box_ZEROBYTES;
+    rc = parse_metadata (&_initiate_plaintext[crypto_box_ZEROBYTES + 128],
+                         clen - crypto_box_ZEROBYTES - 128);
+    if (rc == 0)
+        choose_cipher ();
+    return rc;
+}
+
+void zmq::curve_server_t::choose_cipher ()
+{
+    std::vector<cipher_t> offered;
+    if (options.curve_aead == 0 || !peer_ciphers (&offered))
+        return;
+
+    //  Our preference comes first, then the client's.
+    const cipher_t preferred = aead_cipher (options.curve_aead);
+    std::vector<cipher_t>::const_iterator it =
+      std::find (offered.begin (), offered.end (), preferred);
+    if (it == offered.end () || !cipher_available (preferred))
+        for (it = offered.begin (); it != offered.end (); ++it)
+            if (cipher_available (*it))
+                break;
+    if (it == offered.end ())
+        return;
+
+    //  READY goes out boxed by the handshake, so the data phase can
+    //  switch right away.
+    _cipher_property = cipher_name (*it);
+    set_cipher (*it);
+}
+
+int zmq::curve_server_t::run_step (crypto_pool_t::job_fn *fn_)
+{
+    if (_crypto_pool == NULL) {
+        fn_ (this, 0);
+        return complete_step ();
+    }
+
+    //  The session stays alive until the pool notifies it.
+    _step.fn = fn_;
+    session->inc_seqnum ();
+    _crypto_pool->post (&_step);
+    _step_pending = true;
+    return 0;
+}
+
+int zmq::curve_server_t::complete_step ()
+{
+    if (_step_error != 0) {
+        session->get_socket ()->event_handshake_failed_protocol (
+          session->get_endpoint (), _step_error);
+        errno = EPROTO;
+        return -1;
+    }
+
+    if (state == waiting_for_hello) {
+        state = sending_welcome;
+        return 0;
+    }
+    zmq_assert (state == waiting_for_initiate);
+    return complete_initiate ();
+}
+
+void zmq::curve_server_t::hello_step (void *self_, size_t)
+{
+    curve_server_t *self = static_cast<curve_server_t *> (self_);
+    self->_step_error = self->open_hello ();
+}
+
+void zmq::curve_server_t::initiate_step (void *self_, size_t)
+{
+    curve_server_t *self = static_cast<curve_server_t *> (self_);
+    self->_step_error = self->open_initiate ();
 }
 
 int zmq::curve_server_t::produce_ready (msg_t *msg_)
 {
-    const size_t metadata_length = basic_properties_len ();
+    const size_t metadata_length =
+      basic_properties_len () + cipher_property_len ();
     uint8_t ready_nonce[crypto_box_NONCEBYTES];
 
     std::vector<uint8_t, secure_allocator_t<uint8_t> > ready_plaintext (
@@ -430,6 +538,8 @@ int zmq::curve_server_t::produce_ready (msg_t *msg_)
     uint8_t *ptr = &ready_plaintext[crypto_box_ZEROBYTES];
 
     ptr += add_basic_properties (ptr, metadata_length);
+    ptr += add_cipher_property (
+      ptr, metadata_length - (ptr - &ready_plaintext[crypto_box_ZEROBYTES]));
     const size_t mlen = ptr - &ready_plaintext[0];
 
     memcpy (ready_nonce, "CurveZMQREADY---", 16);
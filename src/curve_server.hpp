@@ -5,8 +5,12 @@
 
 #ifdef ZMQ_HAVE_CURVE
 
+#include <vector>
+
 #include "curve_mechanism_base.hpp"
+#include "crypto_pool.hpp"
 #include "options.hpp"
+#include "secure_allocator.hpp"
 #include "zap_client.hpp"
 
 namespace zmq
@@ -28,6 +32,7 @@ class curve_server_t ZMQ_FINAL : public zap_client_common_handshake_t,
     // mechanism implementation
     int next_handshake_command (msg_t *msg_);
     int process_handshake_command (msg_t *msg_);
+    int crypto_done ();
     int encode (msg_t *msg_);
     int decode (msg_t *msg_);
 
@@ -47,12 +52,53 @@ class curve_server_t ZMQ_FINAL : public zap_client_common_handshake_t,
     //  Key used to produce cookie
     uint8_t _cookie_key[crypto_secretbox_KEYBYTES];
 
+    //  Shared key of C' and s, opening HELLO and boxing WELCOME
+    uint8_t _hello_precom[crypto_box_BEFORENMBYTES];
+
+    //  Box [64 * %x0](C'->S) from HELLO and its nonce
+    uint8_t _hello_nonce[crypto_box_NONCEBYTES];
+    uint8_t _hello_box[crypto_box_BOXZEROBYTES + 80];
+
+    //  WELCOME command, produced when HELLO is opened
+    uint8_t _welcome[168];
+
+    //  INITIATE command and its opened Box [C + vouch + metadata](C'->S')
+    std::vector<uint8_t> _initiate;
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > _initiate_plaintext;
+
+    //  The cryptography of HELLO and INITIATE is done in a step, that
+    //  runs on the crypto pool of the context if there is one, so that
+    //  a storm of handshakes does not hold up the I/O thread.
+    crypto_pool_t *const _crypto_pool;
+    crypto_pool_t::task_t _step;
+    bool _step_pending;
+
+    //  Result of the last step: 0, or the ZMTP protocol error to report.
+    int _step_error;
+
     int process_hello (msg_t *msg_);
+    int open_hello ();
     int produce_welcome (msg_t *msg_);
     int process_initiate (msg_t *msg_);
+    int open_initiate ();
+    int complete_initiate ();
+
+    //  Picks the AEAD cipher of the data phase among those the client
+    //  offered, if any.
+    void choose_cipher ();
     int produce_ready (msg_t *msg_);
     int produce_error (msg_t *msg_) const;
 
+    //  Runs the step, on the crypto pool or in place. Returns the result
+    //  of complete_step in the latter case, 0 otherwise.
+    int run_step (crypto_pool_t::job_fn *fn_);
+
+    //  Moves the handshake on after the step has run.
+    int complete_step ();
+
+    static void hello_step (void *self_, size_t);
+    static void initiate_step (void *self_, size_t);
+
     void send_zap_request (const uint8_t *key_);
 };
 #ifdef _MSC_VER
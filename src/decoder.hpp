@@ -31,9 +31,12 @@ class decoder_base_t : public i_decoder
 {
   public:
     explicit decoder_base_t (const size_t buf_size_) :
-        _next (NULL), _read_pos (NULL), _to_read (0), _allocator (buf_size_)
+        _next (NULL),
+        _read_pos (NULL),
+        _to_read (0),
+        _allocator (buf_size_),
+        _buf (NULL)
     {
-        _buf = _allocator.allocate ();
     }
 
     ~decoder_base_t () ZMQ_OVERRIDE { _allocator.deallocate (); }
@@ -122,6 +125,17 @@ class decoder_base_t : public i_decoder
         _allocator.resize (new_size_);
     }
 
+    void set_buffer_pool (buffer_pool_t *pool_) ZMQ_FINAL
+    {
+        _allocator.set_pool (pool_);
+    }
+
+    void release_buffer () ZMQ_FINAL
+    {
+        _allocator.deallocate ();
+        _buf = NULL;
+    }
+
   protected:
     //  Prototype of state machine action. Action should return false if
     //  it is unable to push the data to the system.
@@ -11,7 +11,8 @@ zmq::shared_message_memory_allocator::shared_message_memory_allocator (
     _buf_size (0),
     _max_size (bufsize_),
     _msg_content (NULL),
-    _max_counters ((_max_size + msg_t::max_vsm_size - 1) / msg_t::max_vsm_size)
+    _max_counters ((_max_size + msg_t::max_vsm_size - 1) / msg_t::max_vsm_size),
+    _pool (NULL)
 {
 }
 
@@ -21,7 +22,8 @@ zmq::shared_message_memory_allocator::shared_message_memory_allocator (
     _buf_size (0),
     _max_size (bufsize_),
     _msg_content (NULL),
-    _max_counters (max_messages_)
+    _max_counters (max_messages_),
+    _pool (NULL)
 {
 }
 
@@ -50,12 +52,8 @@ unsigned char *zmq::shared_message_memory_allocator::allocate ()
     // if buf != NULL it is not used by any message so we can re-use it for the next run
     if (!_buf) {
         // allocate memory for reference counters together with reception buffer
-        std::size_t const allocationsize =
-          _max_size + sizeof (zmq::atomic_counter_t)
-          + _max_counters * sizeof (zmq::msg_t::content_t);
-
-        _buf = static_cast<unsigned char *> (std::malloc (allocationsize));
-        alloc_assert (_buf);
+        _buf = static_cast<unsigned char *> (
+          buffer_pool_t::allocate (_pool, allocation_size ()));
 
         new (_buf) atomic_counter_t (1);
     } else {
@@ -76,7 +74,7 @@ void zmq::shared_message_memory_allocator::deallocate ()
     zmq::atomic_counter_t *c = reinterpret_cast<zmq::atomic_counter_t *> (_buf);
     if (_buf && !c->sub (1)) {
         c->~atomic_counter_t ();
-        std::free (_buf);
+        buffer_pool_t::release (_pool, _buf, allocation_size ());
     }
     clear ();
 }
@@ -88,6 +86,12 @@ unsigned char *zmq::shared_message_memory_allocator::release ()
     return b;
 }
 
+std::size_t zmq::shared_message_memory_allocator::allocation_size () const
+{
+    return _max_size + sizeof (zmq::atomic_counter_t)
+           + _max_counters * sizeof (zmq::msg_t::content_t);
+}
+
 void zmq::shared_message_memory_allocator::clear ()
 {
     _buf = NULL;
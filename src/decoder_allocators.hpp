@@ -7,27 +7,41 @@
 #include <cstdlib>
 
 #include "atomic_counter.hpp"
+#include "buffer_pool.hpp"
 #include "msg.hpp"
 #include "err.hpp"
 
 namespace zmq
 {
-// Static buffer policy.
+// Static buffer policy. The buffer is allocated on first use, and kept
+// until deallocated.
 class c_single_allocator
 {
   public:
     explicit c_single_allocator (std::size_t bufsize_) :
-        _buf_size (bufsize_),
-        _buf (static_cast<unsigned char *> (std::malloc (_buf_size)))
+        _buf_size (bufsize_), _buf (NULL), _pool (NULL)
     {
-        alloc_assert (_buf);
     }
 
-    ~c_single_allocator () { std::free (_buf); }
+    ~c_single_allocator () { deallocate (); }
 
-    unsigned char *allocate () { return _buf; }
+    unsigned char *allocate ()
+    {
+        if (!_buf)
+            _buf = static_cast<unsigned char *> (
+              buffer_pool_t::allocate (_pool, _buf_size));
+        return _buf;
+    }
 
-    void deallocate () {}
+    void deallocate ()
+    {
+        if (_buf) {
+            buffer_pool_t::release (_pool, _buf, _buf_size);
+            _buf = NULL;
+        }
+    }
+
+    void set_pool (buffer_pool_t *pool_) { _pool = pool_; }
 
     std::size_t size () const { return _buf_size; }
 
@@ -37,6 +51,7 @@ class c_single_allocator
   private:
     std::size_t _buf_size;
     unsigned char *_buf;
+    buffer_pool_t *_pool;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (c_single_allocator)
 };
@@ -70,6 +85,10 @@ class shared_message_memory_allocator
     // force deallocation of buffer.
     void deallocate ();
 
+    // Take the buffers from the pool, and give back those no message
+    // uses. The pool may be NULL.
+    void set_pool (buffer_pool_t *pool_) { _pool = pool_; }
+
     // Give up ownership of the buffer. The buffer's lifetime is now coupled to
     // the messages constructed on top of it.
     unsigned char *release ();
@@ -95,11 +114,14 @@ class shared_message_memory_allocator
   private:
     void clear ();
 
+    std::size_t allocation_size () const;
+
     unsigned char *_buf;
     std::size_t _buf_size;
     const std::size_t _max_size;
     zmq::msg_t::content_t *_msg_content;
     std::size_t _max_counters;
+    buffer_pool_t *_pool;
 };
 }
 
@@ -155,7 +155,9 @@ void zmq::devpoll_t::loop ()
         poll_req.dp_nfds = max_io_events;
 #endif
         poll_req.dp_timeout = timeout ? timeout : -1;
+        begin_wait ();
         int n = ioctl (devpoll_fd, DP_POLL, &poll_req);
+        end_wait (n);
         if (n == -1 && errno == EINTR)
             continue;
         errno_assert (n != -1);
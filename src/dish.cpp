@@ -65,18 +65,19 @@ void zmq::dish_t::xhiccuped (pipe_t *pipe_)
 
 int zmq::dish_t::xjoin (const char *group_)
 {
-    const std::string group = std::string (group_);
+    const size_t group_size = strlen (group_);
 
-    if (group.length () > ZMQ_GROUP_MAX_LENGTH) {
+    if (group_size > ZMQ_GROUP_MAX_LENGTH) {
         errno = EINVAL;
         return -1;
     }
 
     //  User cannot join same group twice
-    if (!_subscriptions.insert (group).second) {
+    if (_subscriptions.check (group_, group_size)) {
         errno = EINVAL;
         return -1;
     }
+    _subscriptions.add (group_, group_size, NULL);
 
     msg_t msg;
     int rc = msg.init_join ();
@@ -98,14 +99,14 @@ int zmq::dish_t::xjoin (const char *group_)
 
 int zmq::dish_t::xleave (const char *group_)
 {
-    const std::string group = std::string (group_);
+    const size_t group_size = strlen (group_);
 
-    if (group.length () > ZMQ_GROUP_MAX_LENGTH) {
+    if (group_size > ZMQ_GROUP_MAX_LENGTH) {
         errno = EINVAL;
         return -1;
     }
 
-    if (0 == _subscriptions.erase (group)) {
+    if (!_subscriptions.rm (group_, group_size, NULL)) {
         errno = EINVAL;
         return -1;
     }
@@ -167,7 +168,8 @@ int zmq::dish_t::xxrecv (msg_t *msg_)
             return -1;
 
         //  Skip non matching messages
-    } while (0 == _subscriptions.count (std::string (msg_->group ())));
+    } while (
+      !_subscriptions.check (msg_->group (), strlen (msg_->group ())));
 
     //  Found a matching message
     return 0;
@@ -191,22 +193,27 @@ bool zmq::dish_t::xhas_in ()
     return true;
 }
 
-void zmq::dish_t::send_subscriptions (pipe_t *pipe_)
+void zmq::dish_t::send_subscription (const char *group_,
+                                     size_t size_,
+                                     pipe_t *unused_,
+                                     void *pipe_)
 {
-    for (subscriptions_t::iterator it = _subscriptions.begin (),
-                                   end = _subscriptions.end ();
-         it != end; ++it) {
-        msg_t msg;
-        int rc = msg.init_join ();
-        errno_assert (rc == 0);
+    LIBZMQ_UNUSED (unused_);
 
-        rc = msg.set_group (it->c_str ());
-        errno_assert (rc == 0);
+    msg_t msg;
+    int rc = msg.init_join ();
+    errno_assert (rc == 0);
 
-        //  Send it to the pipe.
-        pipe_->write (&msg);
-    }
+    rc = msg.set_group (group_, size_);
+    errno_assert (rc == 0);
+
+    //  Send it to the pipe.
+    static_cast<pipe_t *> (pipe_)->write (&msg);
+}
 
+void zmq::dish_t::send_subscriptions (pipe_t *pipe_)
+{
+    _subscriptions.apply (send_subscription, pipe_);
     pipe_->flush ();
 }
 
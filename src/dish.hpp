@@ -3,12 +3,11 @@
 #ifndef __ZMQ_DISH_HPP_INCLUDED__
 #define __ZMQ_DISH_HPP_INCLUDED__
 
-#include <string>
-
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "dist.hpp"
 #include "fq.hpp"
+#include "group_index.hpp"
 #include "msg.hpp"
 
 namespace zmq
@@ -45,15 +44,21 @@ class dish_t ZMQ_FINAL : public socket_base_t
     //  Send subscriptions to a pipe
     void send_subscriptions (pipe_t *pipe_);
 
+    //  Function to be applied to the subscriptions when sending them.
+    static void send_subscription (const char *group_,
+                                   size_t size_,
+                                   zmq::pipe_t *unused_,
+                                   void *pipe_);
+
     //  Fair queueing object for inbound pipes.
     fq_t _fq;
 
     //  Object for distributing the subscriptions upstream.
     dist_t _dist;
 
-    //  The repository of subscriptions.
-    typedef std::set<std::string> subscriptions_t;
-    subscriptions_t _subscriptions;
+    //  The repository of subscriptions. The groups are not tied to any
+    //  pipe, as they apply to all of them.
+    group_index_t _subscriptions;
 
     //  If true, 'message' contains a matching message to return on the
     //  next recv call.
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <algorithm>
 
+#include "buffer_pool.hpp"
 #include "err.hpp"
 #include "i_encoder.hpp"
 #include "msg.hpp"
@@ -33,25 +34,30 @@ template <typename T> class encoder_base_t : public i_encoder
         _next (NULL),
         _new_msg_flag (false),
         _buf_size (bufsize_),
-        _buf (static_cast<unsigned char *> (malloc (bufsize_))),
+        _buf (NULL),
+        _pool (NULL),
         _in_progress (NULL)
     {
-        alloc_assert (_buf);
     }
 
-    ~encoder_base_t () ZMQ_OVERRIDE { free (_buf); }
+    ~encoder_base_t () ZMQ_OVERRIDE { release_buffer (); }
 
     //  The function returns a batch of binary data. The data
     //  are filled to a supplied buffer. If no buffer is supplied (data_
     //  points to NULL) decoder object will provide buffer of its own.
     size_t encode (unsigned char **data_, size_t size_) ZMQ_FINAL
     {
-        unsigned char *buffer = !*data_ ? _buf : *data_;
-        const size_t buffersize = !*data_ ? _buf_size : size_;
-
         if (in_progress () == NULL)
             return 0;
 
+        //  The buffer is only allocated once there is data to encode.
+        if (!*data_ && !_buf)
+            _buf = static_cast<unsigned char *> (
+              buffer_pool_t::allocate (_pool, _buf_size));
+
+        unsigned char *buffer = !*data_ ? _buf : *data_;
+        const size_t buffersize = !*data_ ? _buf_size : size_;
+
         size_t pos = 0;
         while (pos < buffersize) {
             //  If there are no more data to return, run the state machine.
@@ -106,6 +112,16 @@ template <typename T> class encoder_base_t : public i_encoder
         (static_cast<T *> (this)->*_next) ();
     }
 
+    void set_buffer_pool (buffer_pool_t *pool_) ZMQ_FINAL { _pool = pool_; }
+
+    void release_buffer () ZMQ_FINAL
+    {
+        if (_buf) {
+            buffer_pool_t::release (_pool, _buf, _buf_size);
+            _buf = NULL;
+        }
+    }
+
   protected:
     //  Prototype of state machine action.
     typedef void (T::*step_t) ();
@@ -140,7 +156,10 @@ template <typename T> class encoder_base_t : public i_encoder
 
     //  The buffer for encoded data.
     const size_t _buf_size;
-    unsigned char *const _buf;
+    unsigned char *_buf;
+
+    //  Where to take the buffer from and give it back to.
+    buffer_pool_t *_pool;
 
     msg_t *_in_progress;
 
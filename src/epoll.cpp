@@ -68,6 +68,12 @@ zmq::epoll_t::handle_t zmq::epoll_t::add_fd (fd_t fd_, i_poll_events *events_)
     pe->ev.events = 0;
     pe->ev.data.ptr = pe;
     pe->events = events_;
+    pe->edge_triggered = false;
+    pe->pollin = false;
+    pe->pollout = false;
+    pe->in_ready = false;
+    pe->out_ready = false;
+    pe->pending = false;
 
     const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_ADD, fd_, &pe->ev);
     errno_assert (rc != -1);
@@ -87,6 +93,14 @@ void zmq::epoll_t::rm_fd (handle_t handle_)
     pe->fd = retired_fd;
     _retired.push_back (pe);
 
+    if (pe->pending) {
+        const pending_t::iterator it =
+          std::find (_pending.begin (), _pending.end (), pe);
+        if (it != _pending.end ())
+            _pending.erase (it);
+        pe->pending = false;
+    }
+
     //  Decrease the load metric of the thread.
     adjust_load (-1);
 }
@@ -95,6 +109,13 @@ void zmq::epoll_t::set_pollin (handle_t handle_)
 {
     check_thread ();
     poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+#if !defined ZMQ_HAVE_WINDOWS
+    if (pe->edge_triggered) {
+        pe->pollin = true;
+        queue_if_ready (pe);
+        return;
+    }
+#endif
     pe->ev.events |= EPOLLIN;
     const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
     errno_assert (rc != -1);
@@ -104,6 +125,12 @@ void zmq::epoll_t::reset_pollin (handle_t handle_)
 {
     check_thread ();
     poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+#if !defined ZMQ_HAVE_WINDOWS
+    if (pe->edge_triggered) {
+        pe->pollin = false;
+        return;
+    }
+#endif
     pe->ev.events &= ~(static_cast<uint32_t> (EPOLLIN));
     const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
     errno_assert (rc != -1);
@@ -113,6 +140,13 @@ void zmq::epoll_t::set_pollout (handle_t handle_)
 {
     check_thread ();
     poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+#if !defined ZMQ_HAVE_WINDOWS
+    if (pe->edge_triggered) {
+        pe->pollout = true;
+        queue_if_ready (pe);
+        return;
+    }
+#endif
     pe->ev.events |= EPOLLOUT;
     const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
     errno_assert (rc != -1);
@@ -122,11 +156,87 @@ void zmq::epoll_t::reset_pollout (handle_t handle_)
 {
     check_thread ();
     poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+#if !defined ZMQ_HAVE_WINDOWS
+    if (pe->edge_triggered) {
+        pe->pollout = false;
+        return;
+    }
+#endif
     pe->ev.events &= ~(static_cast<uint32_t> (EPOLLOUT));
     const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
     errno_assert (rc != -1);
 }
 
+#if !defined ZMQ_HAVE_WINDOWS
+void zmq::epoll_t::set_edge_triggered (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    if (pe->edge_triggered)
+        return;
+
+    pe->edge_triggered = true;
+    pe->pollin = (pe->ev.events & EPOLLIN) != 0;
+    pe->pollout = (pe->ev.events & EPOLLOUT) != 0;
+
+    //  epoll reports the events the socket is ready for right away, so the
+    //  readiness flags are set by the next wait.
+    pe->in_ready = false;
+    pe->out_ready = false;
+    pe->ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
+    errno_assert (rc != -1);
+}
+
+void zmq::epoll_t::reset_in_ready (handle_t handle_)
+{
+    check_thread ();
+    static_cast<poll_entry_t *> (handle_)->in_ready = false;
+}
+
+void zmq::epoll_t::reset_out_ready (handle_t handle_)
+{
+    check_thread ();
+    static_cast<poll_entry_t *> (handle_)->out_ready = false;
+}
+
+void zmq::epoll_t::dispatch (poll_entry_t *pe_, uint32_t events_)
+{
+    if (events_ & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        pe_->in_ready = true;
+    if (events_ & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+        pe_->out_ready = true;
+
+    //  Errors are reported whatever the entry polls for, as with the
+    //  level-triggered entries.
+    const bool error = (events_ & (EPOLLERR | EPOLLHUP)) != 0;
+    if (error)
+        pe_->events->in_event ();
+    if (pe_->fd == retired_fd)
+        return;
+    if (pe_->pollout && pe_->out_ready)
+        pe_->events->out_event ();
+    if (pe_->fd == retired_fd)
+        return;
+    if (!error && pe_->pollin && pe_->in_ready)
+        pe_->events->in_event ();
+    if (pe_->fd == retired_fd)
+        return;
+
+    queue_if_ready (pe_);
+}
+
+void zmq::epoll_t::queue_if_ready (poll_entry_t *pe_)
+{
+    if (pe_->pending)
+        return;
+    if ((pe_->pollin && pe_->in_ready) || (pe_->pollout && pe_->out_ready)) {
+        pe_->pending = true;
+        _pending.push_back (pe_);
+    }
+}
+#endif
+
 void zmq::epoll_t::stop ()
 {
     check_thread ();
@@ -153,17 +263,34 @@ void zmq::epoll_t::loop ()
             continue;
         }
 
-        //  Wait for events.
-        const int n = epoll_wait (_epoll_fd, &ev_buf[0], max_io_events,
-                                  timeout ? timeout : -1);
+        //  Wait for events. Edge-triggered entries that are still ready
+        //  are dispatched without waiting.
+        begin_wait ();
+        const int n =
+          epoll_wait (_epoll_fd, &ev_buf[0], max_io_events,
+                      !_pending.empty () ? 0 : (timeout ? timeout : -1));
         if (n == -1) {
+            end_wait (0);
             errno_assert (errno == EINTR);
             continue;
         }
 
+#if !defined ZMQ_HAVE_WINDOWS
+        end_wait (n + static_cast<int> (_pending.size ()));
+
+        //  Entries queued from now on are dispatched in the next iteration.
+        _dispatching.swap (_pending);
+        for (pending_t::iterator it = _dispatching.begin (),
+                                 end = _dispatching.end ();
+             it != end; ++it)
+            (*it)->pending = false;
+#else
+        end_wait (n);
+#endif
+
         for (int i = 0; i < n; i++) {
-            const poll_entry_t *const pe =
-              static_cast<const poll_entry_t *> (ev_buf[i].data.ptr);
+            poll_entry_t *const pe =
+              static_cast<poll_entry_t *> (ev_buf[i].data.ptr);
 
             if (NULL == pe)
                 continue;
@@ -171,6 +298,12 @@ void zmq::epoll_t::loop ()
                 continue;
             if (pe->fd == retired_fd)
                 continue;
+#if !defined ZMQ_HAVE_WINDOWS
+            if (pe->edge_triggered) {
+                dispatch (pe, ev_buf[i].events);
+                continue;
+            }
+#endif
             if (ev_buf[i].events & (EPOLLERR | EPOLLHUP))
                 pe->events->in_event ();
             if (pe->fd == retired_fd)
@@ -183,6 +316,17 @@ void zmq::epoll_t::loop ()
                 pe->events->in_event ();
         }
 
+#if !defined ZMQ_HAVE_WINDOWS
+        //  Entries queued again while handling the events reported by epoll
+        //  are left for the next iteration.
+        for (pending_t::iterator it = _dispatching.begin (),
+                                 end = _dispatching.end ();
+             it != end; ++it)
+            if ((*it)->fd != retired_fd && !(*it)->pending)
+                dispatch (*it, 0);
+        _dispatching.clear ();
+#endif
+
         //  Destroy retired event sources.
         for (retired_t::iterator it = _retired.begin (), end = _retired.end ();
              it != end; ++it) {
@@ -43,6 +43,16 @@ class epoll_t ZMQ_FINAL : public worker_poller_base_t
     void reset_pollin (handle_t handle_);
     void set_pollout (handle_t handle_);
     void reset_pollout (handle_t handle_);
+#if !defined ZMQ_HAVE_WINDOWS
+    //  Switches the file descriptor to edge-triggered polling. Changes to
+    //  POLLIN and POLLOUT then only update flags, without system calls,
+    //  and the owner has to call reset_in_ready or reset_out_ready as soon
+    //  as reading or writing would block. Until then, the poller keeps
+    //  calling its event handlers.
+    void set_edge_triggered (handle_t handle_);
+    void reset_in_ready (handle_t handle_);
+    void reset_out_ready (handle_t handle_);
+#endif
     void stop ();
 
     static int max_fds ();
@@ -70,12 +80,38 @@ class epoll_t ZMQ_FINAL : public worker_poller_base_t
         fd_t fd;
         epoll_event ev;
         zmq::i_poll_events *events;
+
+        //  State of edge-triggered entries: the events the owner polls
+        //  for, whether the socket may still be ready for them and whether
+        //  the entry is queued for dispatching.
+        bool edge_triggered;
+        bool pollin;
+        bool pollout;
+        bool in_ready;
+        bool out_ready;
+        bool pending;
     };
 
+#if !defined ZMQ_HAVE_WINDOWS
+    //  Calls the event handlers of an edge-triggered entry, given the
+    //  events reported by epoll, if any.
+    void dispatch (poll_entry_t *pe_, uint32_t events_);
+
+    //  Queues an edge-triggered entry to be dispatched again, without
+    //  waiting for epoll, if it is ready for what it polls for.
+    void queue_if_ready (poll_entry_t *pe_);
+#endif
+
     //  List of retired event sources.
     typedef std::vector<poll_entry_t *> retired_t;
     retired_t _retired;
 
+    //  Edge-triggered entries to dispatch in the next iteration of the
+    //  loop, and those being dispatched in the current one.
+    typedef std::vector<poll_entry_t *> pending_t;
+    pending_t _pending;
+    pending_t _dispatching;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (epoll_t)
 };
 
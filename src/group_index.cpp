@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include <string.h>
+
+#include "group_index.hpp"
+#include "err.hpp"
+#include "random.hpp"
+
+zmq::group_index_t::group_index_t () : _size (0), _seed (generate_random ())
+{
+}
+
+zmq::group_index_t::~group_index_t ()
+{
+}
+
+uint32_t zmq::group_index_t::hash (const char *group_, size_t size_) const
+{
+    //  FNV-1a.
+    uint32_t hash = 2166136261u ^ _seed;
+    for (size_t i = 0; i < size_; i++) {
+        hash ^= static_cast<unsigned char> (group_[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool zmq::group_index_t::equals (const entry_t &entry_,
+                                 uint32_t hash_,
+                                 const char *group_,
+                                 size_t size_)
+{
+    return entry_.hash == hash_ && entry_.size == size_
+           && memcmp (entry_.group, group_, size_) == 0;
+}
+
+void zmq::group_index_t::add (const char *group_, size_t size_, pipe_t *pipe_)
+{
+    zmq_assert (size_ <= ZMQ_GROUP_MAX_LENGTH);
+
+    //  Keep the table at most half full, so that probe sequences are short
+    //  and always end in an empty slot.
+    if ((_size + 1) * 2 > _entries.size ())
+        grow ();
+
+    const uint32_t hash = this->hash (group_, size_);
+    const size_t mask = _entries.size () - 1;
+    size_t pos = hash & mask;
+    while (_entries[pos].used)
+        pos = (pos + 1) & mask;
+
+    entry_t &entry = _entries[pos];
+    entry.pipe = pipe_;
+    entry.hash = hash;
+    entry.used = true;
+    entry.size = static_cast<unsigned char> (size_);
+    memcpy (entry.group, group_, size_);
+    _size++;
+}
+
+bool zmq::group_index_t::rm (const char *group_, size_t size_, pipe_t *pipe_)
+{
+    if (_size == 0)
+        return false;
+
+    const uint32_t hash = this->hash (group_, size_);
+    const size_t mask = _entries.size () - 1;
+    for (size_t pos = hash & mask; _entries[pos].used;
+         pos = (pos + 1) & mask) {
+        if (_entries[pos].pipe == pipe_
+            && equals (_entries[pos], hash, group_, size_)) {
+            erase (pos);
+            return true;
+        }
+    }
+    return false;
+}
+
+void zmq::group_index_t::rm (pipe_t *pipe_)
+{
+    //  Erasing may move an entry that has not been visited yet into the
+    //  current slot, so the slot is checked again.
+    for (size_t pos = 0; pos < _entries.size ();) {
+        if (_entries[pos].used && _entries[pos].pipe == pipe_)
+            erase (pos);
+        else
+            pos++;
+    }
+}
+
+bool zmq::group_index_t::check (const char *group_, size_t size_) const
+{
+    if (_size == 0)
+        return false;
+
+    const uint32_t hash = this->hash (group_, size_);
+    const size_t mask = _entries.size () - 1;
+    for (size_t pos = hash & mask; _entries[pos].used; pos = (pos + 1) & mask)
+        if (equals (_entries[pos], hash, group_, size_))
+            return true;
+    return false;
+}
+
+void zmq::group_index_t::match (const char *group_,
+                                size_t size_,
+                                void (*func_) (pipe_t *pipe_, void *arg_),
+                                void *arg_) const
+{
+    if (_size == 0)
+        return;
+
+    const uint32_t hash = this->hash (group_, size_);
+    const size_t mask = _entries.size () - 1;
+    for (size_t pos = hash & mask; _entries[pos].used; pos = (pos + 1) & mask)
+        if (equals (_entries[pos], hash, group_, size_))
+            func_ (_entries[pos].pipe, arg_);
+}
+
+void zmq::group_index_t::apply (void (*func_) (const char *group_,
+                                               size_t size_,
+                                               pipe_t *pipe_,
+                                               void *arg_),
+                                void *arg_) const
+{
+    for (entries_t::const_iterator it = _entries.begin (),
+                                   end = _entries.end ();
+         it != end; ++it)
+        if (it->used)
+            func_ (it->group, it->size, it->pipe, arg_);
+}
+
+size_t zmq::group_index_t::size () const
+{
+    return _size;
+}
+
+void zmq::group_index_t::erase (size_t pos_)
+{
+    const size_t mask = _entries.size () - 1;
+    size_t hole = pos_;
+    for (size_t pos = (pos_ + 1) & mask; _entries[pos].used;
+         pos = (pos + 1) & mask) {
+        //  An entry can fill the hole unless its home slot lies between the
+        //  hole and the entry itself.
+        const size_t home = _entries[pos].hash & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            _entries[hole] = _entries[pos];
+            hole = pos;
+        }
+    }
+    _entries[hole].used = false;
+    _size--;
+}
+
+void zmq::group_index_t::grow ()
+{
+    const size_t capacity = _entries.empty () ? 16 : _entries.size () * 2;
+    entries_t entries (capacity);
+    const size_t mask = capacity - 1;
+
+    for (entries_t::const_iterator it = _entries.begin (),
+                                   end = _entries.end ();
+         it != end; ++it) {
+        if (!it->used)
+            continue;
+        size_t pos = it->hash & mask;
+        while (entries[pos].used)
+            pos = (pos + 1) & mask;
+        entries[pos] = *it;
+    }
+
+    _entries.swap (entries);
+}
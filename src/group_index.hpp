@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_GROUP_INDEX_HPP_INCLUDED__
+#define __ZMQ_GROUP_INDEX_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+
+#include "../include/zmq.h"
+#include "macros.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+class pipe_t;
+
+//  Index of RADIO/DISH group subscriptions. It is a flat hash table of
+//  (group, pipe) pairs with the group bytes stored inline, so that matching
+//  a message against it neither allocates nor chases pointers. Collisions
+//  are resolved by linear probing and removals shift the following entries
+//  back instead of leaving tombstones. Memory is only allocated when the
+//  table grows.
+
+class group_index_t
+{
+  public:
+    group_index_t ();
+    ~group_index_t ();
+
+    //  Adds the (group, pipe) pair. The same pair may be added several
+    //  times. The group must be at most ZMQ_GROUP_MAX_LENGTH bytes long.
+    void add (const char *group_, size_t size_, pipe_t *pipe_);
+
+    //  Removes one instance of the (group, pipe) pair. Returns false if
+    //  there was none.
+    bool rm (const char *group_, size_t size_, pipe_t *pipe_);
+
+    //  Removes all the pairs with the pipe.
+    void rm (pipe_t *pipe_);
+
+    //  Checks whether there is any pair with the group.
+    bool check (const char *group_, size_t size_) const;
+
+    //  Applies the function to the pipe of each pair with the group.
+    void match (const char *group_,
+                size_t size_,
+                void (*func_) (pipe_t *pipe_, void *arg_),
+                void *arg_) const;
+
+    //  Applies the function to each pair.
+    void apply (void (*func_) (const char *group_,
+                               size_t size_,
+                               pipe_t *pipe_,
+                               void *arg_),
+                void *arg_) const;
+
+    size_t size () const;
+
+  private:
+    struct entry_t
+    {
+        pipe_t *pipe;
+        uint32_t hash;
+        bool used;
+        unsigned char size;
+        char group[ZMQ_GROUP_MAX_LENGTH];
+    };
+
+    uint32_t hash (const char *group_, size_t size_) const;
+
+    //  Returns true if the entry holds the group.
+    static bool
+    equals (const entry_t &entry_, uint32_t hash_, const char *group_,
+            size_t size_);
+
+    //  Empties the slot at the position and moves the entries that probed
+    //  past it back, so that probe sequences stay unbroken.
+    void erase (size_t pos_);
+
+    //  Doubles the size of the table.
+    void grow ();
+
+    typedef std::vector<entry_t> entries_t;
+    entries_t _entries;
+
+    //  Number of pairs in the table.
+    size_t _size;
+
+    //  Seed of the hash function, so that peers cannot choose groups that
+    //  collide.
+    const uint32_t _seed;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (group_index_t)
+};
+}
+
+#endif
@@ -9,6 +9,7 @@
 namespace zmq
 {
 class msg_t;
+class buffer_pool_t;
 
 //  Interface to be implemented by message decoder.
 
@@ -28,6 +29,13 @@ class i_decoder
     decode (const unsigned char *data_, size_t size_, size_t &processed_) = 0;
 
     virtual msg_t *msg () = 0;
+
+    //  Has the decoder take its buffers from the pool, which may be NULL.
+    virtual void set_buffer_pool (buffer_pool_t *pool_) = 0;
+
+    //  Gives the buffer back to the pool, unless messages still use it.
+    //  The next call to get_buffer allocates another one.
+    virtual void release_buffer () = 0;
 };
 }
 
@@ -10,6 +10,7 @@ namespace zmq
 {
 //  Forward declaration
 class msg_t;
+class buffer_pool_t;
 
 //  Interface to be implemented by message encoder.
 
@@ -25,6 +26,13 @@ struct i_encoder
 
     //  Load a new message into encoder.
     virtual void load_msg (msg_t *msg_) = 0;
+
+    //  Has the encoder take its buffer from the pool, which may be NULL.
+    virtual void set_buffer_pool (buffer_pool_t *pool_) = 0;
+
+    //  Gives the buffer back to the pool. The encoder allocates another
+    //  one once there is data to encode.
+    virtual void release_buffer () = 0;
 };
 }
 
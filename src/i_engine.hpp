@@ -48,7 +48,26 @@ struct i_engine
 
     virtual void zap_msg_available () = 0;
 
+    //  This method is called by the session to signalise that a handshake
+    //  step run on the crypto pool has completed.
+    virtual void crypto_done () {}
+
     virtual const endpoint_uri_pair_t &get_endpoint () const = 0;
+
+    //  Returns true if the engine is in a state where it can be moved,
+    //  along with its session, to another I/O thread.
+    virtual bool migratable () const { return false; }
+
+    //  Detach the engine from the poller of its current I/O thread,
+    //  keeping the connection state intact.
+    virtual void migrate_out () {}
+
+    //  Attach the engine, previously detached using migrate_out, to the
+    //  poller of the I/O thread it is now running in.
+    virtual void migrate_in (zmq::io_thread_t *io_thread_)
+    {
+        LIBZMQ_UNUSED (io_thread_);
+    }
 };
 }
 
@@ -5,6 +5,7 @@
 
 #include "macros.hpp"
 #include "stdint.hpp"
+#include "i_mailbox_events.hpp"
 
 namespace zmq
 {
@@ -18,6 +19,18 @@ class i_mailbox
     virtual void send (const command_t &cmd_) = 0;
     virtual int recv (command_t *cmd_, int timeout_) = 0;
 
+    //  Like recv with no timeout, but without any system call, for callers
+    //  that keep polling the mailbox.
+    virtual int try_recv (command_t *cmd_) = 0;
+
+    //  Returns false if recv with no timeout is bound to find no command.
+    //  Costs no more than reading a flag.
+    virtual bool pending () const = 0;
+
+    //  Registers the object to notify whenever the reader has to be woken
+    //  up, or unregisters it if NULL. Returns false if another object is
+    //  registered already.
+    virtual bool set_events (i_mailbox_events *events_) = 0;
 
 #ifdef HAVE_FORK
     // close the file descriptors in the signaller. This is used in a forked
@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_I_MAILBOX_EVENTS_HPP_INCLUDED__
+#define __ZMQ_I_MAILBOX_EVENTS_HPP_INCLUDED__
+
+#include "macros.hpp"
+
+namespace zmq
+{
+//  Virtual interface to be exposed by objects that want to be notified
+//  about the commands posted to a mailbox.
+
+struct i_mailbox_events
+{
+    virtual ~i_mailbox_events () ZMQ_DEFAULT;
+
+    //  Called by the sender of a command when the mailbox's reader has to
+    //  be woken up, that is at most once between two reads of the mailbox.
+    //  The mailbox is locked meanwhile.
+    virtual void command_posted () = 0;
+};
+}
+
+#endif
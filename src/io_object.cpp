@@ -4,6 +4,7 @@
 #include "io_object.hpp"
 #include "io_thread.hpp"
 #include "err.hpp"
+#include "macros.hpp"
 
 zmq::io_object_t::io_object_t (io_thread_t *io_thread_) : _poller (NULL)
 {
@@ -63,6 +64,35 @@ void zmq::io_object_t::reset_pollout (handle_t handle_)
     _poller->reset_pollout (handle_);
 }
 
+bool zmq::io_object_t::set_edge_triggered (handle_t handle_)
+{
+#if defined ZMQ_IOTHREAD_POLLER_USE_EPOLL && !defined ZMQ_HAVE_WINDOWS
+    _poller->set_edge_triggered (handle_);
+    return true;
+#else
+    LIBZMQ_UNUSED (handle_);
+    return false;
+#endif
+}
+
+void zmq::io_object_t::reset_in_ready (handle_t handle_)
+{
+#if defined ZMQ_IOTHREAD_POLLER_USE_EPOLL && !defined ZMQ_HAVE_WINDOWS
+    _poller->reset_in_ready (handle_);
+#else
+    LIBZMQ_UNUSED (handle_);
+#endif
+}
+
+void zmq::io_object_t::reset_out_ready (handle_t handle_)
+{
+#if defined ZMQ_IOTHREAD_POLLER_USE_EPOLL && !defined ZMQ_HAVE_WINDOWS
+    _poller->reset_out_ready (handle_);
+#else
+    LIBZMQ_UNUSED (handle_);
+#endif
+}
+
 void zmq::io_object_t::add_timer (int timeout_, int id_)
 {
     _poller->add_timer (timeout_, this, id_);
@@ -73,6 +103,16 @@ void zmq::io_object_t::cancel_timer (int id_)
     _poller->cancel_timer (this, id_);
 }
 
+void zmq::io_object_t::count_bytes_read (size_t count_)
+{
+    _poller->count_bytes_read (count_);
+}
+
+void zmq::io_object_t::count_bytes_written (size_t count_)
+{
+    _poller->count_bytes_written (count_);
+}
+
 void zmq::io_object_t::in_event ()
 {
     zmq_assert (false);
@@ -38,9 +38,20 @@ class io_object_t : public i_poll_events
     void reset_pollin (handle_t handle_);
     void set_pollout (handle_t handle_);
     void reset_pollout (handle_t handle_);
+
+    //  Edge-triggered polling, where the poller supports it. Returns false
+    //  if it does not; the other two methods are then no-ops.
+    bool set_edge_triggered (handle_t handle_);
+    void reset_in_ready (handle_t handle_);
+    void reset_out_ready (handle_t handle_);
+
     void add_timer (int timeout_, int id_);
     void cancel_timer (int id_);
 
+    //  Account for the bytes transferred in the I/O thread's statistics.
+    void count_bytes_read (size_t count_);
+    void count_bytes_written (size_t count_);
+
     //  i_poll_events interface implementation.
     void in_event () ZMQ_OVERRIDE;
     void out_event () ZMQ_OVERRIDE;
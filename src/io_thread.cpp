@@ -8,10 +8,13 @@
 #include "io_thread.hpp"
 #include "err.hpp"
 #include "ctx.hpp"
+#include "likely.hpp"
+#include "session_base.hpp"
 
 zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_) :
     object_t (ctx_, tid_),
-    _mailbox_handle (static_cast<poller_t::handle_t> (NULL))
+    _mailbox_handle (static_cast<poller_t::handle_t> (NULL)),
+    _rebalance_ivl (ctx_->get (ZMQ_IO_THREAD_REBALANCE_IVL))
 {
     _poller = new (std::nothrow) poller_t (*ctx_);
     alloc_assert (_poller);
@@ -32,6 +35,8 @@ void zmq::io_thread_t::start ()
     char name[16] = "";
     snprintf (name, sizeof (name), "IO/%u",
               get_tid () - zmq::ctx_t::reaper_tid - 1);
+    if (_rebalance_ivl > 0)
+        _poller->add_timer (_rebalance_ivl, this, rebalance_timer_id);
     //  Start the underlying I/O thread.
     _poller->start (name);
 }
@@ -58,14 +63,25 @@ void zmq::io_thread_t::in_event ()
 
     command_t cmd;
     int rc = _mailbox.recv (&cmd, 0);
+    uint64_t count = 0;
 
     while (rc == 0 || errno == EINTR) {
-        if (rc == 0)
-            cmd.destination->process_command (cmd);
+        if (rc == 0) {
+            count++;
+            //  Objects migrated to another I/O thread are still addressed
+            //  here. Pass their commands on; being funnelled through this
+            //  mailbox, they keep their order.
+            const uint32_t exec_tid = cmd.destination->get_exec_tid ();
+            if (unlikely (exec_tid != get_tid ()))
+                get_ctx ()->send_command (exec_tid, cmd);
+            else
+                cmd.destination->process_command (cmd);
+        }
         rc = _mailbox.recv (&cmd, 0);
     }
 
     errno_assert (rc != 0 && errno == EAGAIN);
+    _poller->count_commands (count);
 }
 
 void zmq::io_thread_t::out_event ()
@@ -74,10 +90,89 @@ void zmq::io_thread_t::out_event ()
     zmq_assert (false);
 }
 
-void zmq::io_thread_t::timer_event (int)
+void zmq::io_thread_t::timer_event (int id_)
 {
-    //  No timers here. This function is never called.
-    zmq_assert (false);
+    //  The only timer used here is the rebalancing one.
+    zmq_assert (id_ == rebalance_timer_id);
+    rebalance ();
+    _poller->add_timer (_rebalance_ivl, this, rebalance_timer_id);
+}
+
+uint32_t zmq::io_thread_t::get_traffic () const
+{
+    return _traffic.get ();
+}
+
+void zmq::io_thread_t::get_stats (poller_t::stats_t *stats_)
+{
+    _poller->get_stats (stats_);
+}
+
+bool zmq::io_thread_t::add_session (session_base_t *session_)
+{
+    if (_rebalance_ivl <= 0)
+        return false;
+    _sessions.insert (session_);
+    return true;
+}
+
+void zmq::io_thread_t::remove_session (session_base_t *session_)
+{
+    _sessions.erase (session_);
+}
+
+zmq::buffer_pool_t *zmq::io_thread_t::get_buffer_pool ()
+{
+    return &_buffer_pool;
+}
+
+void zmq::io_thread_t::rebalance ()
+{
+    //  Measure the traffic of the sessions during the last interval.
+    uint64_t traffic = 0;
+    _samples.clear ();
+    for (sessions_t::iterator it = _sessions.begin (), end = _sessions.end ();
+         it != end; ++it) {
+        const uint64_t session_traffic = (*it)->take_traffic ();
+        traffic += session_traffic;
+        if (session_traffic > 0 && (*it)->migratable ())
+            _samples.push_back (std::make_pair (session_traffic, *it));
+    }
+    _traffic.set (traffic < 0xffffffff
+                    ? static_cast<atomic_counter_t::integer_t> (traffic)
+                    : 0xffffffff);
+
+    //  Look for the session that, once moved to the least loaded I/O
+    //  thread, brings both threads closest to the same load. Only bother
+    //  if that thread handles less than half of our traffic.
+    session_base_t *selected_session = NULL;
+    io_thread_t *selected_io_thread = NULL;
+    uint64_t min_deviation = 0;
+    for (samples_t::size_type i = 0, size = _samples.size (); i != size; i++) {
+        const uint64_t session_traffic = _samples[i].first;
+        io_thread_t *io_thread =
+          choose_io_thread (_samples[i].second->get_affinity ());
+        if (io_thread == NULL || io_thread == this)
+            continue;
+        const uint64_t other_traffic = io_thread->get_traffic ();
+        if (other_traffic * 2 >= traffic
+            || session_traffic >= traffic - other_traffic)
+            continue;
+        const uint64_t ideal = (traffic - other_traffic) / 2;
+        const uint64_t deviation = session_traffic > ideal
+                                     ? session_traffic - ideal
+                                     : ideal - session_traffic;
+        if (selected_session == NULL || deviation < min_deviation) {
+            selected_session = _samples[i].second;
+            selected_io_thread = io_thread;
+            min_deviation = deviation;
+        }
+    }
+
+    if (selected_session) {
+        _sessions.erase (selected_session);
+        selected_session->migrate_out (selected_io_thread);
+    }
 }
 
 zmq::poller_t *zmq::io_thread_t::get_poller () const
@@ -90,5 +185,14 @@ void zmq::io_thread_t::process_stop ()
 {
     zmq_assert (_mailbox_handle);
     _poller->rm_fd (_mailbox_handle);
+    if (_rebalance_ivl > 0)
+        _poller->cancel_timer (this, rebalance_timer_id);
     _poller->stop ();
 }
+
+void zmq::io_thread_t::process_migrate (session_base_t *session_)
+{
+    _sessions.insert (session_);
+    session_->migrate_in ();
+    _poller->count_migration ();
+}
@@ -3,15 +3,21 @@
 #ifndef __ZMQ_IO_THREAD_HPP_INCLUDED__
 #define __ZMQ_IO_THREAD_HPP_INCLUDED__
 
+#include <set>
+#include <vector>
+
 #include "stdint.hpp"
 #include "object.hpp"
 #include "poller.hpp"
 #include "i_poll_events.hpp"
 #include "mailbox.hpp"
+#include "atomic_counter.hpp"
+#include "buffer_pool.hpp"
 
 namespace zmq
 {
 class ctx_t;
+class session_base_t;
 
 //  Generic part of the I/O thread. Polling-mechanism-specific features
 //  are implemented in separate "polling objects".
@@ -44,11 +50,33 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
 
     //  Command handlers.
     void process_stop ();
+    void process_migrate (zmq::session_base_t *session_);
 
     //  Returns load experienced by the I/O thread.
     int get_load () const;
 
+    //  Returns the number of message bytes the sessions running in the
+    //  I/O thread handled during the last balancing interval.
+    uint32_t get_traffic () const;
+
+    //  Returns how busy the I/O thread has been since it started. May be
+    //  called from other threads.
+    void get_stats (poller_t::stats_t *stats_);
+
+    //  Registers the session with the I/O thread it runs in so that its
+    //  traffic is accounted for. Returns false if balancing is disabled.
+    bool add_session (zmq::session_base_t *session_);
+    void remove_session (zmq::session_base_t *session_);
+
+    //  Returns the pool of buffers shared by the engines running in the
+    //  I/O thread. May only be used from the I/O thread.
+    buffer_pool_t *get_buffer_pool ();
+
   private:
+    //  Measures the traffic of the sessions and moves one of them to a
+    //  less loaded I/O thread if that evens out the load.
+    void rebalance ();
+
     //  I/O thread accesses incoming commands via this mailbox.
     mailbox_t _mailbox;
 
@@ -58,6 +86,31 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
     //  I/O multiplexing is performed using a poller object.
     poller_t *_poller;
 
+    //  Interval, in milliseconds, at which the load is rebalanced.
+    //  Zero if balancing is disabled.
+    const int _rebalance_ivl;
+
+    enum
+    {
+        rebalance_timer_id = 0x30
+    };
+
+    //  Sessions currently running in the I/O thread.
+    typedef std::set<zmq::session_base_t *> sessions_t;
+    sessions_t _sessions;
+
+    //  Sessions that had traffic during the last interval, along with
+    //  the number of bytes. Kept to avoid reallocating on each interval.
+    typedef std::vector<std::pair<uint64_t, zmq::session_base_t *> >
+      samples_t;
+    samples_t _samples;
+
+    //  Traffic measured during the last interval, read by other threads.
+    atomic_counter_t _traffic;
+
+    //  Buffers given back by the engines of idle connections.
+    buffer_pool_t _buffer_pool;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (io_thread_t)
 };
 }
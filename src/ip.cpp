@@ -118,6 +118,9 @@ void zmq::unblock_socket (fd_t s_)
     int flags = fcntl (s_, F_GETFL, 0);
     if (flags == -1)
         flags = 0;
+    //  Sockets accepted with SOCK_NONBLOCK need no further syscall.
+    if (flags & O_NONBLOCK)
+        return;
     int rc = fcntl (s_, F_SETFL, flags | O_NONBLOCK);
     errno_assert (rc != -1);
 #endif
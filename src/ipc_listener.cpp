@@ -57,18 +57,33 @@ zmq::ipc_listener_t::ipc_listener_t (io_thread_t *io_thread_,
 
 void zmq::ipc_listener_t::in_event ()
 {
-    const fd_t fd = accept ();
-
-    //  If connection was reset by the peer in the meantime, just ignore it.
-    //  TODO: Handle specific errors like ENFILE/EMFILE etc.
-    if (fd == retired_fd) {
-        _socket->event_accept_failed (
-          make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
-        return;
-    }
+    //  Drain the accept queue, up to the configured budget per wake-up.
+    for (int i = 0; i != options.accept_batch_size; i++) {
+        bool rejected;
+        const fd_t fd = accept (&rejected);
+
+        //  A connection turned down by the accept filters is closed already;
+        //  the next one may well be accepted. An empty accept queue ends the
+        //  batch. Any other failure is reported; running out of file
+        //  descriptors ends the batch too, as the next accept would fail
+        //  the same way, while other failures, such as the connection being
+        //  reset by the peer in the meantime, only lose that connection.
+        if (fd == retired_fd) {
+            if (rejected)
+                continue;
+            if (accept_queue_empty ())
+                return;
+            const bool exhausted = out_of_descriptors ();
+            _socket->event_accept_failed (
+              make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
+            if (exhausted)
+                return;
+            continue;
+        }
 
-    //  Create the engine object for this connection.
-    create_engine (fd);
+        //  Create the engine object for this connection.
+        create_engine (fd);
+    }
 }
 
 std::string
@@ -268,14 +283,15 @@ bool zmq::ipc_listener_t::filter (fd_t sock_)
 
 #endif
 
-zmq::fd_t zmq::ipc_listener_t::accept ()
+zmq::fd_t zmq::ipc_listener_t::accept (bool *rejected_)
 {
     //  Accept one connection and deal with different failure modes.
     //  The situation where connection cannot be accepted due to insufficient
     //  resources is considered valid and treated by ignoring the connection.
     zmq_assert (_s != retired_fd);
+    *rejected_ = false;
 #if defined ZMQ_HAVE_SOCK_CLOEXEC && defined HAVE_ACCEPT4
-    fd_t sock = ::accept4 (_s, NULL, NULL, SOCK_CLOEXEC);
+    fd_t sock = ::accept4 (_s, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
 #else
     struct sockaddr_storage ss;
     memset (&ss, 0, sizeof (ss));
@@ -308,6 +324,7 @@ zmq::fd_t zmq::ipc_listener_t::accept ()
     if (!filter (sock)) {
         int rc = ::close (sock);
         errno_assert (rc == 0);
+        *rejected_ = true;
         return retired_fd;
     }
 #endif
@@ -320,6 +337,7 @@ zmq::fd_t zmq::ipc_listener_t::accept ()
         int rc = ::close (sock);
         errno_assert (rc == 0);
 #endif
+        *rejected_ = true;
         return retired_fd;
     }
 
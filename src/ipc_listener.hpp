@@ -39,8 +39,11 @@ class ipc_listener_t ZMQ_FINAL : public stream_listener_base_t
 
     //  Accept the new connection. Returns the file descriptor of the
     //  newly created connection. The function may return retired_fd
-    //  if the connection was dropped while waiting in the listen backlog.
-    fd_t accept ();
+    //  if the connection was dropped while waiting in the listen backlog,
+    //  or if the accept queue is empty. It also returns retired_fd, with
+    //  rejected_ set, if the connection was denied because of accept
+    //  filters or closed because it could not be set up.
+    fd_t accept (bool *rejected_);
 
     //  True, if the underlying file for UNIX domain socket exists.
     bool _has_file;
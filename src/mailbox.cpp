@@ -4,7 +4,11 @@
 #include "mailbox.hpp"
 #include "err.hpp"
 
-zmq::mailbox_t::mailbox_t ()
+zmq::mailbox_t::mailbox_t () :
+    _signaler (NULL),
+    _valid (true),
+    _events (NULL),
+    _pending (0)
 {
     //  Get the pipe into passive state. That way, if the users starts by
     //  polling on the associated file descriptor it will get woken up when
@@ -22,11 +26,41 @@ zmq::mailbox_t::~mailbox_t ()
     // send() method, by waiting on the mutex before disappearing.
     _sync.lock ();
     _sync.unlock ();
+
+    LIBZMQ_DELETE (_signaler);
 }
 
-zmq::fd_t zmq::mailbox_t::get_fd () const
+zmq::fd_t zmq::mailbox_t::get_fd ()
 {
-    return _signaler.get_fd ();
+    if (!make_signaler ())
+        return retired_fd;
+    return _signaler->get_fd ();
+}
+
+bool zmq::mailbox_t::make_signaler ()
+{
+    if (_signaler)
+        return true;
+
+    signaler_t *signaler = new (std::nothrow) signaler_t ();
+    alloc_assert (signaler);
+    if (!signaler->valid ()) {
+        const int saved_errno = errno;
+        LIBZMQ_DELETE (signaler);
+        errno = saved_errno;
+        _valid = false;
+        return false;
+    }
+    _valid = true;
+
+    //  A command sent while the pipe was passive has only raised the flag
+    //  so far. It has to be signalled through the new signaler as well.
+    _sync.lock ();
+    _signaler = signaler;
+    if (_pending.load ())
+        _signaler->send ();
+    _sync.unlock ();
+    return true;
 }
 
 void zmq::mailbox_t::send (const command_t &cmd_)
@@ -34,9 +68,16 @@ void zmq::mailbox_t::send (const command_t &cmd_)
     _sync.lock ();
     _cpipe.write (cmd_, false);
     const bool ok = _cpipe.flush ();
+    signaler_t *signaler = NULL;
+    if (!ok) {
+        _pending.store (1);
+        signaler = _signaler;
+        if (_events)
+            _events->command_posted ();
+    }
     _sync.unlock ();
-    if (!ok)
-        _signaler.send ();
+    if (signaler)
+        signaler->send ();
 }
 
 int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
@@ -48,24 +89,52 @@ int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
 
         //  If there are no more commands available, switch into passive state.
         _active = false;
+
+        //  Only commands sent while the pipe is passive are signalled, so
+        //  there is no signal to check for yet.
+        if (timeout_ == 0) {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    if (!_signaler) {
+        //  With no signaler, the flag is the signal.
+        if (_pending.load ()) {
+            _active = true;
+            _pending.store (0);
+            const bool ok = _cpipe.read (cmd_);
+            zmq_assert (ok);
+            return 0;
+        }
+        if (timeout_ == 0) {
+            errno = EAGAIN;
+            return -1;
+        }
+
+        //  The thread has to wait, which takes the signaler.
+        if (!make_signaler ())
+            return -1;
     }
 
     //  Wait for signal from the command sender.
-    int rc = _signaler.wait (timeout_);
+    int rc = _signaler->wait (timeout_);
     if (rc == -1) {
         errno_assert (errno == EAGAIN || errno == EINTR);
         return -1;
     }
 
     //  Receive the signal.
-    rc = _signaler.recv_failable ();
+    rc = _signaler->recv_failable ();
     if (rc == -1) {
         errno_assert (errno == EAGAIN);
         return -1;
     }
 
-    //  Switch into active state.
+    //  Switch into active state. There is nothing more to be signalled
+    //  until the pipe gets passive again.
     _active = true;
+    _pending.store (0);
 
     //  Get a command.
     const bool ok = _cpipe.read (cmd_);
@@ -73,7 +142,40 @@ int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
     return 0;
 }
 
+int zmq::mailbox_t::try_recv (command_t *cmd_)
+{
+    //  While the pipe is active, senders do not signal, so the commands can
+    //  be polled for in user space. If commands were sent while it was
+    //  passive, their signal has to be received first.
+    if (!_active) {
+        if (!_cpipe.activate ())
+            return recv (cmd_, 0);
+        _active = true;
+    }
+
+    if (_cpipe.try_read (cmd_))
+        return 0;
+    errno = EAGAIN;
+    return -1;
+}
+
+bool zmq::mailbox_t::pending () const
+{
+    //  While the pipe is active, the commands are not signalled, so they
+    //  may be there whatever the flag says.
+    return _active || _pending.load () != 0;
+}
+
+bool zmq::mailbox_t::set_events (i_mailbox_events *events_)
+{
+    scoped_lock_t lock (_sync);
+    if (events_ && _events)
+        return false;
+    _events = events_;
+    return true;
+}
+
 bool zmq::mailbox_t::valid () const
 {
-    return _signaler.valid ();
+    return _valid;
 }
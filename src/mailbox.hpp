@@ -11,6 +11,7 @@
 #include "command.hpp"
 #include "ypipe.hpp"
 #include "mutex.hpp"
+#include "atomic_ptr.hpp"
 #include "i_mailbox.hpp"
 
 namespace zmq
@@ -21,9 +22,14 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
     mailbox_t ();
     ~mailbox_t ();
 
-    fd_t get_fd () const;
+    //  Creates the signaler if need be. Returns retired_fd if it cannot be
+    //  created.
+    fd_t get_fd ();
     void send (const command_t &cmd_);
     int recv (command_t *cmd_, int timeout_);
+    int try_recv (command_t *cmd_);
+    bool pending () const;
+    bool set_events (i_mailbox_events *events_);
 
     bool valid () const;
 
@@ -31,7 +37,11 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
     // close the file descriptors in the signaller. This is used in a forked
     // child process to close the file descriptors so that they do not interfere
     // with the context in the parent process.
-    void forked () ZMQ_FINAL { _signaler.forked (); }
+    void forked () ZMQ_FINAL
+    {
+        if (_signaler)
+            _signaler->forked ();
+    }
 #endif
 
   private:
@@ -39,8 +49,21 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
     typedef ypipe_t<command_t, command_pipe_granularity> cpipe_t;
     cpipe_t _cpipe;
 
-    //  Signaler to pass signals from writer thread to reader thread.
-    signaler_t _signaler;
+    //  Creates the signaler unless done already. Returns false and sets
+    //  errno if it cannot be created.
+    bool make_signaler ();
+
+    //  Signaler to pass signals from writer thread to reader thread. It is
+    //  created only once the reader has to wait for a command or asks for
+    //  the file descriptor. Until then, the _pending flag alone carries the
+    //  signals. Set by the reader thread, read by the senders under _sync.
+    signaler_t *_signaler;
+
+    //  False if the last attempt to create the signaler failed.
+    bool _valid;
+
+    //  Object notified along with the signaler, if any. Protected by _sync.
+    i_mailbox_events *_events;
 
     //  There's only one thread receiving from the mailbox, but there
     //  is arbitrary number of threads sending. Given that ypipe requires
@@ -52,6 +75,11 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
     //  read commands from it.
     bool _active;
 
+    //  Set by the sender that signals the reader, cleared once the signal
+    //  is received. Unlike the signaler, it can be checked without a system
+    //  call, and it exists before the signaler does.
+    atomic_value_t _pending;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (mailbox_t)
 };
 }
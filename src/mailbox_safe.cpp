@@ -7,7 +7,10 @@
 
 #include <algorithm>
 
-zmq::mailbox_safe_t::mailbox_safe_t (mutex_t *sync_) : _sync (sync_)
+zmq::mailbox_safe_t::mailbox_safe_t (mutex_t *sync_) :
+    _sync (sync_),
+    _pending (false),
+    _events (NULL)
 {
     //  Get the pipe into passive state. That way, if the users starts by
     //  polling on the associated file descriptor it will get woken up when
@@ -52,6 +55,7 @@ void zmq::mailbox_safe_t::send (const command_t &cmd_)
     _sync->lock ();
     _cpipe.write (cmd_, false);
     const bool ok = _cpipe.flush ();
+    _pending = true;
 
     if (!ok) {
         _cond_var.broadcast ();
@@ -61,6 +65,9 @@ void zmq::mailbox_safe_t::send (const command_t &cmd_)
              it != end; ++it) {
             (*it)->send ();
         }
+
+        if (_events)
+            _events->command_posted ();
     }
 
     _sync->unlock ();
@@ -90,9 +97,29 @@ int zmq::mailbox_safe_t::recv (command_t *cmd_, int timeout_)
     const bool ok = _cpipe.read (cmd_);
 
     if (!ok) {
+        _pending = false;
         errno = EAGAIN;
         return -1;
     }
 
     return 0;
 }
+
+bool zmq::mailbox_safe_t::set_events (i_mailbox_events *events_)
+{
+    if (events_ && _events)
+        return false;
+    _events = events_;
+    return true;
+}
+
+bool zmq::mailbox_safe_t::pending () const
+{
+    return _pending;
+}
+
+int zmq::mailbox_safe_t::try_recv (command_t *cmd_)
+{
+    //  With no timeout, receiving only releases the lock for a moment.
+    return recv (cmd_, 0);
+}
@@ -25,6 +25,9 @@ class mailbox_safe_t ZMQ_FINAL : public i_mailbox
 
     void send (const command_t &cmd_);
     int recv (command_t *cmd_, int timeout_);
+    int try_recv (command_t *cmd_);
+    bool pending () const;
+    bool set_events (i_mailbox_events *events_);
 
     // Add signaler to mailbox which will be called when a message is ready
     void add_signaler (signaler_t *signaler_);
@@ -54,6 +57,13 @@ class mailbox_safe_t ZMQ_FINAL : public i_mailbox
 
     std::vector<zmq::signaler_t *> _signalers;
 
+    //  True unless the last attempt to read a command found the pipe empty.
+    //  Protected by the same lock as the pipe.
+    bool _pending;
+
+    //  Object notified along with the signalers, if any.
+    i_mailbox_events *_events;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (mailbox_safe_t)
 };
 }
@@ -11,12 +11,39 @@
 #include "wire.hpp"
 #include "session_base.hpp"
 
-zmq::mechanism_t::mechanism_t (const options_t &options_) : options (options_)
+zmq::mechanism_t::mechanism_t (const options_t &options_) :
+    options (share_options (options_))
 {
 }
 
 zmq::mechanism_t::~mechanism_t ()
 {
+    release_options (options);
+}
+
+int zmq::mechanism_t::encode_batch (msg_t *msgs_,
+                                    size_t count_,
+                                    crypto_pool_t *pool_)
+{
+    LIBZMQ_UNUSED (pool_);
+
+    for (size_t i = 0; i != count_; i++)
+        if (encode (&msgs_[i]) == -1)
+            return -1;
+    return 0;
+}
+
+int zmq::mechanism_t::decode_batch (msg_t *msgs_,
+                                    size_t count_,
+                                    crypto_pool_t *pool_,
+                                    size_t *decoded_)
+{
+    LIBZMQ_UNUSED (pool_);
+
+    for (*decoded_ = 0; *decoded_ != count_; ++*decoded_)
+        if (decode (&msgs_[*decoded_]) == -1)
+            return -1;
+    return 0;
 }
 
 void zmq::mechanism_t::set_peer_routing_id (const void *id_ptr_,
@@ -12,6 +12,7 @@ namespace zmq
 {
 class msg_t;
 class session_base_t;
+class crypto_pool_t;
 
 //  Abstract class representing security mechanism.
 //  Different mechanism extends this class.
@@ -40,9 +41,33 @@ class mechanism_t
 
     virtual int decode (msg_t *) { return 0; }
 
+    //  Encodes count_ messages in order, as if encode was invoked on each
+    //  of them. If pool_ is not NULL, the work may be spread over its
+    //  threads. Returns 0 on success and -1 on error, in which case errno
+    //  is set.
+    virtual int
+    encode_batch (msg_t *msgs_, size_t count_, crypto_pool_t *pool_);
+
+    //  Decodes count_ messages in order, as if decode was invoked on each
+    //  of them. On return, decoded_ holds the number of leading messages
+    //  that were decoded; if it is less than count_, -1 is returned and
+    //  errno is set.
+    virtual int decode_batch (msg_t *msgs_,
+                              size_t count_,
+                              crypto_pool_t *pool_,
+                              size_t *decoded_);
+
+    //  Returns true if encode_batch and decode_batch spread their work over
+    //  the crypto pool, which is what makes batching messages worthwhile.
+    virtual bool parallel_batches () const { return false; }
+
     //  Notifies mechanism about availability of ZAP message.
     virtual int zap_msg_available () { return 0; }
 
+    //  Notifies mechanism that a handshake step it posted to the crypto
+    //  pool may have completed.
+    virtual int crypto_done () { return 0; }
+
     //  Returns the status of this mechanism.
     virtual status_t status () const = 0;
 
@@ -102,7 +127,7 @@ class mechanism_t
     virtual int
     property (const std::string &name_, const void *value_, size_t length_);
 
-    const options_t options;
+    const options_t &options;
 
   private:
     //  Properties received from ZMTP peer.
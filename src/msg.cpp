@@ -77,15 +77,18 @@ int zmq::msg_t::init_size (size_t size_)
         _u.lmsg.group.type = group_type_short;
         _u.lmsg.routing_id = 0;
         _u.lmsg.content = NULL;
-        if (sizeof (content_t) + size_ > size_)
-            _u.lmsg.content =
-              static_cast<content_t *> (malloc (sizeof (content_t) + size_));
+        const size_t headroom =
+          size_ >= reserved_headroom_min_size ? reserved_headroom : 0;
+        if (sizeof (content_t) + headroom + size_ > size_)
+            _u.lmsg.content = static_cast<content_t *> (
+              malloc (sizeof (content_t) + headroom + size_));
         if (unlikely (!_u.lmsg.content)) {
             errno = ENOMEM;
             return -1;
         }
 
-        _u.lmsg.content->data = _u.lmsg.content + 1;
+        _u.lmsg.content->data =
+          reinterpret_cast<unsigned char *> (_u.lmsg.content + 1) + headroom;
         _u.lmsg.content->size = size_;
         _u.lmsg.content->ffn = NULL;
         _u.lmsg.content->hint = NULL;
@@ -425,6 +428,71 @@ void zmq::msg_t::shrink (size_t new_size_)
     }
 }
 
+size_t zmq::msg_t::headroom () const
+{
+    //  Check the validity of the message.
+    zmq_assert (check ());
+
+    //  Only the buffers allocated by init_size are known to be writable
+    //  in front of the data, and their data pointer to be free to move.
+    if (_u.base.type != type_lmsg || _u.lmsg.content->ffn
+        || (_u.lmsg.flags & msg_t::shared))
+        return 0;
+
+    return static_cast<unsigned char *> (_u.lmsg.content->data)
+           - reinterpret_cast<unsigned char *> (_u.lmsg.content + 1);
+}
+
+void zmq::msg_t::expand_front (size_t size_)
+{
+    zmq_assert (size_ <= headroom ());
+
+    _u.lmsg.content->data =
+      static_cast<unsigned char *> (_u.lmsg.content->data) - size_;
+    _u.lmsg.content->size += size_;
+}
+
+void zmq::msg_t::trim_front (size_t size_)
+{
+    //  Check the validity of the message.
+    zmq_assert (check ());
+    zmq_assert (size_ <= size ());
+
+    switch (_u.base.type) {
+        case type_vsm:
+            memmove (_u.vsm.data, _u.vsm.data + size_, _u.vsm.size - size_);
+            _u.vsm.size -= static_cast<unsigned char> (size_);
+            break;
+        case type_lmsg:
+            zmq_assert (!(_u.lmsg.flags & msg_t::shared));
+            //  The free function gets the data pointer it was given.
+            if (_u.lmsg.content->ffn) {
+                memmove (_u.lmsg.content->data,
+                         static_cast<unsigned char *> (_u.lmsg.content->data)
+                           + size_,
+                         _u.lmsg.content->size - size_);
+            } else
+                _u.lmsg.content->data =
+                  static_cast<unsigned char *> (_u.lmsg.content->data)
+                  + size_;
+            _u.lmsg.content->size -= size_;
+            break;
+        case type_zclmsg:
+            //  The buffer is released through the hint only.
+            zmq_assert (!(_u.zclmsg.flags & msg_t::shared));
+            _u.zclmsg.content->data =
+              static_cast<unsigned char *> (_u.zclmsg.content->data) + size_;
+            _u.zclmsg.content->size -= size_;
+            break;
+        case type_cmsg:
+            _u.cmsg.data = static_cast<unsigned char *> (_u.cmsg.data) + size_;
+            _u.cmsg.size -= size_;
+            break;
+        default:
+            zmq_assert (false);
+    }
+}
+
 unsigned char zmq::msg_t::flags () const
 {
     return _u.base.flags;
@@ -143,6 +143,19 @@ class msg_t
 
     void shrink (size_t new_size_);
 
+    //  Number of bytes in front of the data that expand_front may take
+    //  without copying. Only the large messages allocated by init_size and
+    //  not shared have any.
+    size_t headroom () const;
+
+    //  Grows the message by size_ bytes in front of the data, taken from
+    //  the headroom. The bytes added are uninitialised.
+    void expand_front (size_t size_);
+
+    //  Removes the first size_ bytes of the message. The data are moved
+    //  only if the message's data pointer cannot be.
+    void trim_front (size_t size_);
+
     //  Size in bytes of the largest message that is still copied around
     //  rather than being reference-counted.
     enum
@@ -154,6 +167,15 @@ class msg_t
         max_vsm_size =
           msg_t_size - (sizeof (metadata_t *) + 3 + 16 + sizeof (uint32_t))
     };
+    //  Room reserved in front of the data of the messages allocated with
+    //  init_size, from the given size on. Enough for the security
+    //  mechanisms to prepend their header in place, and a multiple of 8
+    //  so as not to change the data's alignment.
+    enum
+    {
+        reserved_headroom = 48,
+        reserved_headroom_min_size = 256
+    };
     enum
     {
         ping_cmd_name_size = 5,   // 4PING
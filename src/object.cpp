@@ -12,12 +12,13 @@
 #include "session_base.hpp"
 #include "socket_base.hpp"
 
-zmq::object_t::object_t (ctx_t *ctx_, uint32_t tid_) : _ctx (ctx_), _tid (tid_)
+zmq::object_t::object_t (ctx_t *ctx_, uint32_t tid_) :
+    _ctx (ctx_), _tid (tid_), _exec_tid (tid_)
 {
 }
 
 zmq::object_t::object_t (object_t *parent_) :
-    _ctx (parent_->_ctx), _tid (parent_->_tid)
+    _ctx (parent_->_ctx), _tid (parent_->_tid), _exec_tid (parent_->_exec_tid)
 {
 }
 
@@ -33,6 +34,17 @@ uint32_t zmq::object_t::get_tid () const
 void zmq::object_t::set_tid (uint32_t id_)
 {
     _tid = id_;
+    _exec_tid = id_;
+}
+
+uint32_t zmq::object_t::get_exec_tid () const
+{
+    return _exec_tid;
+}
+
+void zmq::object_t::set_exec_tid (uint32_t id_)
+{
+    _exec_tid = id_;
 }
 
 zmq::ctx_t *zmq::object_t::get_ctx () const
@@ -137,6 +149,15 @@ void zmq::object_t::process_command (const command_t &cmd_)
             process_conn_failed ();
             break;
 
+        case command_t::migrate:
+            process_migrate (cmd_.args.migrate.session);
+            break;
+
+        case command_t::crypto_done:
+            process_crypto_done ();
+            process_seqnum ();
+            break;
+
         case command_t::done:
         default:
             zmq_assert (false);
@@ -188,6 +209,12 @@ zmq::io_thread_t *zmq::object_t::choose_io_thread (uint64_t affinity_) const
     return _ctx->choose_io_thread (affinity_);
 }
 
+void zmq::object_t::choose_io_threads (
+  uint64_t affinity_, int count_, std::vector<io_thread_t *> &io_threads_) const
+{
+    _ctx->choose_io_threads (affinity_, count_, io_threads_);
+}
+
 void zmq::object_t::send_stop ()
 {
     //  'stop' command goes always from administrative thread to
@@ -241,6 +268,24 @@ void zmq::object_t::send_conn_failed (session_base_t *destination_)
     send_command (cmd);
 }
 
+void zmq::object_t::send_migrate (io_thread_t *destination_,
+                                  session_base_t *session_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::migrate;
+    cmd.args.migrate.session = session_;
+    send_command (cmd);
+}
+
+void zmq::object_t::send_crypto_done (session_base_t *destination_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::crypto_done;
+    send_command (cmd);
+}
+
 void zmq::object_t::send_bind (own_t *destination_,
                                pipe_t *pipe_,
                                bool inc_seqnum_)
@@ -517,6 +562,16 @@ void zmq::object_t::process_conn_failed ()
     zmq_assert (false);
 }
 
+void zmq::object_t::process_migrate (session_base_t *)
+{
+    zmq_assert (false);
+}
+
+void zmq::object_t::process_crypto_done ()
+{
+    zmq_assert (false);
+}
+
 void zmq::object_t::send_command (const command_t &cmd_)
 {
     _ctx->send_command (cmd_.destination->get_tid (), cmd_);
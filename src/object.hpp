@@ -4,6 +4,7 @@
 #define __ZMQ_OBJECT_HPP_INCLUDED__
 
 #include <string>
+#include <vector>
 
 #include "endpoint.hpp"
 #include "macros.hpp"
@@ -34,6 +35,13 @@ class object_t
 
     uint32_t get_tid () const;
     void set_tid (uint32_t id_);
+
+    //  ID of the thread that processes the object's commands. It differs
+    //  from the thread ID only for objects migrated to another I/O thread;
+    //  their commands are still addressed to the original thread, which
+    //  forwards them so that they keep their order.
+    uint32_t get_exec_tid () const;
+    void set_exec_tid (uint32_t id_);
     ctx_t *get_ctx () const;
     void process_command (const zmq::command_t &cmd_);
     void send_inproc_connected (zmq::socket_base_t *socket_);
@@ -61,6 +69,11 @@ class object_t
     //  Chooses least loaded I/O thread.
     zmq::io_thread_t *choose_io_thread (uint64_t affinity_) const;
 
+    //  Chooses up to count_ distinct I/O threads, in index order.
+    void choose_io_threads (uint64_t affinity_,
+                            int count_,
+                            std::vector<zmq::io_thread_t *> &io_threads_) const;
+
     //  Derived object can use these functions to send commands
     //  to other objects.
     void send_stop ();
@@ -91,6 +104,9 @@ class object_t
     void send_reaped ();
     void send_done ();
     void send_conn_failed (zmq::session_base_t *destination_);
+    void send_migrate (zmq::io_thread_t *destination_,
+                       zmq::session_base_t *session_);
+    void send_crypto_done (zmq::session_base_t *destination_);
 
 
     //  These handlers can be overridden by the derived objects. They are
@@ -120,6 +136,8 @@ class object_t
     virtual void process_reap (zmq::socket_base_t *socket_);
     virtual void process_reaped ();
     virtual void process_conn_failed ();
+    virtual void process_migrate (zmq::session_base_t *session_);
+    virtual void process_crypto_done ();
 
 
     //  Special handler called after a command that requires a seqnum
@@ -134,6 +152,9 @@ class object_t
     //  Thread ID of the thread the object belongs to.
     uint32_t _tid;
 
+    //  Thread ID of the thread the object is currently processed in.
+    uint32_t _exec_tid;
+
     void send_command (const command_t &cmd_);
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (object_t)
@@ -204,11 +204,13 @@ zmq::options_t::options_t () :
     tcp_keepalive_intvl (-1),
     mechanism (ZMQ_NULL),
     as_server (0),
+    curve_aead (0),
     gss_principal_nt (ZMQ_GSSAPI_NT_HOSTBASED),
     gss_service_principal_nt (ZMQ_GSSAPI_NT_HOSTBASED),
     gss_plaintext (false),
     socket_id (0),
     conflate (false),
+    conflate_key (0),
     handshake_ivl (30000),
     connected (false),
     heartbeat_ttl (0),
@@ -220,6 +222,10 @@ zmq::options_t::options_t () :
     multicast_loop (true),
     in_batch_size (8192),
     out_batch_size (8192),
+    accept_batch_size (32),
+    optimistic_handshake (false),
+    io_budget (0),
+    rcvspin (0),
     zero_copy (true),
     router_notify (0),
     monitor_event_version (1),
@@ -238,7 +244,9 @@ zmq::options_t::options_t () :
     norm_num_parity (4),
     norm_num_autoparity (0),
     norm_push_enable (false),
-    busy_poll (0)
+    busy_poll (0),
+    tcp_listen_shards (0),
+    tcp_listen_cpu_steering (false)
 {
     memset (curve_public_key, 0, CURVE_KEYSIZE);
     memset (curve_secret_key, 0, CURVE_KEYSIZE);
@@ -251,6 +259,26 @@ zmq::options_t::options_t () :
 #endif
 }
 
+const zmq::options_t &zmq::share_options (const options_t &options_)
+{
+    if (options_.snapshot_refs.count.get () != 0) {
+        options_.snapshot_refs.count.add (1);
+        return options_;
+    }
+
+    options_t *snapshot = new (std::nothrow) options_t (options_);
+    alloc_assert (snapshot);
+    snapshot->snapshot_refs.count.set (1);
+    return *snapshot;
+}
+
+void zmq::release_options (const options_t &options_)
+{
+    zmq_assert (options_.snapshot_refs.count.get () != 0);
+    if (!options_.snapshot_refs.count.sub (1))
+        delete &options_;
+}
+
 int zmq::options_t::set_curve_key (uint8_t *destination_,
                                    const void *optval_,
                                    size_t optvallen_)
@@ -786,12 +814,66 @@ int zmq::options_t::setsockopt (int option_,
             }
             break;
 
+        case ZMQ_ACCEPT_BATCH_SIZE:
+            if (is_int && value > 0) {
+                accept_batch_size = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_OPTIMISTIC_HANDSHAKE:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &optimistic_handshake);
+
+        case ZMQ_IO_BUDGET:
+            if (is_int && value >= 0) {
+                io_budget = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_RCVSPIN:
+            if (is_int && value >= 0) {
+                rcvspin = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CONFLATE_KEY:
+            if (is_int && value >= ZMQ_CONFLATE_KEY_FRAME) {
+                conflate_key = value;
+                return 0;
+            }
+            break;
+
+#ifdef ZMQ_HAVE_CURVE
+        case ZMQ_CURVE_AEAD:
+            if (is_int
+                && (value == 0 || value == ZMQ_CURVE_AEAD_AES256GCM
+                    || value == ZMQ_CURVE_AEAD_CHACHA20POLY1305)) {
+                curve_aead = value;
+                return 0;
+            }
+            break;
+#endif
+
         case ZMQ_BUSY_POLL:
             if (is_int) {
                 busy_poll = value;
                 return 0;
             }
             break;
+
+        case ZMQ_TCP_LISTEN_SHARDS:
+            if (is_int && value >= -1) {
+                tcp_listen_shards = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_TCP_LISTEN_CPU_STEERING:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &tcp_listen_cpu_steering);
 #ifdef ZMQ_HAVE_WSS
         case ZMQ_WSS_KEY_PEM:
             // TODO: check if valid certificate
@@ -1333,6 +1415,50 @@ int zmq::options_t::getsockopt (int option_,
             }
             break;
 
+        case ZMQ_ACCEPT_BATCH_SIZE:
+            if (is_int) {
+                *value = accept_batch_size;
+                return 0;
+            }
+            break;
+
+        case ZMQ_OPTIMISTIC_HANDSHAKE:
+            if (is_int) {
+                *value = optimistic_handshake;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_BUDGET:
+            if (is_int) {
+                *value = io_budget;
+                return 0;
+            }
+            break;
+
+        case ZMQ_RCVSPIN:
+            if (is_int) {
+                *value = rcvspin;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CONFLATE_KEY:
+            if (is_int) {
+                *value = conflate_key;
+                return 0;
+            }
+            break;
+
+#ifdef ZMQ_HAVE_CURVE
+        case ZMQ_CURVE_AEAD:
+            if (is_int) {
+                *value = curve_aead;
+                return 0;
+            }
+            break;
+#endif
+
         case ZMQ_PRIORITY:
             if (is_int) {
                 *value = priority;
@@ -1346,6 +1472,20 @@ int zmq::options_t::getsockopt (int option_,
             }
             break;
 
+        case ZMQ_TCP_LISTEN_SHARDS:
+            if (is_int) {
+                *value = tcp_listen_shards;
+                return 0;
+            }
+            break;
+
+        case ZMQ_TCP_LISTEN_CPU_STEERING:
+            if (is_int) {
+                *value = tcp_listen_cpu_steering;
+                return 0;
+            }
+            break;
+
 #ifdef ZMQ_HAVE_NORM
         case ZMQ_NORM_MODE:
             if (is_int) {
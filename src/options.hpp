@@ -7,6 +7,7 @@
 #include <vector>
 #include <map>
 
+#include "atomic_counter.hpp"
 #include "atomic_ptr.hpp"
 #include "stddef.h"
 #include "stdint.hpp"
@@ -186,6 +187,11 @@ struct options_t
     uint8_t curve_secret_key[CURVE_KEYSIZE];
     uint8_t curve_server_key[CURVE_KEYSIZE];
 
+    //  AEAD cipher the CURVE data phase prefers over CURVE's own, if the
+    //  peer agrees: ZMQ_CURVE_AEAD_AES256GCM, ZMQ_CURVE_AEAD_CHACHA20POLY1305,
+    //  or 0 to keep CURVE's own.
+    int curve_aead;
+
     //  Principals for GSSAPI mechanism
     std::string gss_principal;
     std::string gss_service_principal;
@@ -206,6 +212,12 @@ struct options_t
     //  Ignores hwm
     bool conflate;
 
+    //  If not 0, socket conflates messages per key rather than as a whole:
+    //  only the latest message of each key is kept. The key is made of
+    //  that many bytes of the first frame, or of the whole first frame if
+    //  -1. Takes precedence over conflate, and supports multi-part messages.
+    int conflate_key;
+
     //  If connection handshake is not done after this many milliseconds,
     //  close socket.  Default is 30 secs.  0 means no handshake timeout.
     int handshake_ivl;
@@ -254,6 +266,25 @@ struct options_t
     //  them may be written by a single 'send' system call, thus avoiding
     //  unnecessary network stack traversals.
     int out_batch_size;
+    //  Maximal number of connections a listener accepts per wake-up
+    //  before giving other file descriptors in the I/O thread a turn.
+    int accept_batch_size;
+
+    //  If true, connections send their whole greeting, and the first
+    //  NULL or PLAIN handshake command, without waiting for the peer's
+    //  greeting. TCP connections also use TCP Fast Open.
+    bool optimistic_handshake;
+
+    //  Maximal number of bytes a connection reads, and writes, each time
+    //  its I/O thread serves it, so that a busy connection leaves the other
+    //  connections of the thread their turn. 0 means no limit other than
+    //  the batch sizes and the socket buffers.
+    int io_budget;
+
+    //  Number of microseconds a blocking receive keeps checking for a
+    //  message in user space before going to sleep. 0 means it sleeps
+    //  straight away.
+    int rcvspin;
 
     // Use zero copy strategy for storing message content when decoding.
     bool zero_copy;
@@ -298,12 +329,39 @@ struct options_t
 
     //  This option removes several delays caused by scheduling, interrupts and context switching.
     int busy_poll;
+
+    //  Number of SO_REUSEPORT listeners opened per TCP bind, each running
+    //  in its own I/O thread. 0 means a single listener, -1 one listener
+    //  per eligible I/O thread.
+    int tcp_listen_shards;
+
+    //  If true, incoming TCP connections are steered to the listener shard
+    //  matching the CPU that received them.
+    bool tcp_listen_cpu_steering;
+
+    //  Number of references to the options if they are a snapshot, else
+    //  zero. Copies of a snapshot are not snapshots themselves.
+    struct snapshot_refs_t
+    {
+        snapshot_refs_t () {}
+        snapshot_refs_t (const snapshot_refs_t &) {}
+
+        mutable atomic_counter_t count;
+    } snapshot_refs;
 };
 
+//  Objects created under a socket's options keep a snapshot of them: an
+//  immutable copy, shared by all the objects created under the same
+//  settings. share_options returns options_ with a reference added if it is
+//  a snapshot already, or else a new snapshot of options_. Each reference
+//  is dropped by release_options, the last one deleting the snapshot.
+const options_t &share_options (const options_t &options_);
+void release_options (const options_t &options_);
+
 inline bool get_effective_conflate_option (const options_t &options)
 {
     // conflate is only effective for some socket types
-    return options.conflate
+    return (options.conflate || options.conflate_key != 0)
            && (options.type == ZMQ_DEALER || options.type == ZMQ_PULL
                || options.type == ZMQ_PUSH || options.type == ZMQ_PUB
                || options.type == ZMQ_SUB);
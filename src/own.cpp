@@ -5,29 +5,36 @@
 #include "err.hpp"
 #include "io_thread.hpp"
 
-zmq::own_t::own_t (class ctx_t *parent_, uint32_t tid_) :
+zmq::own_t::own_t (class ctx_t *parent_,
+                   uint32_t tid_,
+                   const options_t &options_) :
     object_t (parent_, tid_),
+    options (options_),
     _terminating (false),
     _sent_seqnum (0),
     _processed_seqnum (0),
     _owner (NULL),
-    _term_acks (0)
+    _term_acks (0),
+    _shares_options (false)
 {
 }
 
 zmq::own_t::own_t (io_thread_t *io_thread_, const options_t &options_) :
     object_t (io_thread_),
-    options (options_),
+    options (share_options (options_)),
     _terminating (false),
     _sent_seqnum (0),
     _processed_seqnum (0),
     _owner (NULL),
-    _term_acks (0)
+    _term_acks (0),
+    _shares_options (true)
 {
 }
 
 zmq::own_t::~own_t ()
 {
+    if (_shares_options)
+        release_options (options);
 }
 
 void zmq::own_t::set_owner (own_t *owner_)
@@ -25,10 +25,12 @@ class own_t : public object_t
     //  It'll be supplied later on when the object is plugged in.
 
     //  The object is not living within an I/O thread. It has it's own
-    //  thread outside of 0MQ infrastructure.
-    own_t (zmq::ctx_t *parent_, uint32_t tid_);
+    //  thread outside of 0MQ infrastructure. Its options are options_,
+    //  owned by the derived object.
+    own_t (zmq::ctx_t *parent_, uint32_t tid_, const options_t &options_);
 
-    //  The object is living within I/O thread.
+    //  The object is living within I/O thread. It keeps a snapshot of
+    //  options_, shared with the other objects created under them.
     own_t (zmq::io_thread_t *io_thread_, const options_t &options_);
 
     //  When another owned object wants to send command to this object
@@ -75,7 +77,7 @@ class own_t : public object_t
     virtual void process_destroy ();
 
     //  Socket options associated with this object.
-    options_t options;
+    const options_t &options;
 
   private:
     //  Set owner of the object
@@ -113,6 +115,9 @@ class own_t : public object_t
     //  Number of events we have to get before we can destroy the object.
     int _term_acks;
 
+    //  True if the options are a snapshot to release.
+    const bool _shares_options;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (own_t)
 };
 }
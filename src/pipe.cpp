@@ -10,37 +10,29 @@
 
 #include "ypipe.hpp"
 #include "ypipe_conflate.hpp"
+#include "ypipe_keyed.hpp"
 
 int zmq::pipepair (object_t *parents_[2],
                    pipe_t *pipes_[2],
                    const int hwms_[2],
-                   const bool conflate_[2])
+                   const bool conflate_[2],
+                   int conflate_key_)
 {
     //   Creates two pipe objects. These objects are connected by two ypipes,
     //   each to pass messages in one direction.
 
-    typedef ypipe_t<msg_t, message_pipe_granularity> upipe_normal_t;
-    typedef ypipe_conflate_t<msg_t> upipe_conflate_t;
+    pipe_t::upipe_t *upipe1 =
+      pipe_t::create_upipe (conflate_[0], conflate_key_);
+    pipe_t::upipe_t *upipe2 =
+      pipe_t::create_upipe (conflate_[1], conflate_key_);
 
-    pipe_t::upipe_t *upipe1;
-    if (conflate_[0])
-        upipe1 = new (std::nothrow) upipe_conflate_t ();
-    else
-        upipe1 = new (std::nothrow) upipe_normal_t ();
-    alloc_assert (upipe1);
-
-    pipe_t::upipe_t *upipe2;
-    if (conflate_[1])
-        upipe2 = new (std::nothrow) upipe_conflate_t ();
-    else
-        upipe2 = new (std::nothrow) upipe_normal_t ();
-    alloc_assert (upipe2);
-
-    pipes_[0] = new (std::nothrow)
-      pipe_t (parents_[0], upipe1, upipe2, hwms_[1], hwms_[0], conflate_[0]);
+    pipes_[0] = new (std::nothrow) pipe_t (parents_[0], upipe1, upipe2,
+                                           hwms_[1], hwms_[0], conflate_[0],
+                                           conflate_key_);
     alloc_assert (pipes_[0]);
-    pipes_[1] = new (std::nothrow)
-      pipe_t (parents_[1], upipe2, upipe1, hwms_[0], hwms_[1], conflate_[1]);
+    pipes_[1] = new (std::nothrow) pipe_t (parents_[1], upipe2, upipe1,
+                                           hwms_[0], hwms_[1], conflate_[1],
+                                           conflate_key_);
     alloc_assert (pipes_[1]);
 
     pipes_[0]->set_peer (pipes_[1]);
@@ -77,7 +69,8 @@ zmq::pipe_t::pipe_t (object_t *parent_,
                      upipe_t *outpipe_,
                      int inhwm_,
                      int outhwm_,
-                     bool conflate_) :
+                     bool conflate_,
+                     int conflate_key_) :
     object_t (parent_),
     _in_pipe (inpipe_),
     _out_pipe (outpipe_),
@@ -95,11 +88,27 @@ zmq::pipe_t::pipe_t (object_t *parent_,
     _state (active),
     _delay (true),
     _server_socket_routing_id (0),
-    _conflate (conflate_)
+    _conflate (conflate_),
+    _conflate_key (conflate_key_)
 {
     _disconnect_msg.init ();
 }
 
+zmq::pipe_t::upipe_t *zmq::pipe_t::create_upipe (bool conflate_,
+                                                 int conflate_key_)
+{
+    upipe_t *upipe;
+    if (conflate_ && conflate_key_ != 0)
+        upipe = new (std::nothrow) ypipe_keyed_t (conflate_key_);
+    else if (conflate_)
+        upipe = new (std::nothrow) ypipe_conflate_t<msg_t> ();
+    else
+        upipe = new (std::nothrow) ypipe_t<msg_t, message_pipe_granularity,
+                                           message_pipe_min_granularity> ();
+    alloc_assert (upipe);
+    return upipe;
+}
+
 zmq::pipe_t::~pipe_t ()
 {
     _disconnect_msg.close ();
@@ -167,6 +176,21 @@ bool zmq::pipe_t::check_read ()
     return true;
 }
 
+bool zmq::pipe_t::check_read_msg ()
+{
+    if (unlikely (!_in_active))
+        return false;
+    if (unlikely (_state != active && _state != waiting_for_delimiter))
+        return false;
+
+    if (!_in_pipe->check_read ()) {
+        _in_active = false;
+        return false;
+    }
+
+    return !_in_pipe->probe (is_delimiter);
+}
+
 bool zmq::pipe_t::read (msg_t *msg_)
 {
     if (unlikely (!_in_active))
@@ -498,12 +522,7 @@ void zmq::pipe_t::hiccup ()
     //  responsible for deallocating it.
 
     //  Create new inpipe.
-    _in_pipe =
-      _conflate
-        ? static_cast<upipe_t *> (new (std::nothrow) ypipe_conflate_t<msg_t> ())
-        : new (std::nothrow) ypipe_t<msg_t, message_pipe_granularity> ();
-
-    alloc_assert (_in_pipe);
+    _in_pipe = create_upipe (_conflate, _conflate_key);
     _in_active = true;
 
     //  Notify the peer about the hiccup.
@@ -24,11 +24,14 @@ class pipe_t;
 //  pipe receives all the pending messages before terminating, otherwise it
 //  terminates straight away.
 //  If conflate is true, only the most recently arrived message could be
-//  read (older messages are discarded)
+//  read (older messages are discarded), or, if conflate_key is not zero,
+//  only the most recently arrived message of each key (see
+//  ZMQ_CONFLATE_KEY).
 int pipepair (zmq::object_t *parents_[2],
               zmq::pipe_t *pipes_[2],
               const int hwms_[2],
-              const bool conflate_[2]);
+              const bool conflate_[2],
+              int conflate_key_ = 0);
 
 struct i_pipe_events
 {
@@ -53,7 +56,8 @@ class pipe_t ZMQ_FINAL : public object_t,
     friend int pipepair (zmq::object_t *parents_[2],
                          zmq::pipe_t *pipes_[2],
                          const int hwms_[2],
-                         const bool conflate_[2]);
+                         const bool conflate_[2],
+                         int conflate_key_);
 
   public:
     //  Specifies the object to send events to.
@@ -70,6 +74,11 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Returns true if there is at least one message to read in the pipe.
     bool check_read ();
 
+    //  Returns true if there is at least one message to read in the pipe
+    //  other than the delimiter. Unlike check_read, this never initiates
+    //  the termination of the pipe.
+    bool check_read_msg ();
+
     //  Reads a message to the underlying pipe.
     bool read (msg_t *msg_);
 
@@ -151,7 +160,11 @@ class pipe_t ZMQ_FINAL : public object_t,
             upipe_t *outpipe_,
             int inhwm_,
             int outhwm_,
-            bool conflate_);
+            bool conflate_,
+            int conflate_key_);
+
+    //  Creates the underlying pipe for one direction.
+    static upipe_t *create_upipe (bool conflate_, int conflate_key_);
 
     //  Pipepair uses this function to let us know about
     //  the peer pipe object.
@@ -231,6 +244,7 @@ class pipe_t ZMQ_FINAL : public object_t,
     static int compute_lwm (int hwm_);
 
     const bool _conflate;
+    const int _conflate_key;
 
     // The endpoints of this pipe.
     endpoint_uri_pair_t _endpoint_pair;
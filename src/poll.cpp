@@ -125,8 +125,10 @@ void zmq::poll_t::loop ()
         }
 
         //  Wait for events.
+        begin_wait ();
         int rc = poll (&pollset[0], static_cast<nfds_t> (pollset.size ()),
                        timeout ? timeout : -1);
+        end_wait (rc);
         if (rc == -1) {
             errno_assert (errno == EINTR);
             continue;
@@ -1,10 +1,18 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include "precompiled.hpp"
+#include <string.h>
+
 #include "poller_base.hpp"
 #include "i_poll_events.hpp"
 #include "err.hpp"
 
+zmq::poller_base_t::poller_base_t () : _stats_time (0), _wait_start (0)
+{
+    memset (&_stats, 0, sizeof _stats);
+    memset (&_published_stats, 0, sizeof _published_stats);
+}
+
 zmq::poller_base_t::~poller_base_t ()
 {
     //  Make sure there is no more load on the shutdown.
@@ -24,6 +32,45 @@ void zmq::poller_base_t::adjust_load (int amount_)
         _load.sub (-amount_);
 }
 
+void zmq::poller_base_t::get_stats (stats_t *stats_)
+{
+    scoped_lock_t locker (_stats_sync);
+    *stats_ = _published_stats;
+
+    //  Account for the wait in progress.
+    if (_wait_start != 0) {
+        const uint64_t now = clock_t::now_us ();
+        if (now > _wait_start)
+            stats_->idle_time += now - _wait_start;
+    }
+}
+
+void zmq::poller_base_t::begin_wait ()
+{
+    const uint64_t now = clock_t::now_us ();
+    if (_stats_time != 0 && now > _stats_time)
+        _stats.busy_time += now - _stats_time;
+    _stats_time = now;
+
+    scoped_lock_t locker (_stats_sync);
+    _published_stats = _stats;
+    _wait_start = now;
+}
+
+void zmq::poller_base_t::end_wait (int events_)
+{
+    const uint64_t now = clock_t::now_us ();
+    if (now > _stats_time)
+        _stats.idle_time += now - _stats_time;
+    _stats_time = now;
+    if (events_ > 0)
+        _stats.events += events_;
+
+    scoped_lock_t locker (_stats_sync);
+    _published_stats.idle_time = _stats.idle_time;
+    _wait_start = 0;
+}
+
 void zmq::poller_base_t::add_timer (int timeout_, i_poll_events *sink_, int id_)
 {
     uint64_t expiration = _clock.now_ms () + timeout_;
@@ -83,6 +130,7 @@ uint64_t zmq::poller_base_t::execute_timers ()
 
         //  Trigger the timer.
         timer_temp.sink->timer_event (timer_temp.id);
+        _stats.timers++;
 
     } while (!_timers.empty ());
 
@@ -7,6 +7,7 @@
 
 #include "clock.hpp"
 #include "atomic_counter.hpp"
+#include "mutex.hpp"
 #include "ctx.hpp"
 
 namespace zmq
@@ -95,7 +96,7 @@ struct i_poll_events;
 class poller_base_t
 {
   public:
-    poller_base_t () ZMQ_DEFAULT;
+    poller_base_t ();
     virtual ~poller_base_t ();
 
     // Methods from the poller concept.
@@ -103,10 +104,44 @@ class poller_base_t
     void add_timer (int timeout_, zmq::i_poll_events *sink_, int id_);
     void cancel_timer (zmq::i_poll_events *sink_, int id_);
 
+    //  Utilisation of the worker thread. Times are in microseconds.
+    struct stats_t
+    {
+        uint64_t busy_time;
+        uint64_t idle_time;
+        uint64_t events;
+        uint64_t commands;
+        uint64_t timers;
+        uint64_t bytes_read;
+        uint64_t bytes_written;
+        uint64_t migrations;
+    };
+
+    //  Returns the statistics as of the last time the worker thread
+    //  started waiting for events. May be called from outside.
+    void get_stats (stats_t *stats_);
+
+    //  Account for the work done by the objects the poller serves. May only
+    //  be called from the worker thread.
+    void count_commands (uint64_t count_) { _stats.commands += count_; }
+    void count_bytes_read (uint64_t count_) { _stats.bytes_read += count_; }
+    void count_bytes_written (uint64_t count_)
+    {
+        _stats.bytes_written += count_;
+    }
+    void count_migration () { _stats.migrations++; }
+
   protected:
     //  Called by individual poller implementations to manage the load.
     void adjust_load (int amount_);
 
+    //  Called by individual poller implementations right before and after
+    //  waiting for events, so that the time spent waiting is told apart
+    //  from the time spent working. Events is the number of events the
+    //  wait reported.
+    void begin_wait ();
+    void end_wait (int events_);
+
     //  Executes any timers that are due. Returns number of milliseconds
     //  to wait to match the next timer or 0 meaning "no timers".
     uint64_t execute_timers ();
@@ -128,6 +163,17 @@ class poller_base_t
     //  registered.
     atomic_counter_t _load;
 
+    //  Statistics, only accessed by the worker thread, and the time they
+    //  were last updated at.
+    stats_t _stats;
+    uint64_t _stats_time;
+
+    //  Copy of the statistics published for other threads, along with the
+    //  time the worker thread started waiting at, or 0 if it is not waiting.
+    mutex_t _stats_sync;
+    stats_t _published_stats;
+    uint64_t _wait_start;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (poller_base_t)
 };
 
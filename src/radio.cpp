@@ -47,25 +47,15 @@ void zmq::radio_t::xread_activated (pipe_t *pipe_)
     //  There are some subscriptions waiting. Let's process them.
     msg_t msg;
     while (pipe_->read (&msg)) {
-        //  Apply the subscription to the trie
+        //  Apply the subscription to the index
         if (msg.is_join () || msg.is_leave ()) {
-            std::string group = std::string (msg.group ());
+            const char *group = msg.group ();
+            const size_t group_size = strlen (group);
 
             if (msg.is_join ())
-                _subscriptions.ZMQ_MAP_INSERT_OR_EMPLACE (ZMQ_MOVE (group),
-                                                          pipe_);
-            else {
-                std::pair<subscriptions_t::iterator, subscriptions_t::iterator>
-                  range = _subscriptions.equal_range (group);
-
-                for (subscriptions_t::iterator it = range.first;
-                     it != range.second; ++it) {
-                    if (it->second == pipe_) {
-                        _subscriptions.erase (it);
-                        break;
-                    }
-                }
-            }
+                _subscriptions.add (group, group_size, pipe_);
+            else
+                _subscriptions.rm (group, group_size, pipe_);
         }
         msg.close ();
     }
@@ -94,19 +84,7 @@ int zmq::radio_t::xsetsockopt (int option_,
 
 void zmq::radio_t::xpipe_terminated (pipe_t *pipe_)
 {
-    for (subscriptions_t::iterator it = _subscriptions.begin (),
-                                   end = _subscriptions.end ();
-         it != end;) {
-        if (it->second == pipe_) {
-#if __cplusplus >= 201103L || (defined _MSC_VER && _MSC_VER >= 1700)
-            it = _subscriptions.erase (it);
-#else
-            _subscriptions.erase (it++);
-#endif
-        } else {
-            ++it;
-        }
-    }
+    _subscriptions.rm (pipe_);
 
     {
         const udp_pipes_t::iterator end = _udp_pipes.end ();
@@ -119,6 +97,11 @@ void zmq::radio_t::xpipe_terminated (pipe_t *pipe_)
     _dist.pipe_terminated (pipe_);
 }
 
+void zmq::radio_t::mark_as_matching (pipe_t *pipe_, void *self_)
+{
+    static_cast<radio_t *> (self_)->_dist.match (pipe_);
+}
+
 int zmq::radio_t::xsend (msg_t *msg_)
 {
     //  Radio sockets do not allow multipart data (ZMQ_SNDMORE)
@@ -129,11 +112,8 @@ int zmq::radio_t::xsend (msg_t *msg_)
 
     _dist.unmatch ();
 
-    const std::pair<subscriptions_t::iterator, subscriptions_t::iterator>
-      range = _subscriptions.equal_range (std::string (msg_->group ()));
-
-    for (subscriptions_t::iterator it = range.first; it != range.second; ++it)
-        _dist.match (it->second);
+    const char *group = msg_->group ();
+    _subscriptions.match (group, strlen (group), mark_as_matching, this);
 
     for (udp_pipes_t::iterator it = _udp_pipes.begin (),
                                end = _udp_pipes.end ();
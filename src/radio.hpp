@@ -3,13 +3,12 @@
 #ifndef __ZMQ_RADIO_HPP_INCLUDED__
 #define __ZMQ_RADIO_HPP_INCLUDED__
 
-#include <map>
-#include <string>
 #include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "dist.hpp"
+#include "group_index.hpp"
 #include "msg.hpp"
 
 namespace zmq
@@ -38,9 +37,11 @@ class radio_t ZMQ_FINAL : public socket_base_t
     void xpipe_terminated (zmq::pipe_t *pipe_);
 
   private:
+    //  Function to be applied to the pipes of the matching subscriptions.
+    static void mark_as_matching (zmq::pipe_t *pipe_, void *self_);
+
     //  List of all subscriptions mapped to corresponding pipes.
-    typedef std::multimap<std::string, pipe_t *> subscriptions_t;
-    subscriptions_t _subscriptions;
+    group_index_t _subscriptions;
 
     //  List of udp pipes
     typedef std::vector<pipe_t *> udp_pipes_t;
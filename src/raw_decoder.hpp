@@ -28,6 +28,10 @@ class raw_decoder_t ZMQ_FINAL : public i_decoder
 
     void resize_buffer (size_t) {}
 
+    void set_buffer_pool (buffer_pool_t *pool_) { _allocator.set_pool (pool_); }
+
+    void release_buffer () { _allocator.deallocate (); }
+
   private:
     msg_t _in_progress;
 
@@ -362,8 +362,10 @@ void zmq::select_t::loop ()
                 }
             }
 
+            begin_wait ();
             rc = WSAWaitForMultipleEvents (4, wsa_events.events, FALSE,
                                            timeout ? timeout : INFINITE, FALSE);
+            end_wait (0);
             wsa_assert (rc != (int) WSA_WAIT_FAILED);
             zmq_assert (rc != WSA_WAIT_IO_COMPLETION);
 
@@ -403,8 +405,10 @@ void zmq::select_t::select_family_entry (family_entry_t &family_entry_,
         return;
 
     fds_set_t local_fds_set = family_entry_.fds_set;
+    begin_wait ();
     int rc = select (max_fd_, &local_fds_set.read, &local_fds_set.write,
                      &local_fds_set.error, use_timeout_ ? &tv_ : NULL);
+    end_wait (rc);
 
 #if defined ZMQ_HAVE_WINDOWS
     wsa_assert (rc != SOCKET_ERROR);
@@ -4,6 +4,7 @@
 #include "macros.hpp"
 #include "session_base.hpp"
 #include "i_engine.hpp"
+#include "io_thread.hpp"
 #include "err.hpp"
 #include "pipe.hpp"
 #include "likely.hpp"
@@ -86,6 +87,12 @@ zmq::session_base_t *zmq::session_base_t::create (class io_thread_t *io_thread_,
     return s;
 }
 
+//  Join and leave messages carry no payload and have no size.
+static size_t traffic_size (const zmq::msg_t *msg_)
+{
+    return msg_->is_join () || msg_->is_leave () ? 0 : msg_->size ();
+}
+
 zmq::session_base_t::session_base_t (class io_thread_t *io_thread_,
                                      bool active_,
                                      class socket_base_t *socket_,
@@ -102,7 +109,10 @@ zmq::session_base_t::session_base_t (class io_thread_t *io_thread_,
     _socket (socket_),
     _io_thread (io_thread_),
     _has_linger_timer (false),
-    _addr (addr_)
+    _traffic (0),
+    _balanced (false),
+    _addr (addr_),
+    _optimistic_handshake (active_ && options_.optimistic_handshake)
 #ifdef ZMQ_HAVE_WSS
     ,
     _wss_hostname (options_.wss_hostname)
@@ -130,6 +140,9 @@ zmq::session_base_t::~session_base_t ()
     if (_engine)
         _engine->terminate ();
 
+    if (_balanced)
+        _io_thread->remove_session (this);
+
     LIBZMQ_DELETE (_addr);
 }
 
@@ -149,18 +162,30 @@ int zmq::session_base_t::pull_msg (msg_t *msg_)
         return -1;
     }
 
+    _traffic += traffic_size (msg_);
     _incomplete_in = (msg_->flags () & msg_t::more) != 0;
 
     return 0;
 }
 
+int zmq::session_base_t::pull_msg_ahead (msg_t *msg_)
+{
+    if (!_pipe || !_pipe->check_read_msg ()) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return pull_msg (msg_);
+}
+
 int zmq::session_base_t::push_msg (msg_t *msg_)
 {
     //  pass subscribe/cancel to the sockets
     if ((msg_->flags () & msg_t::command) && !msg_->is_subscribe ()
         && !msg_->is_cancel ())
         return 0;
+    const size_t size = traffic_size (msg_);
     if (_pipe && _pipe->write (msg_)) {
+        _traffic += size;
         const int rc = msg_->init ();
         errno_assert (rc == 0);
         return 0;
@@ -321,10 +346,55 @@ zmq::socket_base_t *zmq::session_base_t::get_socket () const
 
 void zmq::session_base_t::process_plug ()
 {
+    _balanced = _io_thread->add_session (this);
+
     if (_active)
         start_connecting (false);
 }
 
+uint64_t zmq::session_base_t::take_traffic ()
+{
+    const uint64_t traffic = _traffic;
+    _traffic = 0;
+    return traffic;
+}
+
+uint64_t zmq::session_base_t::get_affinity () const
+{
+    return options.affinity;
+}
+
+bool zmq::session_base_t::migratable () const
+{
+    //  Commands for a migrated session are forwarded by the I/O thread it
+    //  was created in; to keep that simple, it never moves a second time.
+    return get_exec_tid () == get_tid () && !is_terminating () && !_pending
+           && _pipe && !_zap_pipe && _terminating_pipes.empty ()
+           && !_has_linger_timer && _engine && _engine->migratable ();
+}
+
+void zmq::session_base_t::migrate_out (io_thread_t *io_thread_)
+{
+    zmq_assert (migratable ());
+
+    _engine->migrate_out ();
+    io_object_t::unplug ();
+
+    //  From now on, commands sent to the session or its pipe are passed
+    //  on to the new I/O thread. New pipes and engines inherit it.
+    set_exec_tid (io_thread_->get_tid ());
+    _pipe->set_exec_tid (io_thread_->get_tid ());
+    _io_thread = io_thread_;
+
+    send_migrate (io_thread_, this);
+}
+
+void zmq::session_base_t::migrate_in ()
+{
+    io_object_t::plug (_io_thread);
+    _engine->migrate_in (_io_thread);
+}
+
 //  This functions can return 0 on success or -1 and errno=ECONNREFUSED if ZAP
 //  is not setup (IE: inproc://zeromq.zap.01 does not exist in the same context)
 //  or it aborts on any other error. In other words, either ZAP is not
@@ -379,6 +449,16 @@ bool zmq::session_base_t::zap_enabled () const
     return (options.mechanism != ZMQ_NULL || !options.zap_domain.empty ());
 }
 
+bool zmq::session_base_t::optimistic_handshake () const
+{
+    return _optimistic_handshake;
+}
+
+void zmq::session_base_t::disable_optimistic_handshake ()
+{
+    _optimistic_handshake = false;
+}
+
 void zmq::session_base_t::process_attach (i_engine *engine_)
 {
     zmq_assert (engine_ != NULL);
@@ -404,7 +484,8 @@ void zmq::session_base_t::engine_ready ()
         int hwms[2] = {conflate ? -1 : options.rcvhwm,
                        conflate ? -1 : options.sndhwm};
         bool conflates[2] = {conflate, conflate};
-        const int rc = pipepair (parents, pipes, hwms, conflates);
+        const int rc =
+          pipepair (parents, pipes, hwms, conflates, options.conflate_key);
         errno_assert (rc == 0);
 
         //  Plug the local end of the pipe.
@@ -539,6 +620,20 @@ void zmq::session_base_t::process_conn_failed ()
     send_term_endpoint (_socket, ep);
 }
 
+void zmq::session_base_t::notify_crypto_done (void *session_)
+{
+    session_base_t *session = static_cast<session_base_t *> (session_);
+    session->send_crypto_done (session);
+}
+
+void zmq::session_base_t::process_crypto_done ()
+{
+    //  The engine may have been replaced meanwhile; a notification it
+    //  has no pending step for is ignored.
+    if (_engine)
+        _engine->crypto_done ();
+}
+
 void zmq::session_base_t::reconnect ()
 {
     //  For delayed connect situations, terminate the pipe
@@ -51,11 +51,23 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     int zap_connect ();
     bool zap_enabled () const;
 
+    //  Returns true if the engine may send its greeting without waiting
+    //  for the peer's. The engine calls disable_optimistic_handshake when
+    //  the peer turns out not to support it, so that the session falls
+    //  back to the regular handshake when reconnecting.
+    bool optimistic_handshake () const;
+    void disable_optimistic_handshake ();
+
     //  Fetches a message. Returns 0 if successful; -1 otherwise.
     //  The caller is responsible for freeing the message when no
     //  longer used.
     virtual int pull_msg (msg_t *msg_);
 
+    //  Fetches a message if one is available without reaching the pipe
+    //  delimiter. Used by engines reading ahead of what they can send,
+    //  so that the pipe is not terminated while messages are pending.
+    int pull_msg_ahead (msg_t *msg_);
+
     //  Receives message from ZAP socket.
     //  Returns 0 on success; -1 otherwise.
     //  The caller is responsible for freeing the message.
@@ -69,6 +81,34 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     socket_base_t *get_socket () const;
     const endpoint_uri_pair_t &get_endpoint () const;
 
+    //  Following functions are the interface exposed towards the I/O
+    //  thread balancing the load. They are called from the thread the
+    //  session is currently running in.
+
+    //  Returns the number of message bytes that went through the session
+    //  since the last call.
+    uint64_t take_traffic ();
+
+    //  Returns the set of I/O threads the session may run in.
+    uint64_t get_affinity () const;
+
+    //  Returns true if the session and its engine can be moved to another
+    //  I/O thread. Each session is moved at most once.
+    bool migratable () const;
+
+    //  Unplugs the session and its engine so they can be handed over to
+    //  the specified I/O thread.
+    void migrate_out (zmq::io_thread_t *io_thread_);
+
+    //  Plugs the session and its engine into the current I/O thread.
+    void migrate_in ();
+
+    //  Notifies the engine of the session, in the session's thread, that
+    //  an asynchronous handshake step has completed. May be called from
+    //  any thread; the caller must have called inc_seqnum on the session
+    //  beforehand, which keeps the session alive until then.
+    static void notify_crypto_done (void *session_);
+
   protected:
     session_base_t (zmq::io_thread_t *io_thread_,
                     bool active_,
@@ -87,6 +127,7 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     void process_attach (zmq::i_engine *engine_) ZMQ_FINAL;
     void process_term (int linger_) ZMQ_FINAL;
     void process_conn_failed () ZMQ_OVERRIDE;
+    void process_crypto_done () ZMQ_FINAL;
 
     //  i_poll_events handlers.
     void timer_event (int id_) ZMQ_FINAL;
@@ -135,9 +176,20 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     //  True is linger timer is running.
     bool _has_linger_timer;
 
+    //  Number of message bytes pushed and pulled since the last time
+    //  the I/O thread took a measurement.
+    uint64_t _traffic;
+
+    //  True if the session is registered for load balancing with the
+    //  I/O thread it is running in.
+    bool _balanced;
+
     //  Protocol and address to use when connecting.
     address_t *_addr;
 
+    //  True if the engines of this session use the optimistic handshake.
+    bool _optimistic_handshake;
+
 #ifdef ZMQ_HAVE_WSS
     //  TLS handshake, we need to take a copy when the session is created,
     //  in order to maintain the value at the creation time
@@ -228,22 +228,22 @@ zmq::socket_base_t::socket_base_t (ctx_t *parent_,
                                    uint32_t tid_,
                                    int sid_,
                                    bool thread_safe_) :
-    own_t (parent_, tid_),
+    own_t (parent_, tid_, options),
     _sync (),
     _tag (0xbaddecaf),
     _ctx_terminated (false),
     _destroyed (false),
     _poller (NULL),
     _handle (static_cast<poller_t::handle_t> (NULL)),
-    _last_tsc (0),
-    _ticks (0),
+    _reaper_plugged (false),
     _rcvmore (false),
     _monitor_socket (NULL),
     _monitor_events (0),
     _thread_safe (thread_safe_),
     _reaper_signaler (NULL),
     _monitor_sync (),
-    _disconnected (false)
+    _disconnected (false),
+    _options_snapshot (NULL)
 {
     options.socket_id = sid_;
     options.ipv6 = (parent_->get (ZMQ_IPV6) != 0);
@@ -254,15 +254,9 @@ zmq::socket_base_t::socket_base_t (ctx_t *parent_,
         _mailbox = new (std::nothrow) mailbox_safe_t (&_sync);
         zmq_assert (_mailbox);
     } else {
-        mailbox_t *m = new (std::nothrow) mailbox_t ();
-        zmq_assert (m);
-
-        if (m->get_fd () != retired_fd)
-            _mailbox = m;
-        else {
-            LIBZMQ_DELETE (m);
-            _mailbox = NULL;
-        }
+        //  The mailbox creates its file descriptor only once it is needed.
+        _mailbox = new (std::nothrow) mailbox_t ();
+        zmq_assert (_mailbox);
     }
 }
 
@@ -288,6 +282,8 @@ zmq::socket_base_t::~socket_base_t ()
     scoped_lock_t lock (_monitor_sync);
     stop_monitor ();
 
+    drop_options_snapshot ();
+
     zmq_assert (_destroyed);
 }
 
@@ -426,6 +422,9 @@ int zmq::socket_base_t::setsockopt (int option_,
         return -1;
     }
 
+    //  Objects created from now on get the options as changed.
+    drop_options_snapshot ();
+
     //  First, check whether specific socket type overloads the option.
     int rc = xsetsockopt (option_, optval_, optvallen_);
     if (rc == 0 || errno != EINVAL) {
@@ -440,6 +439,21 @@ int zmq::socket_base_t::setsockopt (int option_,
     return rc;
 }
 
+const zmq::options_t &zmq::socket_base_t::options_snapshot ()
+{
+    if (!_options_snapshot)
+        _options_snapshot = &share_options (options);
+    return *_options_snapshot;
+}
+
+void zmq::socket_base_t::drop_options_snapshot ()
+{
+    if (_options_snapshot) {
+        release_options (*_options_snapshot);
+        _options_snapshot = NULL;
+    }
+}
+
 int zmq::socket_base_t::getsockopt (int option_,
                                     void *optval_,
                                     size_t *optvallen_)
@@ -468,13 +482,14 @@ int zmq::socket_base_t::getsockopt (int option_,
             return -1;
         }
 
-        return do_getsockopt<fd_t> (
-          optval_, optvallen_,
-          (static_cast<mailbox_t *> (_mailbox))->get_fd ());
+        const fd_t fd = (static_cast<mailbox_t *> (_mailbox))->get_fd ();
+        if (fd == retired_fd)
+            return -1;
+        return do_getsockopt<fd_t> (optval_, optvallen_, fd);
     }
 
     if (option_ == ZMQ_EVENTS) {
-        const int rc = process_commands (0, false);
+        const int rc = process_commands (0);
         if (rc != 0 && (errno == EINTR || errno == ETERM)) {
             return -1;
         }
@@ -533,6 +548,12 @@ void zmq::socket_base_t::remove_signaler (signaler_t *s_)
     (static_cast<mailbox_safe_t *> (_mailbox))->remove_signaler (s_);
 }
 
+bool zmq::socket_base_t::set_mailbox_events (i_mailbox_events *events_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+    return _mailbox->set_events (events_);
+}
+
 int zmq::socket_base_t::bind (const char *endpoint_uri_)
 {
     scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
@@ -543,7 +564,7 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
     }
 
     //  Process pending commands, if any.
-    int rc = process_commands (0, false);
+    int rc = process_commands (0);
     if (unlikely (rc != 0)) {
         return -1;
     }
@@ -611,8 +632,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
             return -1;
         }
 
-        session_base_t *session =
-          session_base_t::create (io_thread, true, this, options, paddr);
+        session_base_t *session = session_base_t::create (
+          io_thread, true, this, options_snapshot (), paddr);
         errno_assert (session);
 
         //  Create a bi-directional pipe.
@@ -651,8 +672,12 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
     }
 
     if (protocol == protocol_name::tcp) {
-        tcp_listener_t *listener =
-          new (std::nothrow) tcp_listener_t (io_thread, this, options);
+#ifdef ZMQ_HAVE_SO_REUSEPORT
+        if (options.tcp_listen_shards != 0 && options.use_fd == -1)
+            return bind_tcp_sharded (address);
+#endif
+        tcp_listener_t *listener = new (std::nothrow) tcp_listener_t (
+          io_thread, this, options_snapshot ());
         alloc_assert (listener);
         rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -675,11 +700,11 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 #ifdef ZMQ_HAVE_WSS
     if (protocol == protocol_name::ws || protocol == protocol_name::wss) {
         ws_listener_t *listener = new (std::nothrow) ws_listener_t (
-          io_thread, this, options, protocol == protocol_name::wss);
+          io_thread, this, options_snapshot (), protocol == protocol_name::wss);
 #else
     if (protocol == protocol_name::ws) {
-        ws_listener_t *listener =
-          new (std::nothrow) ws_listener_t (io_thread, this, options, false);
+        ws_listener_t *listener = new (std::nothrow) ws_listener_t (
+          io_thread, this, options_snapshot (), false);
 #endif
         alloc_assert (listener);
         rc = listener->set_local_address (address.c_str ());
@@ -702,8 +727,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 
 #if defined ZMQ_HAVE_IPC
     if (protocol == protocol_name::ipc) {
-        ipc_listener_t *listener =
-          new (std::nothrow) ipc_listener_t (io_thread, this, options);
+        ipc_listener_t *listener = new (std::nothrow) ipc_listener_t (
+          io_thread, this, options_snapshot ());
         alloc_assert (listener);
         int rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -724,8 +749,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 #endif
 #if defined ZMQ_HAVE_TIPC
     if (protocol == protocol_name::tipc) {
-        tipc_listener_t *listener =
-          new (std::nothrow) tipc_listener_t (io_thread, this, options);
+        tipc_listener_t *listener = new (std::nothrow) tipc_listener_t (
+          io_thread, this, options_snapshot ());
         alloc_assert (listener);
         int rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -747,8 +772,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 #endif
 #if defined ZMQ_HAVE_VMCI
     if (protocol == protocol_name::vmci) {
-        vmci_listener_t *listener =
-          new (std::nothrow) vmci_listener_t (io_thread, this, options);
+        vmci_listener_t *listener = new (std::nothrow) vmci_listener_t (
+          io_thread, this, options_snapshot ());
         alloc_assert (listener);
         int rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -769,8 +794,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 
 #if defined ZMQ_HAVE_VSOCK
     if (protocol == protocol_name::vsock) {
-        vsock_listener_t *listener =
-          new (std::nothrow) vsock_listener_t (io_thread, this, options);
+        vsock_listener_t *listener = new (std::nothrow) vsock_listener_t (
+          io_thread, this, options_snapshot ());
         alloc_assert (listener);
         int rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -793,6 +818,69 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
     return -1;
 }
 
+#ifdef ZMQ_HAVE_SO_REUSEPORT
+int zmq::socket_base_t::bind_tcp_sharded (const std::string &address_)
+{
+    std::vector<io_thread_t *> io_threads;
+    choose_io_threads (options.affinity, options.tcp_listen_shards,
+                       io_threads);
+    zmq_assert (!io_threads.empty ());
+
+    //  The first listener resolves the address, including wildcard ports.
+    tcp_listener_t *listener = new (std::nothrow) tcp_listener_t (
+      io_threads[0], this, options_snapshot ());
+    alloc_assert (listener);
+    int rc = listener->set_local_address (address_.c_str ());
+    if (rc != 0) {
+        LIBZMQ_DELETE (listener);
+        event_bind_failed (make_unconnected_bind_endpoint_pair (address_),
+                           zmq_errno ());
+        return -1;
+    }
+
+    std::string endpoint;
+    listener->get_local_address (endpoint);
+
+    //  The remaining shards bind to the very same resolved address. If any
+    //  of them cannot be opened, the whole bind fails, rather than leaving
+    //  fewer listeners than asked for.
+    std::vector<tcp_listener_t *> shards (1, listener);
+    const std::string resolved_address =
+      endpoint.substr (strlen (protocol_name::tcp) + 3);
+    for (size_t i = 1, size = io_threads.size (); i != size; i++) {
+        tcp_listener_t *shard = new (std::nothrow) tcp_listener_t (
+          io_threads[i], this, options_snapshot ());
+        alloc_assert (shard);
+        rc = shard->set_local_address (resolved_address.c_str ());
+        if (rc != 0) {
+            const int err = errno;
+            LIBZMQ_DELETE (shard);
+            for (size_t j = 0, opened = shards.size (); j != opened; j++) {
+                shards[j]->close ();
+                LIBZMQ_DELETE (shards[j]);
+            }
+            event_bind_failed (make_unconnected_bind_endpoint_pair (endpoint),
+                               err);
+            errno = err;
+            return -1;
+        }
+        shards.push_back (shard);
+    }
+
+    // Save last endpoint URI
+    _last_endpoint = endpoint;
+
+    if (options.tcp_listen_cpu_steering)
+        listener->attach_cpu_steering (static_cast<int> (shards.size ()));
+
+    for (size_t i = 0, size = shards.size (); i != size; i++)
+        add_endpoint (make_unconnected_bind_endpoint_pair (_last_endpoint),
+                      static_cast<own_t *> (shards[i]), NULL);
+    options.connected = true;
+    return 0;
+}
+#endif
+
 int zmq::socket_base_t::connect (const char *endpoint_uri_)
 {
     scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
@@ -807,7 +895,7 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
     }
 
     //  Process pending commands, if any.
-    int rc = process_commands (0, false);
+    int rc = process_commands (0);
     if (unlikely (rc != 0)) {
         return -1;
     }
@@ -847,7 +935,8 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
 
         int hwms[2] = {conflate ? -1 : sndhwm, conflate ? -1 : rcvhwm};
         bool conflates[2] = {conflate, conflate};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        rc = pipepair (parents, new_pipes, hwms, conflates,
+                      options.conflate_key);
         if (!conflate) {
             new_pipes[0]->set_hwms_boost (peer.options.sndhwm,
                                           peer.options.rcvhwm);
@@ -1101,8 +1190,8 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
 #endif
 
     //  Create session.
-    session_base_t *session =
-      session_base_t::create (io_thread, true, this, options, paddr);
+    session_base_t *session = session_base_t::create (
+      io_thread, true, this, options_snapshot (), paddr);
     errno_assert (session);
 
     //  PGM does not support subscription forwarding; ask for all data to be
@@ -1133,7 +1222,8 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
         int hwms[2] = {conflate ? -1 : options.sndhwm,
                        conflate ? -1 : options.rcvhwm};
         bool conflates[2] = {conflate, conflate};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        rc = pipepair (parents, new_pipes, hwms, conflates,
+                      options.conflate_key);
         errno_assert (rc == 0);
 
         //  Attach local end of the pipe to the socket object.
@@ -1210,7 +1300,7 @@ int zmq::socket_base_t::term_endpoint (const char *endpoint_uri_)
 
     //  Process pending commands, if any, since there could be pending unprocessed process_own()'s
     //  (from launch_child() for example) we're asked to terminate now.
-    const int rc = process_commands (0, false);
+    const int rc = process_commands (0);
     if (unlikely (rc != 0)) {
         return -1;
     }
@@ -1277,7 +1367,7 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
     }
 
     //  Process pending commands, if any.
-    int rc = process_commands (0, true);
+    int rc = process_commands (0);
     if (unlikely (rc != 0)) {
         return -1;
     }
@@ -1327,7 +1417,7 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
     //  command, process it and try to send the message again.
     //  If timeout is reached in the meantime, return EAGAIN.
     while (true) {
-        if (unlikely (process_commands (timeout, false) != 0)) {
+        if (unlikely (process_commands (timeout) != 0)) {
             return -1;
         }
         rc = xsend (msg_);
@@ -1364,19 +1454,10 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
         return -1;
     }
 
-    //  Once every inbound_poll_rate messages check for signals and process
-    //  incoming commands. This happens only if we are not polling altogether
-    //  because there are messages available all the time. If poll occurs,
-    //  ticks is set to zero and thus we avoid this code.
-    //
-    //  Note that 'recv' uses different command throttling algorithm (the one
-    //  described above) from the one used by 'send'. This is because counting
-    //  ticks is more efficient than doing RDTSC all the time.
-    if (++_ticks == inbound_poll_rate) {
-        if (unlikely (process_commands (0, false) != 0)) {
-            return -1;
-        }
-        _ticks = 0;
+    //  Process pending commands, if any. Even when there are messages
+    //  available all the time, the commands are not held up.
+    if (unlikely (process_commands (0) != 0)) {
+        return -1;
     }
 
     //  Get the message.
@@ -1396,10 +1477,9 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
     //  activate_reader command already waiting in a command pipe.
     //  If it's not, return EAGAIN.
     if ((flags_ & ZMQ_DONTWAIT) || options.rcvtimeo == 0) {
-        if (unlikely (process_commands (0, false) != 0)) {
+        if (unlikely (process_commands (0) != 0)) {
             return -1;
         }
-        _ticks = 0;
 
         rc = xrecv (msg_);
         if (rc < 0) {
@@ -1415,22 +1495,38 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
     int timeout = options.rcvtimeo;
     const uint64_t end = timeout < 0 ? 0 : (_clock.now_ms () + timeout);
 
+    //  Before going to sleep, keep looking for the message for a while.
+    //  Waking up costs several system calls on both sides.
+    if (options.rcvspin > 0) {
+        rc = spin_recv (msg_, timeout);
+        if (rc == 0) {
+            extract_flags (msg_);
+            return 0;
+        }
+        if (unlikely (errno != EAGAIN)) {
+            return -1;
+        }
+        if (timeout > 0) {
+            timeout = static_cast<int> (end - _clock.now_ms ());
+            if (timeout <= 0) {
+                errno = EAGAIN;
+                return -1;
+            }
+        }
+    }
+
     //  In blocking scenario, commands are processed over and over again until
     //  we are able to fetch a message.
-    bool block = (_ticks != 0);
     while (true) {
-        if (unlikely (process_commands (block ? timeout : 0, false) != 0)) {
+        if (unlikely (process_commands (timeout) != 0)) {
             return -1;
         }
         rc = xrecv (msg_);
-        if (rc == 0) {
-            _ticks = 0;
+        if (rc == 0)
             break;
-        }
         if (unlikely (errno != EAGAIN)) {
             return -1;
         }
-        block = true;
         if (timeout > 0) {
             timeout = static_cast<int> (end - _clock.now_ms ());
             if (timeout <= 0) {
@@ -1476,67 +1572,80 @@ bool zmq::socket_base_t::has_out ()
 
 void zmq::socket_base_t::start_reaping (poller_t *poller_)
 {
+    //  Initialise the termination and check whether it can be deallocated
+    //  immediately. If so, no more commands are expected, and the socket is
+    //  not plugged to the reaper thread, which spares creating a file
+    //  descriptor for it.
+    terminate ();
+    if (_destroyed) {
+        check_destroy ();
+        return;
+    }
+
     //  Plug the socket to the reaper thread.
     _poller = poller_;
+    plug_to_reaper ();
+}
 
+void zmq::socket_base_t::plug_to_reaper ()
+{
     fd_t fd;
 
-    if (!_thread_safe)
+    if (!_thread_safe) {
+        //  The mailbox creates its signaler on demand, which may fail for
+        //  lack of file descriptors.
         fd = (static_cast<mailbox_t *> (_mailbox))->get_fd ();
-    else {
+    } else {
         scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
 
         _reaper_signaler = new (std::nothrow) signaler_t ();
-        zmq_assert (_reaper_signaler);
-
-        //  Add signaler to the safe mailbox
-        fd = _reaper_signaler->get_fd ();
-        (static_cast<mailbox_safe_t *> (_mailbox))
-          ->add_signaler (_reaper_signaler);
+        alloc_assert (_reaper_signaler);
+        if (_reaper_signaler->valid ()) {
+            //  Add signaler to the safe mailbox
+            fd = _reaper_signaler->get_fd ();
+            (static_cast<mailbox_safe_t *> (_mailbox))
+              ->add_signaler (_reaper_signaler);
+
+            //  Send a signal to make sure reaper handle existing commands
+            _reaper_signaler->send ();
+        } else {
+            LIBZMQ_DELETE (_reaper_signaler);
+            fd = retired_fd;
+        }
+    }
 
-        //  Send a signal to make sure reaper handle existing commands
-        _reaper_signaler->send ();
+    //  Rather than fail the termination, check for commands now and then,
+    //  and try again.
+    if (fd == retired_fd) {
+        _poller->add_timer (reaper_retry_ivl, this, reaper_timer_id);
+        return;
     }
 
     _handle = _poller->add_fd (fd, this);
     _poller->set_pollin (_handle);
-
-    //  Initialise the termination and check whether it can be deallocated
-    //  immediately.
-    terminate ();
-    check_destroy ();
+    _reaper_plugged = true;
 }
 
-int zmq::socket_base_t::process_commands (int timeout_, bool throttle_)
+int zmq::socket_base_t::process_commands (int timeout_)
 {
-    if (timeout_ == 0) {
-        //  If we are asked not to wait, check whether we haven't processed
-        //  commands recently, so that we can throttle the new commands.
-
-        //  Get the CPU's tick counter. If 0, the counter is not available.
-        const uint64_t tsc = zmq::clock_t::rdtsc ();
-
-        //  Optimised version of command processing - it doesn't have to check
-        //  for incoming commands each time. It does so only if certain time
-        //  elapsed since last command processing. Command delay varies
-        //  depending on CPU speed: It's ~1ms on 3GHz CPU, ~2ms on 1.5GHz CPU
-        //  etc. The optimisation makes sense only on platforms where getting
-        //  a timestamp is a very cheap operation (tens of nanoseconds).
-        if (tsc && throttle_) {
-            //  Check whether TSC haven't jumped backwards (in case of migration
-            //  between CPU cores) and whether certain time have elapsed since
-            //  last command processing. If it didn't do nothing.
-            if (tsc >= _last_tsc && tsc - _last_tsc <= max_command_delay)
-                return 0;
-            _last_tsc = tsc;
+    //  If we are asked not to wait, poll the mailbox only if a command was
+    //  posted to it. Checking for that is cheap enough to be done on each
+    //  message sent or received.
+    if (timeout_ == 0 && !_mailbox->pending ()) {
+        if (unlikely (_ctx_terminated)) {
+            errno = ETERM;
+            return -1;
         }
+        return 0;
     }
 
     //  Check whether there are any commands pending for this thread.
     command_t cmd;
     int rc = _mailbox->recv (&cmd, timeout_);
 
-    if (rc != 0 && errno == EINTR)
+    //  Besides EINTR, waiting fails if the mailbox's signaler cannot be
+    //  created.
+    if (rc != 0 && errno != EAGAIN)
         return -1;
 
     //  Process all available commands.
@@ -1557,6 +1666,47 @@ int zmq::socket_base_t::process_commands (int timeout_, bool throttle_)
     return 0;
 }
 
+int zmq::socket_base_t::spin_recv (msg_t *msg_, int timeout_)
+{
+    uint64_t spin = static_cast<uint64_t> (options.rcvspin);
+    if (timeout_ >= 0 && spin > static_cast<uint64_t> (timeout_) * 1000)
+        spin = static_cast<uint64_t> (timeout_) * 1000;
+    const uint64_t end = clock_t::now_us () + spin;
+
+    int rc;
+    for (unsigned int i = 1;; i++) {
+        //  The mailbox stays active while spinning, so that the peers post
+        //  their commands, notably the pipe activations, without waking
+        //  this thread up.
+        command_t cmd;
+        while (_mailbox->try_recv (&cmd) == 0)
+            cmd.destination->process_command (cmd);
+        if (unlikely (_ctx_terminated)) {
+            errno = ETERM;
+            return -1;
+        }
+
+        rc = xrecv (msg_);
+        if (rc == 0 || errno != EAGAIN)
+            break;
+
+        //  Reading the clock costs more than checking the pipes.
+        if (i % spin_clock_interval == 0 && clock_t::now_us () >= end)
+            break;
+    }
+
+    //  Leave the mailbox passive, as the peers have to wake the thread up
+    //  from now on. The commands processed on the way may have brought
+    //  the message.
+    const int saved_errno = errno;
+    if (unlikely (process_commands (0) != 0))
+        return -1;
+    if (rc != 0 && saved_errno == EAGAIN)
+        return xrecv (msg_);
+    errno = saved_errno;
+    return rc;
+}
+
 void zmq::socket_base_t::process_stop ()
 {
     //  Here, someone have called zmq_ctx_term while the socket was still alive.
@@ -1734,7 +1884,7 @@ void zmq::socket_base_t::in_event ()
         if (_thread_safe)
             _reaper_signaler->recv ();
 
-        process_commands (0, false);
+        process_commands (0);
     }
     check_destroy ();
 }
@@ -1744,17 +1894,29 @@ void zmq::socket_base_t::out_event ()
     zmq_assert (false);
 }
 
-void zmq::socket_base_t::timer_event (int)
+void zmq::socket_base_t::timer_event (int id_)
 {
-    zmq_assert (false);
+    //  The reaper could not poll the mailbox: check it for commands as
+    //  in_event does.
+    zmq_assert (id_ == reaper_timer_id);
+    {
+        scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+        process_commands (0);
+    }
+    if (_destroyed)
+        check_destroy ();
+    else
+        plug_to_reaper ();
 }
 
 void zmq::socket_base_t::check_destroy ()
 {
     //  If the object was already marked as destroyed, finish the deallocation.
     if (_destroyed) {
-        //  Remove the socket from the reaper's poller.
-        _poller->rm_fd (_handle);
+        //  Remove the socket from the reaper's poller, if it was plugged to
+        //  it.
+        if (_reaper_plugged)
+            _poller->rm_fd (_handle);
 
         //  Remove the socket from the context.
         destroy_socket (this);
@@ -65,6 +65,11 @@ class socket_base_t : public own_t,
     void remove_signaler (signaler_t *s_);
     int close ();
 
+    //  Registers the object to notify when commands are posted to the
+    //  socket, or unregisters it if NULL. Returns false if the socket
+    //  notifies another object already.
+    bool set_mailbox_events (i_mailbox_events *events_);
+
     //  These functions are used by the polling mechanism to determine
     //  which events are to be reported from this socket.
     bool has_in ();
@@ -196,6 +201,16 @@ class socket_base_t : public own_t,
     // Mutex for synchronize access to the socket in thread safe mode
     mutex_t _sync;
 
+    //  Socket options, which own_t refers to as well.
+    options_t options;
+
+    //  Returns the snapshot of the options to create objects under. It is
+    //  made anew only after the options changed.
+    const options_t &options_snapshot ();
+
+    //  To be called when the options changed.
+    void drop_options_snapshot ();
+
   private:
     // test if event should be sent and then dispatch it
     void event (const endpoint_uri_pair_t &endpoint_uri_pair_,
@@ -240,6 +255,15 @@ class socket_base_t : public own_t,
     //  handlers explicitly. If required, it will deallocate the socket.
     void check_destroy ();
 
+    //  Plugs the mailbox to the reaper's poller, or, if no file descriptor
+    //  can be created for it, has the reaper check it on a timer instead.
+    void plug_to_reaper ();
+
+    enum
+    {
+        reaper_timer_id = 0x40
+    };
+
     //  Moves the flags from the message to local variables,
     //  to be later retrieved by getsockopt.
     void extract_flags (const msg_t *msg_);
@@ -263,6 +287,12 @@ class socket_base_t : public own_t,
     //  bind, is available and compatible with the socket type.
     int check_protocol (const std::string &protocol_) const;
 
+#ifdef ZMQ_HAVE_SO_REUSEPORT
+    //  Binds a TCP endpoint using one SO_REUSEPORT listener per chosen
+    //  I/O thread.
+    int bind_tcp_sharded (const std::string &address_);
+#endif
+
     //  Register the pipe with this socket.
     void attach_pipe (zmq::pipe_t *pipe_,
                       bool subscribe_to_all_ = false,
@@ -270,9 +300,12 @@ class socket_base_t : public own_t,
 
     //  Processes commands sent to this socket (if any). If timeout is -1,
     //  returns only after at least one command was processed.
-    //  If throttle argument is true, commands are processed at most once
-    //  in a predefined time period.
-    int process_commands (int timeout_, bool throttle_);
+    int process_commands (int timeout_);
+
+    //  Keeps trying to receive a message, processing the commands as they
+    //  come, for ZMQ_RCVSPIN microseconds but no longer than the timeout,
+    //  in milliseconds, unless it is negative.
+    int spin_recv (msg_t *msg_, int timeout_);
 
     //  Handlers for incoming commands.
     void process_stop () ZMQ_FINAL;
@@ -300,11 +333,9 @@ class socket_base_t : public own_t,
     poller_t *_poller;
     poller_t::handle_t _handle;
 
-    //  Timestamp of when commands were processed the last time.
-    uint64_t _last_tsc;
-
-    //  Number of messages received since last command processing.
-    int _ticks;
+    //  True if the socket's mailbox is plugged to the reaper's poller.
+    //  Otherwise the reaper checks the mailbox on a timer.
+    bool _reaper_plugged;
 
     //  True if the last message received had MORE flag set.
     bool _rcvmore;
@@ -334,6 +365,10 @@ class socket_base_t : public own_t,
 
     // Add a flag for mark disconnect action
     bool _disconnected;
+
+    //  Snapshot of the options shared by the objects created under them,
+    //  if any was made since they last changed.
+    const options_t *_options_snapshot;
 };
 
 class routing_socket_base_t : public socket_base_t
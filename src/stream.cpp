@@ -258,6 +258,7 @@ void zmq::stream_t::identify_peer (pipe_t *pipe_, bool locally_initiated_)
         memcpy (options.routing_id, routing_id.data (), routing_id.size ());
         options.routing_id_size =
           static_cast<unsigned char> (routing_id.size ());
+        drop_options_snapshot ();
     }
     pipe_->set_router_socket_routing_id (routing_id);
     add_out_pipe (ZMQ_MOVE (routing_id), pipe_);
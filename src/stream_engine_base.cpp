@@ -16,6 +16,7 @@
 #include "stream_engine_base.hpp"
 #include "io_thread.hpp"
 #include "session_base.hpp"
+#include "ctx.hpp"
 #include "v1_encoder.hpp"
 #include "v1_decoder.hpp"
 #include "v2_encoder.hpp"
@@ -36,6 +37,29 @@
 #include "likely.hpp"
 #include "wire.hpp"
 
+//  Allocates an array of count_ empty messages.
+static zmq::msg_t *alloc_batch (size_t count_)
+{
+    zmq::msg_t *batch = new (std::nothrow) zmq::msg_t[count_];
+    alloc_assert (batch);
+    for (size_t i = 0; i != count_; i++) {
+        const int rc = batch[i].init ();
+        errno_assert (rc == 0);
+    }
+    return batch;
+}
+
+//  Drops the messages in [begin_, end_), leaving empty messages behind.
+static void clear_batch (zmq::msg_t *batch_, size_t begin_, size_t end_)
+{
+    for (size_t i = begin_; i != end_; i++) {
+        int rc = batch_[i].close ();
+        errno_assert (rc == 0);
+        rc = batch_[i].init ();
+        errno_assert (rc == 0);
+    }
+}
+
 static std::string get_peer_address (zmq::fd_t s_)
 {
     std::string peer_address;
@@ -77,7 +101,7 @@ zmq::stream_engine_base_t::stream_engine_base_t (
   const options_t &options_,
   const endpoint_uri_pair_t &endpoint_uri_pair_,
   bool has_handshake_stage_) :
-    _options (options_),
+    _options (share_options (options_)),
     _inpos (NULL),
     _insize (0),
     _decoder (NULL),
@@ -85,6 +109,7 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _outsize (0),
     _encoder (NULL),
     _mechanism (NULL),
+    _crypto_pool (NULL),
     _next_msg (NULL),
     _process_msg (NULL),
     _metadata (NULL),
@@ -95,9 +120,20 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _has_ttl_timer (false),
     _has_timeout_timer (false),
     _has_heartbeat_timer (false),
+    _has_buffer_idle_timer (false),
+    _buffers_used (false),
+    _buffer_pool (NULL),
     _peer_address (get_peer_address (fd_)),
+    _tx_batch (NULL),
+    _tx_batch_pos (0),
+    _tx_batch_size (0),
+    _rx_batch (NULL),
+    _rx_batch_pos (0),
+    _rx_batch_decoded (0),
+    _rx_batch_size (0),
     _s (fd_),
     _handle (static_cast<handle_t> (NULL)),
+    _edge_triggered (false),
     _plugged (false),
     _handshaking (true),
     _io_error (false),
@@ -144,9 +180,20 @@ zmq::stream_engine_base_t::~stream_engine_base_t ()
         }
     }
 
+    if (_tx_batch != NULL) {
+        clear_batch (_tx_batch, 0, max_batch_size);
+        delete[] _tx_batch;
+    }
+    if (_rx_batch != NULL) {
+        clear_batch (_rx_batch, 0, max_batch_size);
+        delete[] _rx_batch;
+    }
+
     LIBZMQ_DELETE (_encoder);
     LIBZMQ_DELETE (_decoder);
     LIBZMQ_DELETE (_mechanism);
+
+    release_options (_options);
 }
 
 void zmq::stream_engine_base_t::plug (io_thread_t *io_thread_,
@@ -163,8 +210,12 @@ void zmq::stream_engine_base_t::plug (io_thread_t *io_thread_,
 
     //  Connect to I/O threads poller object.
     io_object_t::plug (io_thread_);
+    _buffer_pool = io_thread_->get_buffer_pool ();
     _handle = add_fd (_s);
     _io_error = false;
+    _edge_triggered = edge_triggered_capable ()
+                      && _session->get_ctx ()->get (ZMQ_EDGE_TRIGGERED)
+                      && set_edge_triggered (_handle);
 
     plug_internal ();
 }
@@ -194,6 +245,12 @@ void zmq::stream_engine_base_t::unplug ()
         cancel_timer (heartbeat_ivl_timer_id);
         _has_heartbeat_timer = false;
     }
+
+    if (_has_buffer_idle_timer) {
+        cancel_timer (buffer_idle_timer_id);
+        _has_buffer_idle_timer = false;
+    }
+
     //  Cancel all fd subscriptions.
     if (!_io_error)
         rm_fd (_handle);
@@ -252,6 +309,8 @@ bool zmq::stream_engine_base_t::in_event_internal ()
 
     //  If there's no data to process in the buffer...
     if (!_insize) {
+        use_buffers ();
+
         //  Retrieve the buffer and read as much data as possible.
         //  Note that buffer can be arbitrarily large. However, we assume
         //  the underlying TCP layer has fixed buffer size and thus the
@@ -259,6 +318,12 @@ bool zmq::stream_engine_base_t::in_event_internal ()
         size_t bufsize = 0;
         _decoder->get_buffer (&_inpos, &bufsize);
 
+        //  Whatever exceeds the budget stays in the socket until the other
+        //  connections of the I/O thread have had their turn.
+        if (_options.io_budget > 0
+            && bufsize > static_cast<size_t> (_options.io_budget))
+            bufsize = static_cast<size_t> (_options.io_budget);
+
         const int rc = read (_inpos, bufsize);
 
         if (rc == -1) {
@@ -271,6 +336,7 @@ bool zmq::stream_engine_base_t::in_event_internal ()
 
         //  Adjust input size
         _insize = static_cast<size_t> (rc);
+        count_bytes_read (_insize);
         // Adjust buffer size to received bytes
         _decoder->resize_buffer (_insize);
     }
@@ -290,6 +356,10 @@ bool zmq::stream_engine_base_t::in_event_internal ()
             break;
     }
 
+    //  No more input for now; hand over what was collected for the batch.
+    if (rc != -1 && _rx_batch_size > 0)
+        rc = flush_rx_batch ();
+
     //  Tear down the connection if we have failed to decode input data
     //  or the session has rejected the message.
     if (rc == -1) {
@@ -325,11 +395,17 @@ void zmq::stream_engine_base_t::out_event ()
             return;
         }
 
+        use_buffers ();
         _outpos = NULL;
         _outsize = _encoder->encode (&_outpos, 0);
 
         while (_outsize < static_cast<size_t> (_options.out_batch_size)) {
-            if ((this->*_next_msg) (&_tx_msg) == -1) {
+            //  The rest of an encoded batch holds the next nonces, so it
+            //  has to go out before anything else.
+            if (_tx_batch_pos < _tx_batch_size) {
+                const int rc = _tx_msg.move (_tx_batch[_tx_batch_pos++]);
+                errno_assert (rc == 0);
+            } else if ((this->*_next_msg) (&_tx_msg) == -1) {
                 //  ws_engine can cause an engine error and delete it, so
                 //  bail out immediately to avoid use-after-free
                 if (errno == ECONNRESET)
@@ -359,8 +435,14 @@ void zmq::stream_engine_base_t::out_event ()
     //  possible to the socket. Note that amount of data to write can be
     //  arbitrarily large. However, we assume that underlying TCP layer has
     //  limited transmission buffer and thus the actual number of bytes
-    //  written should be reasonably modest.
-    const int nbytes = write (_outpos, _outsize);
+    //  written should be reasonably modest. The budget, if any, limits it
+    //  further, so that the other connections of the I/O thread get their
+    //  turn sooner.
+    size_t to_write = _outsize;
+    if (_options.io_budget > 0
+        && to_write > static_cast<size_t> (_options.io_budget))
+        to_write = static_cast<size_t> (_options.io_budget);
+    const int nbytes = write (_outpos, to_write);
 
     //  IO error has occurred. We stop waiting for output events.
     //  The engine is not terminated until we detect input error;
@@ -372,6 +454,7 @@ void zmq::stream_engine_base_t::out_event ()
 
     _outpos += nbytes;
     _outsize -= nbytes;
+    count_bytes_written (nbytes);
 
     //  If we are still handshaking and there are no data
     //  to send, stop polling for output.
@@ -403,7 +486,10 @@ bool zmq::stream_engine_base_t::restart_input ()
     zmq_assert (_session != NULL);
     zmq_assert (_decoder != NULL);
 
-    int rc = (this->*_process_msg) (_decoder->msg ());
+    //  The message the session could not take is either the first one of
+    //  the receive batch not yet pushed or the last one decoded.
+    int rc = _rx_batch_size > 0 ? flush_rx_batch ()
+                                : (this->*_process_msg) (_decoder->msg ());
     if (rc == -1) {
         if (errno == EAGAIN)
             _session->flush ();
@@ -427,6 +513,9 @@ bool zmq::stream_engine_base_t::restart_input ()
             break;
     }
 
+    if (rc != -1 && _rx_batch_size > 0)
+        rc = flush_rx_batch ();
+
     if (rc == -1 && errno == EAGAIN)
         _session->flush ();
     else if (_io_error) {
@@ -504,11 +593,102 @@ void zmq::stream_engine_base_t::zap_msg_available ()
         restart_output ();
 }
 
+void zmq::stream_engine_base_t::crypto_done ()
+{
+    //  The notification may arrive before the mechanism was created, if it
+    //  was meant for the previous engine of the session.
+    if (_mechanism == NULL)
+        return;
+
+    const int rc = _mechanism->crypto_done ();
+    if (rc == -1) {
+        error (protocol_error);
+        return;
+    }
+    if (_input_stopped)
+        if (!restart_input ())
+            return;
+    if (_output_stopped)
+        restart_output ();
+}
+
 const zmq::endpoint_uri_pair_t &zmq::stream_engine_base_t::get_endpoint () const
 {
     return _endpoint_uri_pair;
 }
 
+bool zmq::stream_engine_base_t::migratable () const
+{
+    //  Only engines in the steady message flow can be moved. The remaining
+    //  timers carry deadlines that would be hard to transfer faithfully.
+    return _plugged && !_handshaking && !_io_error && !_has_handshake_timer
+           && !_has_ttl_timer && !_has_timeout_timer
+           && (_next_msg == &stream_engine_base_t::pull_and_encode
+               || _next_msg == &stream_engine_base_t::pull_msg_from_session)
+           && (_mechanism == NULL
+               || _mechanism->status () == mechanism_t::ready);
+}
+
+void zmq::stream_engine_base_t::migrate_out ()
+{
+    zmq_assert (migratable ());
+
+    if (_has_heartbeat_timer)
+        cancel_timer (heartbeat_ivl_timer_id);
+    if (_has_buffer_idle_timer)
+        cancel_timer (buffer_idle_timer_id);
+    rm_fd (_handle);
+    io_object_t::unplug ();
+}
+
+void zmq::stream_engine_base_t::migrate_in (io_thread_t *io_thread_)
+{
+    io_object_t::plug (io_thread_);
+    _handle = add_fd (_s);
+
+    //  The pools may only be used from their own I/O thread.
+    _buffer_pool = io_thread_->get_buffer_pool ();
+    if (_encoder)
+        _encoder->set_buffer_pool (_buffer_pool);
+    if (_decoder)
+        _decoder->set_buffer_pool (_buffer_pool);
+
+    //  Restore the polling state the engine had before it was moved.
+    if (!_input_stopped)
+        set_pollin ();
+    if (!_output_stopped)
+        set_pollout ();
+    if (_edge_triggered)
+        set_edge_triggered (_handle);
+    if (_has_heartbeat_timer)
+        add_timer (_options.heartbeat_interval, heartbeat_ivl_timer_id);
+    if (_has_buffer_idle_timer)
+        add_timer (buffer_idle_ivl, buffer_idle_timer_id);
+}
+
+void zmq::stream_engine_base_t::use_buffers ()
+{
+    _buffers_used = true;
+    if (!_has_buffer_idle_timer) {
+        //  The codecs may have been created since the timer last ran.
+        if (_encoder)
+            _encoder->set_buffer_pool (_buffer_pool);
+        if (_decoder)
+            _decoder->set_buffer_pool (_buffer_pool);
+        add_timer (buffer_idle_ivl, buffer_idle_timer_id);
+        _has_buffer_idle_timer = true;
+    }
+}
+
+void zmq::stream_engine_base_t::release_buffers ()
+{
+    //  Data left in a buffer is still to be decoded or written.
+    if (_decoder && _insize == 0 && !_input_stopped)
+        _decoder->release_buffer ();
+    if (_encoder && _outsize == 0)
+        _encoder->release_buffer ();
+}
+
 void zmq::stream_engine_base_t::mechanism_ready ()
 {
     if (_options.heartbeat_interval > 0 && !_has_heartbeat_timer) {
@@ -555,6 +735,13 @@ void zmq::stream_engine_base_t::mechanism_ready ()
     _next_msg = &stream_engine_base_t::pull_and_encode;
     _process_msg = &stream_engine_base_t::write_credential;
 
+    //  Messages are batched only for mechanisms encoding them on the crypto
+    //  pool; the others pass them straight through.
+    if (_crypto_pool != NULL && _mechanism->parallel_batches ()) {
+        _tx_batch = alloc_batch (max_batch_size);
+        _rx_batch = alloc_batch (max_batch_size);
+    }
+
     //  Compile metadata.
     properties_t properties;
     init_properties (properties);
@@ -608,6 +795,9 @@ int zmq::stream_engine_base_t::pull_and_encode (msg_t *msg_)
 {
     zmq_assert (_mechanism != NULL);
 
+    if (_tx_batch != NULL)
+        return pull_and_encode_batch (msg_);
+
     if (_session->pull_msg (msg_) == -1)
         return -1;
     if (_mechanism->encode (msg_) == -1)
@@ -615,13 +805,101 @@ int zmq::stream_engine_base_t::pull_and_encode (msg_t *msg_)
     return 0;
 }
 
+int zmq::stream_engine_base_t::pull_and_encode_batch (msg_t *msg_)
+{
+    zmq_assert (_tx_batch_pos == _tx_batch_size);
+
+    _tx_batch_pos = 0;
+    _tx_batch_size = 0;
+    if (_session->pull_msg (&_tx_batch[0]) == -1)
+        return -1;
+
+    //  Reading ahead must stop short of the pipe delimiter, otherwise the
+    //  session would terminate the engine before the batch is sent.
+    size_t count = 1;
+    while (count != max_batch_size
+           && _session->pull_msg_ahead (&_tx_batch[count]) == 0)
+        count++;
+
+    if (_mechanism->encode_batch (_tx_batch, count, _crypto_pool) == -1) {
+        const int err = errno;
+        clear_batch (_tx_batch, 0, count);
+        errno = err;
+        return -1;
+    }
+
+    const int rc = msg_->move (_tx_batch[0]);
+    errno_assert (rc == 0);
+    _tx_batch_pos = 1;
+    _tx_batch_size = count;
+    return 0;
+}
+
 int zmq::stream_engine_base_t::decode_and_push (msg_t *msg_)
 {
     zmq_assert (_mechanism != NULL);
 
+    //  Collect the message; the batch is decoded once it is full or once
+    //  there is no more input at hand.
+    if (_rx_batch != NULL) {
+        const int rc = _rx_batch[_rx_batch_size++].move (*msg_);
+        errno_assert (rc == 0);
+        if (_rx_batch_size == max_batch_size)
+            return flush_rx_batch ();
+        return 0;
+    }
+
     if (_mechanism->decode (msg_) == -1)
         return -1;
 
+    prepare_decoded_msg (msg_);
+    if (_session->push_msg (msg_) == -1) {
+        if (errno == EAGAIN)
+            _process_msg = &stream_engine_base_t::push_one_then_decode_and_push;
+        return -1;
+    }
+    return 0;
+}
+
+int zmq::stream_engine_base_t::flush_rx_batch ()
+{
+    zmq_assert (_rx_batch_size > 0);
+
+    if (_rx_batch_decoded < _rx_batch_size) {
+        size_t decoded = 0;
+        const int rc = _mechanism->decode_batch (
+          &_rx_batch[_rx_batch_decoded], _rx_batch_size - _rx_batch_decoded,
+          _crypto_pool, &decoded);
+        for (size_t i = 0; i != decoded; i++)
+            prepare_decoded_msg (&_rx_batch[_rx_batch_decoded + i]);
+        _rx_batch_decoded += decoded;
+
+        if (rc == -1) {
+            //  The connection is going down. Hand over what was received
+            //  intact as far as the session takes it, and drop the rest.
+            const int err = errno;
+            while (_rx_batch_pos < _rx_batch_decoded
+                   && _session->push_msg (&_rx_batch[_rx_batch_pos]) == 0)
+                _rx_batch_pos++;
+            clear_batch (_rx_batch, _rx_batch_pos, _rx_batch_size);
+            _rx_batch_pos = _rx_batch_decoded = _rx_batch_size = 0;
+            errno = err;
+            return -1;
+        }
+    }
+
+    while (_rx_batch_pos < _rx_batch_decoded) {
+        if (_session->push_msg (&_rx_batch[_rx_batch_pos]) == -1)
+            return -1;
+        _rx_batch_pos++;
+    }
+
+    _rx_batch_pos = _rx_batch_decoded = _rx_batch_size = 0;
+    return 0;
+}
+
+void zmq::stream_engine_base_t::prepare_decoded_msg (msg_t *msg_)
+{
     if (_has_timeout_timer) {
         _has_timeout_timer = false;
         cancel_timer (heartbeat_timeout_timer_id);
@@ -638,12 +916,6 @@ int zmq::stream_engine_base_t::decode_and_push (msg_t *msg_)
 
     if (_metadata)
         msg_->set_metadata (_metadata);
-    if (_session->push_msg (msg_) == -1) {
-        if (errno == EAGAIN)
-            _process_msg = &stream_engine_base_t::push_one_then_decode_and_push;
-        return -1;
-    }
-    return 0;
 }
 
 int zmq::stream_engine_base_t::push_one_then_decode_and_push (msg_t *msg_)
@@ -748,6 +1020,15 @@ void zmq::stream_engine_base_t::timer_event (int id_)
     } else if (id_ == heartbeat_timeout_timer_id) {
         _has_timeout_timer = false;
         error (timeout_error);
+    } else if (id_ == buffer_idle_timer_id) {
+        //  Keep the buffers for as long as there is traffic.
+        if (_buffers_used) {
+            _buffers_used = false;
+            add_timer (buffer_idle_ivl, buffer_idle_timer_id);
+        } else {
+            _has_buffer_idle_timer = false;
+            release_buffers ();
+        }
     } else
         // There are no other valid timer ids!
         assert (false);
@@ -763,10 +1044,23 @@ int zmq::stream_engine_base_t::read (void *data_, size_t size_)
         return -1;
     }
 
+    //  A short read drains the socket; the poller reports it again once
+    //  more data arrives.
+    if (_edge_triggered
+        && (rc == -1 ? errno == EAGAIN : static_cast<size_t> (rc) < size_))
+        reset_in_ready (_handle);
+
     return rc;
 }
 
 int zmq::stream_engine_base_t::write (const void *data_, size_t size_)
 {
-    return zmq::tcp_write (_s, data_, size_);
+    const int rc = zmq::tcp_write (_s, data_, size_);
+
+    //  A short write fills the send buffer; the poller reports the socket
+    //  again once there is room.
+    if (_edge_triggered && rc != -1 && static_cast<size_t> (rc) < size_)
+        reset_out_ready (_handle);
+
+    return rc;
 }
@@ -21,6 +21,8 @@ namespace zmq
 class io_thread_t;
 class session_base_t;
 class mechanism_t;
+class crypto_pool_t;
+class buffer_pool_t;
 
 //  This engine handles any socket with SOCK_STREAM semantics,
 //  e.g. TCP socket or an UNIX domain socket.
@@ -42,7 +44,11 @@ class stream_engine_base_t : public io_object_t, public i_engine
     bool restart_input () ZMQ_FINAL;
     void restart_output () ZMQ_FINAL;
     void zap_msg_available () ZMQ_FINAL;
+    void crypto_done () ZMQ_FINAL;
     const endpoint_uri_pair_t &get_endpoint () const ZMQ_FINAL;
+    bool migratable () const ZMQ_FINAL;
+    void migrate_out () ZMQ_FINAL;
+    void migrate_in (zmq::io_thread_t *io_thread_) ZMQ_FINAL;
 
     //  i_poll_events interface implementation.
     void in_event () ZMQ_FINAL;
@@ -95,13 +101,17 @@ class stream_engine_base_t : public io_object_t, public i_engine
     virtual int read (void *data, size_t size_);
     virtual int write (const void *data_, size_t size_);
 
+    //  Whether the socket may be polled edge-triggered. Engines that
+    //  buffer data outside of the socket have to poll it level-triggered.
+    virtual bool edge_triggered_capable () const { return true; }
+
     void reset_pollout () { io_object_t::reset_pollout (_handle); }
     void set_pollout () { io_object_t::set_pollout (_handle); }
     void set_pollin () { io_object_t::set_pollin (_handle); }
     session_base_t *session () { return _session; }
     socket_base_t *socket () { return _socket; }
 
-    const options_t _options;
+    const options_t &_options;
 
     unsigned char *_inpos;
     size_t _insize;
@@ -113,6 +123,10 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     mechanism_t *_mechanism;
 
+    //  Pool of crypto worker threads to encode and decode messages with,
+    //  or NULL. When set, messages are encoded and decoded in batches.
+    crypto_pool_t *_crypto_pool;
+
     int (stream_engine_base_t::*_next_msg) (msg_t *msg_);
     int (stream_engine_base_t::*_process_msg) (msg_t *msg_);
 
@@ -148,6 +162,21 @@ class stream_engine_base_t : public io_object_t, public i_engine
     bool _has_timeout_timer;
     bool _has_heartbeat_timer;
 
+    //  The codecs' buffers go back to the pool of the I/O thread once
+    //  the connection has seen no traffic for buffer_idle_ivl.
+    enum
+    {
+        buffer_idle_timer_id = 0x83
+    };
+    bool _has_buffer_idle_timer;
+
+    //  True iff the codecs' buffers were used since the idle timer was
+    //  last started.
+    bool _buffers_used;
+
+    //  Pool of the I/O thread the engine runs in, NULL until plugged.
+    buffer_pool_t *_buffer_pool;
+
 
     const std::string _peer_address;
 
@@ -161,11 +190,50 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     void mechanism_ready ();
 
+    //  Notes that the codecs' buffers are in use, starting the idle timer
+    //  if it is not running.
+    void use_buffers ();
+
+    //  Gives the codecs' buffers back to the pool, unless holding data.
+    void release_buffers ();
+
+    int pull_and_encode_batch (msg_t *msg_);
+    void prepare_decoded_msg (msg_t *msg_);
+
+    //  Decodes the messages collected in the receive batch and pushes them
+    //  to the session.
+    int flush_rx_batch ();
+
+    //  Maximum number of messages encoded or decoded in one batch.
+    enum
+    {
+        max_batch_size = 64
+    };
+
+    //  Messages pulled from the session and encoded as a batch, if the
+    //  mechanism has parallel batches. Those from _tx_batch_pos on are yet
+    //  to be passed to the encoder.
+    msg_t *_tx_batch;
+    size_t _tx_batch_pos;
+    size_t _tx_batch_size;
+
+    //  Messages received from the peer and waiting to be decoded as a
+    //  batch. Those before _rx_batch_decoded are decoded, and those
+    //  before _rx_batch_pos have been pushed to the session already.
+    msg_t *_rx_batch;
+    size_t _rx_batch_pos;
+    size_t _rx_batch_decoded;
+    size_t _rx_batch_size;
+
     //  Underlying socket.
     fd_t _s;
 
     handle_t _handle;
 
+    //  True if the poller reports the socket only when it becomes ready,
+    //  in which case read and write tell it when the socket would block.
+    bool _edge_triggered;
+
     bool _plugged;
 
     //  When true, we are still trying to determine whether
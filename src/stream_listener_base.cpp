@@ -6,6 +6,7 @@
 #include "socket_base.hpp"
 #include "zmtp_engine.hpp"
 #include "raw_engine.hpp"
+#include "ip.hpp"
 
 #ifndef ZMQ_HAVE_WINDOWS
 #include <unistd.h>
@@ -21,7 +22,9 @@ zmq::stream_listener_base_t::stream_listener_base_t (
     io_object_t (io_thread_),
     _s (retired_fd),
     _handle (static_cast<handle_t> (NULL)),
-    _socket (socket_)
+    _socket (socket_),
+    _io_thread (io_thread_),
+    _local_sessions (false)
 {
 }
 
@@ -39,6 +42,9 @@ int zmq::stream_listener_base_t::get_local_address (std::string &addr_) const
 
 void zmq::stream_listener_base_t::process_plug ()
 {
+    //  The accept queue is drained on each wake-up, so accept must not block.
+    unblock_socket (_s);
+
     //  Start polling for incoming connections.
     _handle = add_fd (_s);
     set_pollin (_handle);
@@ -70,6 +76,24 @@ int zmq::stream_listener_base_t::close ()
     return 0;
 }
 
+bool zmq::stream_listener_base_t::accept_queue_empty ()
+{
+#ifdef ZMQ_HAVE_WINDOWS
+    return WSAGetLastError () == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+bool zmq::stream_listener_base_t::out_of_descriptors ()
+{
+#ifdef ZMQ_HAVE_WINDOWS
+    return WSAGetLastError () == WSAEMFILE;
+#else
+    return errno == EMFILE || errno == ENFILE;
+#endif
+}
+
 void zmq::stream_listener_base_t::create_engine (fd_t fd_)
 {
     const endpoint_uri_pair_t endpoint_pair (
@@ -85,7 +109,8 @@ void zmq::stream_listener_base_t::create_engine (fd_t fd_)
 
     //  Choose I/O thread to run connecter in. Given that we are already
     //  running in an I/O thread, there must be at least one available.
-    io_thread_t *io_thread = choose_io_thread (options.affinity);
+    io_thread_t *io_thread =
+      _local_sessions ? _io_thread : choose_io_thread (options.affinity);
     zmq_assert (io_thread);
 
     //  Create and launch a session object.
@@ -27,6 +27,9 @@ class stream_listener_base_t : public own_t, public io_object_t
     // Get the bound address for use with wildcards
     int get_local_address (std::string &addr_) const;
 
+    //  Close the listening socket.
+    virtual int close ();
+
   protected:
     virtual std::string get_socket_name (fd_t fd_,
                                          socket_end_t socket_end_) const = 0;
@@ -37,11 +40,16 @@ class stream_listener_base_t : public own_t, public io_object_t
     void process_term (int linger_) ZMQ_FINAL;
 
   protected:
-    //  Close the listening socket.
-    virtual int close ();
-
     virtual void create_engine (fd_t fd);
 
+    //  Returns true if the last failed accept only found the accept
+    //  queue empty.
+    static bool accept_queue_empty ();
+
+    //  Returns true if the last accept failed because the process or the
+    //  system ran out of file descriptors.
+    static bool out_of_descriptors ();
+
     //  Underlying socket.
     fd_t _s;
 
@@ -51,6 +59,13 @@ class stream_listener_base_t : public own_t, public io_object_t
     //  Socket the listener belongs to.
     zmq::socket_base_t *_socket;
 
+    //  I/O thread the listener runs in.
+    zmq::io_thread_t *const _io_thread;
+
+    //  If true, sessions for accepted connections run in the listener's
+    //  own I/O thread rather than in the least loaded one.
+    bool _local_sessions;
+
     // String representation of endpoint to bind to
     std::string _endpoint;
 
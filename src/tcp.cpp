@@ -216,9 +216,12 @@ int zmq::tcp_write (fd_t s_, const void *data_, size_t size_)
 
     //  Several errors are OK. When speculative write is being done we may not
     //  be able to write a single byte from the socket. Also, SIGSTOP issued
-    //  by a debugging tool can result in EINTR error.
+    //  by a debugging tool can result in EINTR error. A TCP Fast Open
+    //  connection that could not carry the data in its SYN reports
+    //  EINPROGRESS until it is established.
     if (nbytes == -1
-        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR
+            || errno == EINPROGRESS))
         return 0;
 
     //  Signalise peer failure.
@@ -329,6 +332,32 @@ void zmq::tune_tcp_busy_poll (fd_t socket_, int busy_poll_)
 #endif
 }
 
+void zmq::tune_tcp_fast_open (fd_t socket_, bool local_)
+{
+    //  Failures are ignored, as the kernel may have Fast Open disabled;
+    //  connections are then established the usual way.
+#if defined TCP_FASTOPEN
+    if (local_) {
+        const int queue_length = 16;
+        setsockopt (socket_, IPPROTO_TCP, TCP_FASTOPEN,
+                    reinterpret_cast<const char *> (&queue_length),
+                    sizeof (int));
+        return;
+    }
+#endif
+#if defined TCP_FASTOPEN_CONNECT
+    //  connect () completes at once, and the SYN carries the first data
+    //  written to the socket.
+    if (!local_) {
+        const int flag = 1;
+        setsockopt (socket_, IPPROTO_TCP, TCP_FASTOPEN_CONNECT,
+                    reinterpret_cast<const char *> (&flag), sizeof (int));
+    }
+#endif
+    LIBZMQ_UNUSED (socket_);
+    LIBZMQ_UNUSED (local_);
+}
+
 zmq::fd_t zmq::tcp_open_socket (const char *address_,
                                 const zmq::options_t &options_,
                                 bool local_,
@@ -389,6 +418,9 @@ zmq::fd_t zmq::tcp_open_socket (const char *address_,
     //  This option removes several delays caused by scheduling, interrupts and context switching.
     if (options_.busy_poll)
         tune_tcp_busy_poll (s, options_.busy_poll);
+
+    if (options_.optimistic_handshake)
+        tune_tcp_fast_open (s, local_);
     return s;
 
 setsockopt_error:
@@ -43,6 +43,10 @@ void tcp_tune_loopback_fast_path (fd_t socket_);
 
 void tune_tcp_busy_poll (fd_t socket_, int busy_poll_);
 
+//  Enables TCP Fast Open on a listening (local_) or connecting socket,
+//  if supported by the system.
+void tune_tcp_fast_open (fd_t socket_, bool local_);
+
 //  Resolves the given address_ string, opens a socket and sets socket options
 //  according to the passed options_. On success, returns the socket
 //  descriptor and assigns the resolved address to out_tcp_addr_. In case of
@@ -32,6 +32,10 @@
 #include <ioctl.h>
 #endif
 
+#if defined ZMQ_HAVE_SO_REUSEPORT && defined SO_ATTACH_REUSEPORT_CBPF
+#include <linux/filter.h>
+#endif
+
 zmq::tcp_listener_t::tcp_listener_t (io_thread_t *io_thread_,
                                      socket_base_t *socket_,
                                      const options_t &options_) :
@@ -41,30 +45,45 @@ zmq::tcp_listener_t::tcp_listener_t (io_thread_t *io_thread_,
 
 void zmq::tcp_listener_t::in_event ()
 {
-    const fd_t fd = accept ();
-
-    //  If connection was reset by the peer in the meantime, just ignore it.
-    //  TODO: Handle specific errors like ENFILE/EMFILE etc.
-    if (fd == retired_fd) {
-        _socket->event_accept_failed (
-          make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
-        return;
-    }
+    //  Drain the accept queue, up to the configured budget per wake-up.
+    for (int i = 0; i != options.accept_batch_size; i++) {
+        bool rejected;
+        const fd_t fd = accept (&rejected);
 
-    int rc = tune_tcp_socket (fd);
-    rc = rc
-         | tune_tcp_keepalives (
-           fd, options.tcp_keepalive, options.tcp_keepalive_cnt,
-           options.tcp_keepalive_idle, options.tcp_keepalive_intvl);
-    rc = rc | tune_tcp_maxrt (fd, options.tcp_maxrt);
-    if (rc != 0) {
-        _socket->event_accept_failed (
-          make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
-        return;
-    }
+        //  A connection turned down by the accept filters is closed already;
+        //  the next one may well be accepted. An empty accept queue ends the
+        //  batch. Any other failure is reported; running out of file
+        //  descriptors ends the batch too, as the next accept would fail
+        //  the same way, while other failures, such as the connection being
+        //  reset by the peer in the meantime, only lose that connection.
+        if (fd == retired_fd) {
+            if (rejected)
+                continue;
+            if (accept_queue_empty ())
+                return;
+            const bool exhausted = out_of_descriptors ();
+            _socket->event_accept_failed (
+              make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
+            if (exhausted)
+                return;
+            continue;
+        }
 
-    //  Create the engine object for this connection.
-    create_engine (fd);
+        int rc = tune_tcp_socket (fd);
+        rc = rc
+             | tune_tcp_keepalives (
+               fd, options.tcp_keepalive, options.tcp_keepalive_cnt,
+               options.tcp_keepalive_idle, options.tcp_keepalive_intvl);
+        rc = rc | tune_tcp_maxrt (fd, options.tcp_maxrt);
+        if (rc != 0) {
+            _socket->event_accept_failed (
+              make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
+            continue;
+        }
+
+        //  Create the engine object for this connection.
+        create_engine (fd);
+    }
 }
 
 std::string
@@ -105,6 +124,16 @@ int zmq::tcp_listener_t::create_socket (const char *addr_)
     errno_assert (rc == 0);
 #endif
 
+#ifdef ZMQ_HAVE_SO_REUSEPORT
+    //  Sharded listeners share the port, each accepting connections in
+    //  its own I/O thread, so sessions are kept in that thread too.
+    if (options.tcp_listen_shards != 0) {
+        rc = setsockopt (_s, SOL_SOCKET, SO_REUSEPORT, &flag, sizeof (int));
+        errno_assert (rc == 0);
+        _local_sessions = true;
+    }
+#endif
+
     //  Bind the socket to the network interface and port.
 #if defined ZMQ_HAVE_VXWORKS
     rc = bind (_s, (sockaddr *) _address.addr (), _address.addrlen ());
@@ -160,12 +189,38 @@ int zmq::tcp_listener_t::set_local_address (const char *addr_)
     return 0;
 }
 
-zmq::fd_t zmq::tcp_listener_t::accept ()
+#ifdef ZMQ_HAVE_SO_REUSEPORT
+void zmq::tcp_listener_t::attach_cpu_steering (int shards_)
+{
+    zmq_assert (shards_ > 0);
+
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    //  Listeners join the SO_REUSEPORT group in bind order, so the index
+    //  returned here is the shard, i.e. the n-th I/O thread.
+    struct sock_filter code[] = {
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0,
+       static_cast<uint32_t> (SKF_AD_OFF + SKF_AD_CPU)},
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t> (shards_)},
+      {BPF_RET | BPF_A, 0, 0, 0}};
+    struct sock_fprog prog;
+    prog.len = sizeof (code) / sizeof (code[0]);
+    prog.filter = code;
+
+    //  Failure, e.g. on kernels predating SO_ATTACH_REUSEPORT_CBPF, leaves
+    //  the default hashing in place.
+    setsockopt (_s, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog,
+                sizeof (prog));
+#endif
+}
+#endif
+
+zmq::fd_t zmq::tcp_listener_t::accept (bool *rejected_)
 {
     //  The situation where connection cannot be accepted due to insufficient
     //  resources is considered valid and treated by ignoring the connection.
     //  Accept one connection and deal with different failure modes.
     zmq_assert (_s != retired_fd);
+    *rejected_ = false;
 
     struct sockaddr_storage ss;
     memset (&ss, 0, sizeof (ss));
@@ -176,7 +231,7 @@ zmq::fd_t zmq::tcp_listener_t::accept ()
 #endif
 #if defined ZMQ_HAVE_SOCK_CLOEXEC && defined HAVE_ACCEPT4
     fd_t sock = ::accept4 (_s, reinterpret_cast<struct sockaddr *> (&ss),
-                           &ss_len, SOCK_CLOEXEC);
+                           &ss_len, SOCK_CLOEXEC | SOCK_NONBLOCK);
 #else
     const fd_t sock =
       ::accept (_s, reinterpret_cast<struct sockaddr *> (&ss), &ss_len);
@@ -223,6 +278,7 @@ zmq::fd_t zmq::tcp_listener_t::accept ()
             int rc = ::close (sock);
             errno_assert (rc == 0);
 #endif
+            *rejected_ = true;
             return retired_fd;
         }
     }
@@ -235,6 +291,7 @@ zmq::fd_t zmq::tcp_listener_t::accept ()
         int rc = ::close (sock);
         errno_assert (rc == 0);
 #endif
+        *rejected_ = true;
         return retired_fd;
     }
 
@@ -19,6 +19,14 @@ class tcp_listener_t ZMQ_FINAL : public stream_listener_base_t
     //  Set address to listen on.
     int set_local_address (const char *addr_);
 
+#ifdef ZMQ_HAVE_SO_REUSEPORT
+    //  Attach a steering program to the SO_REUSEPORT group of this
+    //  listener, mapping the receiving CPU onto one of shards_ listeners.
+    //  Where the program cannot be attached, the kernel goes on hashing
+    //  connections across the listeners.
+    void attach_cpu_steering (int shards_);
+#endif
+
   protected:
     std::string get_socket_name (fd_t fd_, socket_end_t socket_end_) const;
 
@@ -28,9 +36,11 @@ class tcp_listener_t ZMQ_FINAL : public stream_listener_base_t
 
     //  Accept the new connection. Returns the file descriptor of the
     //  newly created connection. The function may return retired_fd
-    //  if the connection was dropped while waiting in the listen backlog
-    //  or was denied because of accept filters.
-    fd_t accept ();
+    //  if the connection was dropped while waiting in the listen backlog,
+    //  or if the accept queue is empty. It also returns retired_fd, with
+    //  rejected_ set, if the connection was denied because of accept
+    //  filters or closed because it could not be set up.
+    fd_t accept (bool *rejected_);
 
     int create_socket (const char *addr_);
 
@@ -2,8 +2,11 @@
 
 #include "precompiled.hpp"
 
+#include <stdlib.h>
+
 #if !defined ZMQ_HAVE_WINDOWS
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -28,6 +31,33 @@
 #include <TargetConditionals.h>
 #endif
 
+#if defined HAVE_RECVMMSG
+static const int in_batch_size = MAX_UDP_BATCH;
+#else
+static const int in_batch_size = 1;
+#endif
+
+//  A receive slot starts with the content structure of the message that
+//  may take it over, followed by the datagram.
+static const size_t in_slot_data_offset = sizeof (zmq::msg_t::content_t);
+
+//  Message bodies smaller than this are copied out of their slot, so that
+//  small datagrams queued in the pipe do not each hold a whole slot.
+static const size_t in_slot_copy_threshold = MAX_UDP_MSG / 2;
+
+static unsigned char *alloc_in_slot ()
+{
+    unsigned char *const slot = static_cast<unsigned char *> (
+      malloc (in_slot_data_offset + MAX_UDP_MSG));
+    alloc_assert (slot);
+    return slot;
+}
+
+static void free_in_slot (void * /*data_*/, void *hint_)
+{
+    free (hint_);
+}
+
 zmq::udp_engine_t::udp_engine_t (const options_t &options_) :
     _plugged (false),
     _fd (-1),
@@ -35,15 +65,30 @@ zmq::udp_engine_t::udp_engine_t (const options_t &options_) :
     _handle (static_cast<handle_t> (NULL)),
     _address (NULL),
     _options (options_),
+    _out_pos (0),
+    _out_count (0),
+    _in_pos (0),
+    _in_count (0),
     _send_enabled (false),
     _recv_enabled (false)
 {
+    for (int i = 0; i != MAX_UDP_BATCH; i++) {
+        const int rc = _out_bodies[i].init ();
+        errno_assert (rc == 0);
+        _in_slots[i] = NULL;
+    }
 }
 
 zmq::udp_engine_t::~udp_engine_t ()
 {
     zmq_assert (!_plugged);
 
+    for (int i = 0; i != MAX_UDP_BATCH; i++) {
+        const int rc = _out_bodies[i].close ();
+        errno_assert (rc == 0);
+        free (_in_slots[i]);
+    }
+
     if (_fd != retired_fd) {
 #ifdef ZMQ_HAVE_WINDOWS
         const int rc = closesocket (_fd);
@@ -407,90 +452,165 @@ int zmq::udp_engine_t::resolve_raw_address (const char *name_, size_t length_)
     return 0;
 }
 
-void zmq::udp_engine_t::out_event ()
+int zmq::udp_engine_t::pull_datagram (int index_)
 {
     msg_t group_msg;
     int rc = _session->pull_msg (&group_msg);
     errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
+    if (rc != 0)
+        return -1;
 
-    if (rc == 0) {
-        msg_t body_msg;
-        rc = _session->pull_msg (&body_msg);
-        //  If there's a group, there should also be a body
-        errno_assert (rc == 0);
+    msg_t &body_msg = _out_bodies[index_];
+    rc = _session->pull_msg (&body_msg);
+    //  If there's a group, there should also be a body
+    errno_assert (rc == 0);
 
-        const size_t group_size = group_msg.size ();
-        const size_t body_size = body_msg.size ();
-        size_t size;
+    const size_t group_size = group_msg.size ();
+    const size_t body_size = body_msg.size ();
 
-        if (_options.raw_socket) {
-            rc = resolve_raw_address (static_cast<char *> (group_msg.data ()),
-                                      group_size);
+    if (_options.raw_socket) {
+        rc = resolve_raw_address (static_cast<char *> (group_msg.data ()),
+                                  group_size);
+        _out_raw_addresses[index_] = _raw_address;
+        _out_header_sizes[index_] = 0;
+
+        //  Larger datagrams would be truncated by the receiver.
+        if (rc == 0 && body_size > MAX_UDP_MSG)
+            rc = -1;
+    } else if (group_size > UCHAR_MAX
+               || group_size + body_size + 1 > MAX_UDP_MSG)
+        rc = -1;
+    else {
+        _out_headers[index_][0] = static_cast<unsigned char> (group_size);
+        memcpy (_out_headers[index_] + 1, group_msg.data (), group_size);
+        _out_header_sizes[index_] = 1 + group_size;
+    }
 
-            //  We discard the message if address is not valid
-            if (rc != 0) {
-                rc = group_msg.close ();
-                errno_assert (rc == 0);
+    const int close_rc = group_msg.close ();
+    errno_assert (close_rc == 0);
 
-                rc = body_msg.close ();
-                errno_assert (rc == 0);
+    //  We discard the message if address is not valid or it is too large
+    if (rc != 0) {
+        rc = body_msg.close ();
+        errno_assert (rc == 0);
+        rc = body_msg.init ();
+        errno_assert (rc == 0);
+        errno = EINVAL;
+        return -1;
+    }
 
-                return;
-            }
+    return 0;
+}
 
-            size = body_size;
+#if defined HAVE_SENDMMSG
+void zmq::udp_engine_t::out_event ()
+{
+    //  Start a new batch once the previous one has been sent entirely.
+    if (_out_pos == _out_count) {
+        _out_pos = 0;
+        _out_count = 0;
+        while (_out_count < MAX_UDP_BATCH) {
+            if (pull_datagram (_out_count) == 0)
+                _out_count++;
+            else if (errno == EAGAIN)
+                break;
+        }
+        if (_out_count == 0) {
+            reset_pollout (_handle);
+            return;
+        }
+    }
 
-            memcpy (_out_buffer, body_msg.data (), body_size);
+    //  The datagrams are gathered from their headers and the message
+    //  bodies, without copying them into a send buffer.
+    mmsghdr datagrams[MAX_UDP_BATCH];
+    iovec parts[MAX_UDP_BATCH][2];
+    const int count = _out_count - _out_pos;
+    for (int i = 0; i != count; i++) {
+        const int index = _out_pos + i;
+        parts[i][0].iov_base = _out_headers[index];
+        parts[i][0].iov_len = _out_header_sizes[index];
+        parts[i][1].iov_base = _out_bodies[index].data ();
+        parts[i][1].iov_len = _out_bodies[index].size ();
+
+        memset (&datagrams[i], 0, sizeof datagrams[i]);
+        msghdr &header = datagrams[i].msg_hdr;
+        if (_options.raw_socket) {
+            header.msg_name = &_out_raw_addresses[index];
+            header.msg_namelen = sizeof (sockaddr_in);
         } else {
-            size = group_size + body_size + 1;
-
-            if (size > MAX_UDP_MSG) {
-                rc = group_msg.close ();
-                errno_assert (rc == 0);
-
-                rc = body_msg.close ();
-                errno_assert (rc == 0);
-
-                return;
-            }
+            header.msg_name = const_cast<sockaddr *> (_out_address);
+            header.msg_namelen = _out_address_len;
+        }
+        header.msg_iov = parts[i];
+        header.msg_iovlen = 2;
+    }
 
-            _out_buffer[0] = static_cast<unsigned char> (group_size);
-            memcpy (_out_buffer + 1, group_msg.data (), group_size);
-            memcpy (_out_buffer + 1 + group_size, body_msg.data (), body_size);
+    const int rc = sendmmsg (_fd, datagrams, count, 0);
+    if (rc < 0) {
+        //  What was not sent is sent once the socket is writable again.
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
         }
+        return;
+    }
 
-        rc = group_msg.close ();
-        errno_assert (rc == 0);
+    for (int i = 0; i != rc; i++) {
+        count_bytes_written (datagrams[i].msg_len);
+        int close_rc = _out_bodies[_out_pos + i].close ();
+        errno_assert (close_rc == 0);
+        close_rc = _out_bodies[_out_pos + i].init ();
+        errno_assert (close_rc == 0);
+    }
+    _out_pos += rc;
+}
+#else
+void zmq::udp_engine_t::out_event ()
+{
+    if (pull_datagram (0) != 0) {
+        if (errno == EAGAIN)
+            reset_pollout (_handle);
+        return;
+    }
 
-        body_msg.close ();
-        errno_assert (rc == 0);
+    msg_t &body_msg = _out_bodies[0];
+    const size_t header_size = _out_header_sizes[0];
+    const size_t size = header_size + body_msg.size ();
+    memcpy (_out_buffer, _out_headers[0], header_size);
+    memcpy (_out_buffer + header_size, body_msg.data (), body_msg.size ());
+
+    int rc = body_msg.close ();
+    errno_assert (rc == 0);
+    rc = body_msg.init ();
+    errno_assert (rc == 0);
 
 #ifdef ZMQ_HAVE_WINDOWS
-        rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0, _out_address,
-                     _out_address_len);
+    rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0, _out_address,
+                 _out_address_len);
 #elif defined ZMQ_HAVE_VXWORKS
-        rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size, 0,
-                     (sockaddr *) _out_address, _out_address_len);
+    rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size, 0,
+                 (sockaddr *) _out_address, _out_address_len);
 #else
-        rc = sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
+    rc = sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
 #endif
-        if (rc < 0) {
+    if (rc < 0) {
 #ifdef ZMQ_HAVE_WINDOWS
-            if (WSAGetLastError () != WSAEWOULDBLOCK) {
-                assert_success_or_recoverable (_fd, rc);
-                error (connection_error);
-            }
+        if (WSAGetLastError () != WSAEWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
+        }
 #else
-            if (rc != EWOULDBLOCK) {
-                assert_success_or_recoverable (_fd, rc);
-                error (connection_error);
-            }
-#endif
+        if (errno != EWOULDBLOCK && errno != EAGAIN) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
         }
-    } else {
-        reset_pollout (_handle);
+#endif
+        return;
     }
+    count_bytes_written (size);
 }
+#endif
 
 const zmq::endpoint_uri_pair_t &zmq::udp_engine_t::get_endpoint () const
 {
@@ -512,93 +632,167 @@ void zmq::udp_engine_t::restart_output ()
 
 void zmq::udp_engine_t::in_event ()
 {
-    sockaddr_storage in_address;
+    //  Datagrams left over from the last batch go first.
+    if (!push_in_batch ())
+        return;
+
+    //  Replace the slots taken over by messages since the last time.
+    for (int i = 0; i != in_batch_size; i++) {
+        if (_in_slots[i] == NULL)
+            _in_slots[i] = alloc_in_slot ();
+    }
+
+#if defined HAVE_RECVMMSG
+    mmsghdr datagrams[in_batch_size];
+    iovec parts[in_batch_size];
+    for (int i = 0; i != in_batch_size; i++) {
+        parts[i].iov_base = _in_slots[i] + in_slot_data_offset;
+        parts[i].iov_len = MAX_UDP_MSG;
+
+        memset (&datagrams[i], 0, sizeof datagrams[i]);
+        datagrams[i].msg_hdr.msg_name = &_in_addresses[i];
+        datagrams[i].msg_hdr.msg_namelen = sizeof _in_addresses[i];
+        datagrams[i].msg_hdr.msg_iov = &parts[i];
+        datagrams[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int count = recvmmsg (_fd, datagrams, in_batch_size, 0, NULL);
+    for (int i = 0; i < count; i++)
+        _in_sizes[i] = datagrams[i].msg_len;
+#else
     zmq_socklen_t in_addrlen =
       static_cast<zmq_socklen_t> (sizeof (sockaddr_storage));
 
-    const int nbytes =
-      recvfrom (_fd, _in_buffer, MAX_UDP_MSG, 0,
-                reinterpret_cast<sockaddr *> (&in_address), &in_addrlen);
+    const int nbytes = recvfrom (
+      _fd, reinterpret_cast<char *> (_in_slots[0] + in_slot_data_offset),
+      MAX_UDP_MSG, 0, reinterpret_cast<sockaddr *> (&_in_addresses[0]),
+      &in_addrlen);
+    const int count = nbytes < 0 ? nbytes : 1;
+    if (count == 1)
+        _in_sizes[0] = static_cast<size_t> (nbytes);
+#endif
 
-    if (nbytes < 0) {
+    if (count < 0) {
 #ifdef ZMQ_HAVE_WINDOWS
         if (WSAGetLastError () != WSAEWOULDBLOCK) {
-            assert_success_or_recoverable (_fd, nbytes);
+            assert_success_or_recoverable (_fd, count);
             error (connection_error);
         }
 #else
-        if (nbytes != EWOULDBLOCK) {
-            assert_success_or_recoverable (_fd, nbytes);
+        if (errno != EWOULDBLOCK && errno != EAGAIN) {
+            assert_success_or_recoverable (_fd, count);
             error (connection_error);
         }
 #endif
         return;
     }
 
+    for (int i = 0; i != count; i++)
+        count_bytes_read (_in_sizes[i]);
+
+    _in_pos = 0;
+    _in_count = count;
+    push_in_batch ();
+}
+
+bool zmq::udp_engine_t::push_in_batch ()
+{
+    //  Datagrams the session cannot take are kept until restart_input,
+    //  rather than dropped, so that those received in one batch are not
+    //  lost when the pipe fills up half way through it.
+    bool pushed = true;
+    for (; _in_pos != _in_count; _in_pos++) {
+        if (!push_datagram (_in_pos)) {
+            reset_pollin (_handle);
+            pushed = false;
+            break;
+        }
+    }
+    _session->flush ();
+    return pushed;
+}
+
+bool zmq::udp_engine_t::push_datagram (int slot_)
+{
+    unsigned char *const slot = _in_slots[slot_];
+    unsigned char *const data = slot + in_slot_data_offset;
+    const size_t size = _in_sizes[slot_];
+    const sockaddr_storage *const address = &_in_addresses[slot_];
+
     int rc;
-    int body_size;
-    int body_offset;
+    size_t body_size;
+    size_t body_offset;
     msg_t msg;
 
     if (_options.raw_socket) {
-        zmq_assert (in_address.ss_family == AF_INET);
-        sockaddr_to_msg (&msg, reinterpret_cast<sockaddr_in *> (&in_address));
+        zmq_assert (address->ss_family == AF_INET);
+        sockaddr_to_msg (&msg,
+                         reinterpret_cast<const sockaddr_in *> (address));
 
-        body_size = nbytes;
+        body_size = size;
         body_offset = 0;
     } else {
-        const char *group_buffer = _in_buffer + 1;
-        const int group_size = static_cast<unsigned char> (_in_buffer[0]);
+        //  This doesn't fit, just ignore
+        if (size == 0 || size - 1 < data[0])
+            return true;
 
+        const size_t group_size = data[0];
         rc = msg.init_size (group_size);
         errno_assert (rc == 0);
         msg.set_flags (msg_t::more);
-        memcpy (msg.data (), group_buffer, group_size);
-
-        //  This doesn't fit, just ignore
-        if (nbytes - 1 < group_size) {
-            rc = msg.close ();
-            errno_assert (rc == 0);
-            return;
-        }
+        memcpy (msg.data (), data + 1, group_size);
 
-        body_size = nbytes - 1 - group_size;
+        body_size = size - 1 - group_size;
         body_offset = 1 + group_size;
     }
     // Push group description to session
     rc = _session->push_msg (&msg);
     errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
 
-    //  Group description message doesn't fit in the pipe, drop
+    //  Group description message doesn't fit in the pipe, keep the
+    //  datagram until there is room
     if (rc != 0) {
         rc = msg.close ();
         errno_assert (rc == 0);
-
-        reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
-    rc = msg.init_size (body_size);
-    errno_assert (rc == 0);
-    memcpy (msg.data (), _in_buffer + body_offset, body_size);
+
+    //  Unless it is small enough to be copied, the body is built on top
+    //  of the slot, which the message takes over.
+    if (body_size < in_slot_copy_threshold) {
+        rc = msg.init_size (body_size);
+        errno_assert (rc == 0);
+        memcpy (msg.data (), data + body_offset, body_size);
+    } else {
+        rc = msg.init (data + body_offset, body_size, free_in_slot, slot,
+                       reinterpret_cast<msg_t::content_t *> (slot));
+        errno_assert (rc == 0);
+        _in_slots[slot_] = NULL;
+    }
 
     // Push message body to session
     rc = _session->push_msg (&msg);
-    // Message body doesn't fit in the pipe, drop and reset session state
+    //  Message body doesn't fit in the pipe, drop it and reset session
+    //  state, keeping the datagram until there is room. If the slot goes
+    //  with the body, the datagram is moved to a new one first.
     if (rc != 0) {
+        if (_in_slots[slot_] == NULL) {
+            _in_slots[slot_] = alloc_in_slot ();
+            memcpy (_in_slots[slot_] + in_slot_data_offset, data, size);
+        }
         rc = msg.close ();
         errno_assert (rc == 0);
 
         _session->reset ();
-        reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
-    _session->flush ();
+    return true;
 }
 
 bool zmq::udp_engine_t::restart_input ()
@@ -2,6 +2,8 @@
 #ifndef __ZMQ_UDP_ENGINE_HPP_INCLUDED__
 #define __ZMQ_UDP_ENGINE_HPP_INCLUDED__
 
+#include <limits.h>
+
 #include "io_object.hpp"
 #include "i_engine.hpp"
 #include "address.hpp"
@@ -9,6 +11,9 @@
 
 #define MAX_UDP_MSG 8192
 
+//  Maximal number of datagrams sent or received by a single system call.
+#define MAX_UDP_BATCH 32
+
 namespace zmq
 {
 class io_thread_t;
@@ -51,6 +56,20 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     int resolve_raw_address (const char *name_, size_t length_);
     static void sockaddr_to_msg (zmq::msg_t *msg_, const sockaddr_in *addr_);
 
+    //  Pulls the next message from the session into the index_-th entry
+    //  of the send batch. Returns -1 with errno set to EAGAIN if there is
+    //  no message, or to EINVAL if the message had to be discarded.
+    int pull_datagram (int index_);
+
+    //  Pushes the datagram received into the slot_-th receive slot to the
+    //  session. Returns false, leaving the datagram in its slot, if the
+    //  session cannot take it yet.
+    bool push_datagram (int slot_);
+
+    //  Pushes the datagrams of the receive batch not pushed yet to the
+    //  session. Returns false if the session cannot take them all.
+    bool push_in_batch ();
+
     static int set_udp_reuse_address (fd_t s_, bool on_);
     static int set_udp_reuse_port (fd_t s_, bool on_);
     // Indicate, if the multicast data being sent should be looped back
@@ -82,8 +101,31 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     const struct sockaddr *_out_address;
     zmq_socklen_t _out_address_len;
 
+    //  Datagrams of the send batch, each made of a header holding the
+    //  group, if any, followed by the message body. The entries in
+    //  [_out_pos, _out_count) are still to be sent.
+    unsigned char _out_headers[MAX_UDP_BATCH][1 + UCHAR_MAX];
+    size_t _out_header_sizes[MAX_UDP_BATCH];
+    msg_t _out_bodies[MAX_UDP_BATCH];
+    sockaddr_in _out_raw_addresses[MAX_UDP_BATCH];
+    int _out_pos;
+    int _out_count;
+
+#if !defined HAVE_SENDMMSG
     char _out_buffer[MAX_UDP_MSG];
-    char _in_buffer[MAX_UDP_MSG];
+#endif
+
+    //  Buffers the datagrams are received into. Each one is handed over to
+    //  the message built on top of it, unless the message is small enough
+    //  to be copied, and a new one is allocated on the next receive.
+    //  The datagrams in [_in_pos, _in_count) are still to be pushed to the
+    //  session, which was full when they were received.
+    unsigned char *_in_slots[MAX_UDP_BATCH];
+    size_t _in_sizes[MAX_UDP_BATCH];
+    sockaddr_storage _in_addresses[MAX_UDP_BATCH];
+    int _in_pos;
+    int _in_count;
+
     bool _send_enabled;
     bool _recv_enabled;
 };
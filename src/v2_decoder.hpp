@@ -9,8 +9,8 @@
 namespace zmq
 {
 //  Decoder for ZMTP/2.x framing protocol. Converts data stream into messages.
-//  The class has to inherit from shared_message_memory_allocator because
-//  the base class calls allocate in its constructor.
+//  The messages decoded share the allocator's buffer, so that the data is
+//  not copied.
 class v2_decoder_t ZMQ_FINAL
     : public decoder_base_t<v2_decoder_t, shared_message_memory_allocator>
 {
@@ -30,6 +30,9 @@ class wss_engine_t : public ws_engine_t
     int read (void *data, size_t size_);
     int write (const void *data_, size_t size_);
 
+    //  GnuTLS buffers decrypted records the poller cannot see.
+    bool edge_triggered_capable () const { return false; }
+
   private:
     bool do_handshake ();
 
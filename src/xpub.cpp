@@ -22,7 +22,8 @@ zmq::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     _manual (false),
     _send_last_pipe (false),
     _pending_pipes (),
-    _welcome_msg ()
+    _welcome_msg (),
+    _lvc_topic_size (0)
 {
     _last_pipe = NULL;
     options.type = ZMQ_XPUB;
@@ -32,6 +33,7 @@ zmq::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
 zmq::xpub_t::~xpub_t ()
 {
     _welcome_msg.close ();
+    clear_last_values ();
     for (std::deque<metadata_t *>::iterator it = _pending_metadata.begin (),
                                             end = _pending_metadata.end ();
          it != end; ++it)
@@ -64,6 +66,9 @@ void zmq::xpub_t::xattach_pipe (pipe_t *pipe_,
         pipe_->flush ();
     }
 
+    if (subscribe_to_all_)
+        send_last_values (pipe_, NULL, 0);
+
     //  The pipe is active when attached. Let's read the subscriptions from
     //  it, if any.
     xread_activated (pipe_);
@@ -124,6 +129,7 @@ void zmq::xpub_t::xread_activated (pipe_t *pipe_)
                     const bool first_added =
                       _subscriptions.add (data, size, pipe_);
                     notify = first_added || _verbose_subs;
+                    send_last_values (pipe_, data, size);
                 }
             }
 
@@ -201,6 +207,18 @@ int zmq::xpub_t::xsetsockopt (int option_,
             _manual = (*static_cast<const int *> (optval_) != 0);
         else if (option_ == ZMQ_ONLY_FIRST_SUBSCRIBE)
             _only_first_subscribe = (*static_cast<const int *> (optval_) != 0);
+    } else if (option_ == ZMQ_XPUB_LAST_VALUE_CACHE) {
+        if (optvallen_ != sizeof (int)
+            || *static_cast<const int *> (optval_)
+                 < ZMQ_XPUB_LAST_VALUE_CACHE_FRAME) {
+            errno = EINVAL;
+            return -1;
+        }
+        //  The topics cached so far may not be topics any more.
+        if (*static_cast<const int *> (optval_) != _lvc_topic_size) {
+            clear_last_values ();
+            _lvc_topic_size = *static_cast<const int *> (optval_);
+        }
     } else if (option_ == ZMQ_SUBSCRIBE && _manual) {
         if (_last_pipe != NULL)
             _subscriptions.add ((unsigned char *) optval_, optvallen_,
@@ -237,6 +255,9 @@ int zmq::xpub_t::xgetsockopt (int option_, void *optval_, size_t *optvallen_)
                                    (int) _subscriptions.num_prefixes ());
     }
 
+    if (option_ == ZMQ_XPUB_LAST_VALUE_CACHE)
+        return do_getsockopt<int> (optval_, optvallen_, _lvc_topic_size);
+
     // room for future options here
 
     errno = EINVAL;
@@ -273,6 +294,12 @@ void zmq::xpub_t::xpipe_terminated (pipe_t *pipe_)
         _subscriptions.rm (pipe_, send_unsubscription, this, !_verbose_unsubs);
     }
 
+    for (std::deque<pipe_t *>::iterator it = _lvc_pending_pipes.begin (),
+                                        end = _lvc_pending_pipes.end ();
+         it != end; ++it)
+        if (*it == pipe_)
+            *it = NULL;
+
     _dist.pipe_terminated (pipe_);
 }
 
@@ -310,15 +337,37 @@ int zmq::xpub_t::xsend (msg_t *msg_)
         }
     }
 
+    //  Unless the cache was enabled in the middle of the message, keep a
+    //  copy of each frame for the last value cache.
+    const bool cache =
+      _lvc_topic_size != 0 && (!_more_send || !_lvc_parts.empty ());
+
     int rc = -1; //  Assume we fail
     if (_lossy || _dist.check_hwm ()) {
+        msg_t copy;
+        if (cache) {
+            int copy_rc = copy.init ();
+            errno_assert (copy_rc == 0);
+            copy_rc = copy.copy (*msg_);
+            errno_assert (copy_rc == 0);
+        }
         if (_dist.send_to_matching (msg_) == 0) {
+            if (cache) {
+                _lvc_parts.push_back (copy);
+                if (!msg_more)
+                    store_last_value ();
+            }
             //  If we are at the end of multi-part message we can mark
             //  all the pipes as non-matching.
             if (!msg_more)
                 _dist.unmatch ();
             _more_send = msg_more;
+            if (!msg_more && !_lvc_pending_pipes.empty ())
+                send_pending_last_values ();
             rc = 0; //  Yay, sent successfully
+        } else if (cache) {
+            const int close_rc = copy.close ();
+            errno_assert (close_rc == 0);
         }
     } else
         errno = EAGAIN;
@@ -397,3 +446,131 @@ void zmq::xpub_t::send_unsubscription (zmq::mtrie_t::prefix_t data_,
         }
     }
 }
+
+static void close_parts (std::vector<zmq::msg_t> &parts_)
+{
+    for (size_t i = 0; i < parts_.size (); i++) {
+        const int rc = parts_[i].close ();
+        errno_assert (rc == 0);
+    }
+    parts_.clear ();
+}
+
+//  Writes a copy of the message to the pipe if its first frame starts with
+//  the prefix. Returns false if the pipe cannot take any more messages.
+static bool write_last_value (zmq::pipe_t *pipe_,
+                              std::vector<zmq::msg_t> &parts_,
+                              const unsigned char *prefix_,
+                              size_t size_)
+{
+    zmq::msg_t &first = parts_.front ();
+    if (first.size () < size_
+        || (size_ > 0 && memcmp (first.data (), prefix_, size_) != 0))
+        return true;
+
+    //  Stop short of the HWM rather than let the pipe deactivate itself,
+    //  which the distributor would not know about.
+    if (!pipe_->check_hwm ())
+        return false;
+
+    for (size_t i = 0; i < parts_.size (); i++) {
+        zmq::msg_t copy;
+        int rc = copy.init ();
+        errno_assert (rc == 0);
+        rc = copy.copy (parts_[i]);
+        errno_assert (rc == 0);
+        if (!pipe_->write (&copy)) {
+            //  Only an inactive pipe refuses a message, and refuses it all.
+            zmq_assert (i == 0);
+            rc = copy.close ();
+            errno_assert (rc == 0);
+            return false;
+        }
+    }
+    return true;
+}
+
+void zmq::xpub_t::send_last_values (pipe_t *pipe_,
+                                    unsigned char *prefix_,
+                                    size_t size_)
+{
+    //  A subscription means no such messages with inverted matching, and
+    //  the user applies the subscriptions in manual mode.
+    if (_lvc_topic_size == 0 || _manual || options.invert_matching)
+        return;
+
+    //  The pipe may be matching the message being sent.
+    if (_more_send) {
+        _lvc_pending_pipes.push_back (pipe_);
+        _lvc_pending_prefixes.ZMQ_PUSH_OR_EMPLACE_BACK (
+          blob_t (prefix_, size_));
+        return;
+    }
+
+    //  The topics no longer than the topic size that start the prefix are
+    //  looked up one by one, and then those starting with the prefix, which
+    //  follow each other in the cache.
+    bool ok = true;
+    for (size_t i = 0; ok && i < size_
+                       && (_lvc_topic_size < 0
+                           || i <= static_cast<size_t> (_lvc_topic_size));
+         i++) {
+        const last_values_t::iterator it =
+          _last_values.find (blob_t (prefix_, i, reference_tag_t ()));
+        if (it != _last_values.end ())
+            ok = write_last_value (pipe_, it->second, prefix_, size_);
+    }
+    for (last_values_t::iterator
+           it = _last_values.lower_bound (
+             blob_t (prefix_, size_, reference_tag_t ())),
+           end = _last_values.end ();
+         ok && it != end && it->first.size () >= size_
+         && (size_ == 0 || memcmp (it->first.data (), prefix_, size_) == 0);
+         ++it)
+        ok = write_last_value (pipe_, it->second, prefix_, size_);
+
+    pipe_->flush ();
+}
+
+void zmq::xpub_t::send_pending_last_values ()
+{
+    while (!_lvc_pending_pipes.empty ()) {
+        if (_lvc_pending_pipes.front ())
+            send_last_values (_lvc_pending_pipes.front (),
+                              _lvc_pending_prefixes.front ().data (),
+                              _lvc_pending_prefixes.front ().size ());
+        _lvc_pending_pipes.pop_front ();
+        _lvc_pending_prefixes.pop_front ();
+    }
+}
+
+void zmq::xpub_t::store_last_value ()
+{
+    msg_t &first = _lvc_parts.front ();
+    size_t size = first.size ();
+    if (_lvc_topic_size > 0 && size > static_cast<size_t> (_lvc_topic_size))
+        size = static_cast<size_t> (_lvc_topic_size);
+    unsigned char *const data = static_cast<unsigned char *> (first.data ());
+
+    last_values_t::iterator it =
+      _last_values.find (blob_t (data, size, reference_tag_t ()));
+    if (it == _last_values.end ())
+        it = _last_values
+               .ZMQ_MAP_INSERT_OR_EMPLACE (blob_t (data, size), parts_t ())
+               .first;
+    else
+        close_parts (it->second);
+
+    //  The vector of the previous value is reused for the next message.
+    it->second.swap (_lvc_parts);
+}
+
+void zmq::xpub_t::clear_last_values ()
+{
+    for (last_values_t::iterator it = _last_values.begin (),
+                                 end = _last_values.end ();
+         it != end; ++it)
+        close_parts (it->second);
+    _last_values.clear ();
+    close_parts (_lvc_parts);
+}
@@ -4,6 +4,8 @@
 #define __ZMQ_XPUB_HPP_INCLUDED__
 
 #include <deque>
+#include <map>
+#include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
@@ -48,6 +50,21 @@ class xpub_t : public socket_base_t
     //  Function to be applied to each matching pipes.
     static void mark_as_matching (zmq::pipe_t *pipe_, xpub_t *self_);
 
+    //  Sends the pipe the last values of the topics matching the prefix,
+    //  once the message being sent, if any, is complete.
+    void send_last_values (zmq::pipe_t *pipe_,
+                           unsigned char *prefix_,
+                           size_t size_);
+
+    //  Sends the last values deferred while a message was being sent.
+    void send_pending_last_values ();
+
+    //  Stores the message sent as the last value of its topic.
+    void store_last_value ();
+
+    //  Empties the last value cache.
+    void clear_last_values ();
+
     //  List of all subscriptions mapped to corresponding pipes.
     mtrie_t _subscriptions;
 
@@ -101,6 +118,26 @@ class xpub_t : public socket_base_t
     //  Welcome message to send to pipe when attached
     msg_t _welcome_msg;
 
+    //  Number of bytes of the first frame of a message making its topic
+    //  in the last value cache, -1 for the whole frame, or 0 if there is no
+    //  cache. Set with ZMQ_XPUB_LAST_VALUE_CACHE.
+    int _lvc_topic_size;
+
+    //  Last value cache: the frames of the last message sent on each topic,
+    //  ordered by topic so that the topics matching a subscription are
+    //  found by a prefix walk.
+    typedef std::vector<msg_t> parts_t;
+    typedef std::map<blob_t, parts_t> last_values_t;
+    last_values_t _last_values;
+
+    //  Frames of the message being sent, for the last value cache.
+    parts_t _lvc_parts;
+
+    //  Subscriptions received while a message was being sent, whose last
+    //  values are sent once it is complete. Terminated pipes are NULL.
+    std::deque<pipe_t *> _lvc_pending_pipes;
+    std::deque<blob_t> _lvc_pending_prefixes;
+
     //  List of pending (un)subscriptions, ie. those that were already
     //  applied to the trie, but not yet received by the user.
     std::deque<blob_t> _pending_data;
@@ -15,8 +15,11 @@ namespace zmq
 //  T is the type of the object in the queue.
 //  N is granularity of the pipe, i.e. how many items are needed to
 //  perform next memory allocation.
+//  M is the granularity the pipe starts with, and gets back to whenever the
+//  reader has read all the items, growing up to N while it lags behind.
 
-template <typename T, int N> class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
+template <typename T, int N, int M = N>
+class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
 {
   public:
     //  Initialises the pipe.
@@ -88,6 +91,9 @@ template <typename T, int N> class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
             //  that reader is sleeping.
             _c.set (_f);
             _w = _f;
+
+            //  The reader has read all the items flushed before.
+            _queue.shrink ();
             return false;
         }
 
@@ -114,8 +120,13 @@ template <typename T, int N> class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
         //  During pipe's lifetime r should never be NULL, however,
         //  it can happen during pipe shutdown when items
         //  are being deallocated.
-        if (&_queue.front () == _r || !_r)
+        if (&_queue.front () == _r || !_r) {
+            //  The reader goes to sleep, so the spare chunk won't be of use
+            //  for a while.
+            if (_r)
+                _queue.release_spare ();
             return false;
+        }
 
         //  There was at least one value prefetched.
         return true;
@@ -136,6 +147,29 @@ template <typename T, int N> class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
         return true;
     }
 
+    //  Switches the pipe from passive to active state, so that the writer
+    //  stops signalling new items and the reader can keep polling with
+    //  try_read instead. Returns false if the writer flushed items while
+    //  the pipe was passive; these have been or are being signalled, and
+    //  the pipe is left as it is.
+    bool activate () { return _c.cas (NULL, &_queue.front ()) == NULL; }
+
+    //  Like read, but leaves the pipe active when it is empty. May only be
+    //  called while the pipe is active.
+    bool try_read (T *value_)
+    {
+        if (&_queue.front () == _r || !_r) {
+            //  Fetch 'c' without changing it.
+            _r = _c.cas (NULL, NULL);
+            if (&_queue.front () == _r || !_r)
+                return false;
+        }
+
+        *value_ = _queue.front ();
+        _queue.pop ();
+        return true;
+    }
+
     //  Applies the function fn to the first element in the pipe
     //  and returns the value returned by the fn.
     //  The pipe mustn't be empty or the function crashes.
@@ -152,7 +186,7 @@ template <typename T, int N> class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
     //  Front of the queue points to the first prefetched item, back of
     //  the pipe points to last un-flushed item. Front is used only by
     //  reader thread, while back is used only by writer thread.
-    yqueue_t<T, N> _queue;
+    yqueue_t<T, N, M> _queue;
 
     //  Points to the first un-flushed item. This variable is used
     //  exclusively by writer thread.
@@ -0,0 +1,200 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "ypipe_keyed.hpp"
+#include "err.hpp"
+
+#include <algorithm>
+
+//  Number of slots below which the writer does not sweep them.
+static const size_t min_evict_at = 64;
+
+zmq::ypipe_keyed_t::ypipe_keyed_t (int key_size_) :
+    _key_size (key_size_),
+    _evict_at (min_evict_at),
+    _pending (NULL),
+    _spare (NULL),
+    _current (NULL),
+    _current_pos (0)
+{
+}
+
+zmq::ypipe_keyed_t::~ypipe_keyed_t ()
+{
+    //  Both threads are done with the pipe: drop whatever is left in it.
+    if (_current) {
+        close (_current, _current_pos);
+        delete _current;
+    }
+    _dirty.flush ();
+    slot_t *slot;
+    while (_dirty.read (&slot)) {
+        parts_t *parts = slot->latest.xchg (NULL);
+        if (parts) {
+            close (parts, 0);
+            delete parts;
+        }
+        if (slot->transient)
+            delete slot;
+    }
+    for (slots_t::iterator it = _slots.begin (), end = _slots.end ();
+         it != end; ++it)
+        delete it->second;
+
+    if (_pending) {
+        close (_pending, 0);
+        delete _pending;
+    }
+    delete _spare;
+}
+
+void zmq::ypipe_keyed_t::write (const msg_t &value_, bool incomplete_)
+{
+    if (!_pending) {
+        if (_spare) {
+            _pending = _spare;
+            _spare = NULL;
+        } else {
+            _pending = new (std::nothrow) parts_t;
+            alloc_assert (_pending);
+        }
+    }
+    _pending->push_back (value_);
+
+    if (!incomplete_)
+        commit ();
+}
+
+bool zmq::ypipe_keyed_t::unwrite (msg_t *value_)
+{
+    if (!_pending || _pending->empty ())
+        return false;
+    *value_ = _pending->back ();
+    _pending->pop_back ();
+    return true;
+}
+
+void zmq::ypipe_keyed_t::commit ()
+{
+    parts_t *const parts = _pending;
+    _pending = NULL;
+
+    //  Delimiters and commands get a slot of their own.
+    msg_t &first = parts->front ();
+    slot_t *slot;
+    if (first.is_delimiter ()
+        || (first.flags () & ~(msg_t::more | msg_t::shared)) != 0) {
+        slot = new (std::nothrow) slot_t (true);
+        alloc_assert (slot);
+    } else {
+        size_t size = first.size ();
+        if (_key_size >= 0 && size > static_cast<size_t> (_key_size))
+            size = static_cast<size_t> (_key_size);
+        unsigned char *const data =
+          static_cast<unsigned char *> (first.data ());
+        const slots_t::iterator it =
+          _slots.find (blob_t (data, size, reference_tag_t ()));
+        if (it != _slots.end ())
+            slot = it->second;
+        else {
+            if (_slots.size () >= _evict_at)
+                evict ();
+            slot = new (std::nothrow) slot_t (false);
+            alloc_assert (slot);
+            _slots.ZMQ_MAP_INSERT_OR_EMPLACE (blob_t (data, size), slot);
+        }
+    }
+
+    //  If the reader has not taken the previous message yet, the slot is
+    //  queued already, and the previous message is dropped.
+    parts_t *const previous = slot->latest.xchg (parts);
+    if (previous) {
+        close (previous, 0);
+        previous->clear ();
+        delete _spare;
+        _spare = previous;
+    } else
+        _dirty.write (slot, false);
+}
+
+void zmq::ypipe_keyed_t::evict ()
+{
+    //  A slot is empty once the reader swapped its message out, after
+    //  taking it off the dirty queue: neither of them refers to it anymore.
+    for (slots_t::iterator it = _slots.begin (); it != _slots.end ();) {
+        if (it->second->latest.cas (NULL, NULL) == NULL) {
+            delete it->second;
+            _slots.erase (it++);
+        } else
+            ++it;
+    }
+
+    //  Sweeping again once the number of slots doubled keeps the cost of
+    //  the sweeps proportional to the number of keys written.
+    _evict_at = std::max (min_evict_at, 2 * _slots.size ());
+}
+
+size_t zmq::ypipe_keyed_t::keys () const
+{
+    return _slots.size ();
+}
+
+bool zmq::ypipe_keyed_t::flush ()
+{
+    return _dirty.flush ();
+}
+
+bool zmq::ypipe_keyed_t::check_read ()
+{
+    return _current || _dirty.check_read ();
+}
+
+bool zmq::ypipe_keyed_t::fetch ()
+{
+    if (_current)
+        return true;
+
+    slot_t *slot;
+    if (!_dirty.read (&slot))
+        return false;
+
+    //  A slot is only queued when it gets a message, and only the reader
+    //  takes it out. Once it is empty, the writer may drop a keyed slot at
+    //  any time, so it is not touched past the swap.
+    const bool transient = slot->transient;
+    _current = slot->latest.xchg (NULL);
+    zmq_assert (_current && !_current->empty ());
+    _current_pos = 0;
+    if (transient)
+        delete slot;
+    return true;
+}
+
+bool zmq::ypipe_keyed_t::read (msg_t *value_)
+{
+    if (!fetch ())
+        return false;
+
+    *value_ = (*_current)[_current_pos++];
+    if (_current_pos == _current->size ()) {
+        delete _current;
+        _current = NULL;
+    }
+    return true;
+}
+
+bool zmq::ypipe_keyed_t::probe (bool (*fn_) (const msg_t &))
+{
+    const bool rc = fetch ();
+    zmq_assert (rc);
+
+    return (*fn_) ((*_current)[_current_pos]);
+}
+
+void zmq::ypipe_keyed_t::close (parts_t *parts_, size_t from_)
+{
+    for (size_t i = from_; i < parts_->size (); i++) {
+        const int rc = (*parts_)[i].close ();
+        errno_assert (rc == 0);
+    }
+}
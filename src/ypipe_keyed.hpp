@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_YPIPE_KEYED_HPP_INCLUDED__
+#define __ZMQ_YPIPE_KEYED_HPP_INCLUDED__
+
+#include <map>
+#include <vector>
+
+#include "atomic_ptr.hpp"
+#include "blob.hpp"
+#include "config.hpp"
+#include "msg.hpp"
+#include "ypipe.hpp"
+#include "ypipe_base.hpp"
+
+namespace zmq
+{
+//  Pipe implementing keyed conflation (see ZMQ_CONFLATE_KEY): of the
+//  messages sharing a key, the reader only gets the newest one not read
+//  yet. The key is made of the first bytes of the first frame of each
+//  message, or of the whole frame.
+//
+//  The writer keeps a slot per key. Writing a message swaps it into its
+//  slot atomically, and queues the slot in the dirty queue unless the
+//  slot already held a message, which gets dropped. The reader takes the
+//  slots off the dirty queue and swaps their message out, so that it
+//  catches up in as many reads as there are keys written to meanwhile,
+//  whatever the number of messages written. Delimiters and commands, such
+//  as ZMTP 3.1 subscriptions, are never conflated: each gets a slot of its
+//  own. ZMTP 3.0 subscriptions are data frames, keyed like any other.
+//
+//  A slot the reader has emptied is not queued, and the reader does not
+//  touch it anymore, so the writer drops it, sweeping the slots whenever
+//  their number doubled. The writer thus holds as many slots as there are
+//  keys not read yet, plus those read since the last sweep.
+
+class ypipe_keyed_t ZMQ_FINAL : public ypipe_base_t<msg_t>
+{
+  public:
+    //  key_size_ is the number of bytes of the first frame making the key,
+    //  or -1 for the whole frame.
+    explicit ypipe_keyed_t (int key_size_);
+    ~ypipe_keyed_t ();
+
+    //  ypipe_base_t interface.
+    void write (const msg_t &value_, bool incomplete_);
+    bool unwrite (msg_t *value_);
+    bool flush ();
+    bool check_read ();
+    bool read (msg_t *value_);
+    bool probe (bool (*fn_) (const msg_t &));
+
+    //  Number of keys the writer holds a slot for.
+    size_t keys () const;
+
+  private:
+    //  The frames of a message.
+    typedef std::vector<msg_t> parts_t;
+
+    struct slot_t
+    {
+        explicit slot_t (bool transient_) : transient (transient_) {}
+
+        //  Message not read yet, or NULL. Swapped by both threads.
+        atomic_ptr_t<parts_t> latest;
+
+        //  True if the slot carries a single message, that is not
+        //  conflated. The reader deletes the slot once it took it.
+        const bool transient;
+
+        ZMQ_NON_COPYABLE_NOR_MOVABLE (slot_t)
+    };
+
+    //  Stores the message written into its slot.
+    void commit ();
+
+    //  Takes the message of the next dirty slot unless the reader has one
+    //  already. Returns false if there is none.
+    bool fetch ();
+
+    //  Drops the slots the reader has emptied.
+    void evict ();
+
+    static void close (parts_t *parts_, size_t from_);
+
+    const int _key_size;
+
+    //  Slots of the keys written to and not dropped yet. Used by the writer
+    //  only.
+    typedef std::map<blob_t, slot_t *> slots_t;
+    slots_t _slots;
+
+    //  Number of slots at which the writer sweeps them next.
+    size_t _evict_at;
+
+    //  Frames of the message being written, and a vector to reuse for the
+    //  next one. Used by the writer only.
+    parts_t *_pending;
+    parts_t *_spare;
+
+    //  Slots holding a message the reader has not taken yet.
+    ypipe_t<slot_t *, message_pipe_granularity> _dirty;
+
+    //  Message being read, and the position of its next frame. Used by
+    //  the reader only.
+    parts_t *_current;
+    size_t _current_pos;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (ypipe_keyed_t)
+};
+}
+
+#endif
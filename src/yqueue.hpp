@@ -24,6 +24,9 @@ namespace zmq
 //  T is the type of the object in the queue.
 //  N is granularity of the queue (how many pushes have to be done till
 //  actual memory allocation is required).
+//  M is the size of the first chunk. Each chunk allocated next is twice
+//  the size of the previous one, up to N, until the queue gets told that
+//  the reader has caught up with the writer (see shrink and release_spare).
 #if defined HAVE_POSIX_MEMALIGN
 // ALIGN is the memory alignment size to use in the case where we have
 // posix_memalign available. Default value is 64, this alignment will
@@ -31,17 +34,19 @@ namespace zmq
 // architectures where cache lines are <= 64 bytes (e.g. most things
 // except POWER). It is detected at build time to try to account for other
 // platforms like POWER and s390x.
-template <typename T, int N, size_t ALIGN = ZMQ_CACHELINE_SIZE> class yqueue_t
+template <typename T, int N, int M = N, size_t ALIGN = ZMQ_CACHELINE_SIZE>
+class yqueue_t
 #else
-template <typename T, int N> class yqueue_t
+template <typename T, int N, int M = N> class yqueue_t
 #endif
 {
   public:
     //  Create the queue.
     inline yqueue_t ()
     {
-        _begin_chunk = allocate_chunk ();
+        _begin_chunk = allocate_chunk (M);
         alloc_assert (_begin_chunk);
+        _next_size = M < N / 2 ? 2 * M : N;
         _begin_pos = 0;
         _back_chunk = NULL;
         _back_pos = 0;
@@ -54,16 +59,16 @@ template <typename T, int N> class yqueue_t
     {
         while (true) {
             if (_begin_chunk == _end_chunk) {
-                free (_begin_chunk);
+                free_chunk (_begin_chunk);
                 break;
             }
             chunk_t *o = _begin_chunk;
             _begin_chunk = _begin_chunk->next;
-            free (o);
+            free_chunk (o);
         }
 
         chunk_t *sc = _spare_chunk.xchg (NULL);
-        free (sc);
+        free_chunk (sc);
     }
 
     //  Returns reference to the front element of the queue.
@@ -80,19 +85,23 @@ template <typename T, int N> class yqueue_t
         _back_chunk = _end_chunk;
         _back_pos = _end_pos;
 
-        if (++_end_pos != N)
+        if (++_end_pos != _end_chunk->size)
             return;
 
+        //  A spare chunk smaller than the queue has grown to is of no use.
         chunk_t *sc = _spare_chunk.xchg (NULL);
-        if (sc) {
-            _end_chunk->next = sc;
-            sc->prev = _end_chunk;
-        } else {
-            _end_chunk->next = allocate_chunk ();
-            alloc_assert (_end_chunk->next);
-            _end_chunk->next->prev = _end_chunk;
+        if (sc && sc->size < _next_size) {
+            free_chunk (sc);
+            sc = NULL;
         }
-        _end_chunk = _end_chunk->next;
+        if (!sc) {
+            sc = allocate_chunk (_next_size);
+            alloc_assert (sc);
+            _next_size = _next_size < N / 2 ? 2 * _next_size : N;
+        }
+        _end_chunk->next = sc;
+        sc->prev = _end_chunk;
+        _end_chunk = sc;
         _end_pos = 0;
     }
 
@@ -109,8 +118,8 @@ template <typename T, int N> class yqueue_t
         if (_back_pos)
             --_back_pos;
         else {
-            _back_pos = N - 1;
             _back_chunk = _back_chunk->prev;
+            _back_pos = _back_chunk->size - 1;
         }
 
         //  Now, move 'end' position backwards. Note that obsolete end chunk
@@ -120,9 +129,9 @@ template <typename T, int N> class yqueue_t
         if (_end_pos)
             --_end_pos;
         else {
-            _end_pos = N - 1;
             _end_chunk = _end_chunk->prev;
-            free (_end_chunk->next);
+            _end_pos = _end_chunk->size - 1;
+            free_chunk (_end_chunk->next);
             _end_chunk->next = NULL;
         }
     }
@@ -130,7 +139,7 @@ template <typename T, int N> class yqueue_t
     //  Removes an element from the front end of the queue.
     inline void pop ()
     {
-        if (++_begin_pos == N) {
+        if (++_begin_pos == _begin_chunk->size) {
             chunk_t *o = _begin_chunk;
             _begin_chunk = _begin_chunk->next;
             _begin_chunk->prev = NULL;
@@ -140,29 +149,63 @@ template <typename T, int N> class yqueue_t
             //  so for cache reasons we'll get rid of the spare and
             //  use 'o' as the spare.
             chunk_t *cs = _spare_chunk.xchg (o);
-            free (cs);
+            free_chunk (cs);
         }
     }
 
+    //  Lets the queue shrink back to chunks of M elements, as the reader
+    //  has caught up with the writer. May only be called by the writer.
+    inline void shrink ()
+    {
+        if (M < N)
+            _next_size = M;
+    }
+
+    //  Frees the spare chunk, as the reader has caught up with the writer.
+    //  May only be called by the reader.
+    inline void release_spare ()
+    {
+        if (M < N)
+            free_chunk (_spare_chunk.xchg (NULL));
+    }
+
   private:
-    //  Individual memory chunk to hold N elements.
+    //  Individual memory chunk to hold up to N elements. The elements are
+    //  allocated first, so that they keep the alignment of the memory
+    //  block, followed by this header.
     struct chunk_t
     {
-        T values[N];
+        T *values;
         chunk_t *prev;
         chunk_t *next;
+        int size;
     };
 
-    static inline chunk_t *allocate_chunk ()
+    static inline chunk_t *allocate_chunk (int size_)
     {
+        //  The header is aligned as a multiple of its own size.
+        const size_t offset = (size_ * sizeof (T) + sizeof (chunk_t) - 1)
+                              / sizeof (chunk_t) * sizeof (chunk_t);
 #if defined HAVE_POSIX_MEMALIGN
         void *pv;
-        if (posix_memalign (&pv, ALIGN, sizeof (chunk_t)) == 0)
-            return (chunk_t *) pv;
-        return NULL;
+        if (posix_memalign (&pv, ALIGN, offset + sizeof (chunk_t)) != 0)
+            return NULL;
 #else
-        return static_cast<chunk_t *> (malloc (sizeof (chunk_t)));
+        void *pv = malloc (offset + sizeof (chunk_t));
+        if (!pv)
+            return NULL;
 #endif
+        chunk_t *const chunk = reinterpret_cast<chunk_t *> (
+          static_cast<unsigned char *> (pv) + offset);
+        chunk->values = static_cast<T *> (pv);
+        chunk->size = size_;
+        return chunk;
+    }
+
+    static inline void free_chunk (chunk_t *chunk_)
+    {
+        if (chunk_)
+            free (chunk_->values);
     }
 
     //  Back position may point to invalid memory if the queue is empty,
@@ -176,6 +219,10 @@ template <typename T, int N> class yqueue_t
     chunk_t *_end_chunk;
     int _end_pos;
 
+    //  Number of elements of the next chunk to allocate. Accessed by the
+    //  writer only.
+    int _next_size;
+
     //  People are likely to produce and consume at similar rates.  In
     //  this scenario holding onto the most recently freed chunk saves
     //  us from having to call malloc/free.
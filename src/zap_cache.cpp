@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include <algorithm>
+
+#include "zap_cache.hpp"
+
+//  Purging expired entries is linear in the size of the cache, so it is
+//  done whenever the cache doubles in size, starting from this size.
+static const size_t min_purge_size = 1024;
+
+zmq::zap_cache_t::zap_cache_t () :
+    _ttl (0), _generation (0), _purge_size (min_purge_size)
+{
+}
+
+void zmq::zap_cache_t::set_ttl (int ttl_)
+{
+    scoped_lock_t locker (_sync);
+    _ttl = ttl_;
+    _generation++;
+    _entries.clear ();
+    _purge_size = min_purge_size;
+}
+
+int zmq::zap_cache_t::get_ttl ()
+{
+    scoped_lock_t locker (_sync);
+    return _ttl;
+}
+
+bool zmq::zap_cache_t::enabled ()
+{
+    scoped_lock_t locker (_sync);
+    return _ttl > 0;
+}
+
+bool zmq::zap_cache_t::find (const std::string &request_,
+                             reply_t *reply_,
+                             uint64_t *generation_)
+{
+    scoped_lock_t locker (_sync);
+
+    *generation_ = _generation;
+
+    const entries_t::iterator it = _entries.find (request_);
+    if (it == _entries.end ())
+        return false;
+    if (it->second.expiry <= _clock.now_ms ()) {
+        _entries.erase (it);
+        return false;
+    }
+    *reply_ = it->second.reply;
+    return true;
+}
+
+void zmq::zap_cache_t::insert (const std::string &request_,
+                               const reply_t &reply_,
+                               uint64_t generation_)
+{
+    scoped_lock_t locker (_sync);
+
+    if (_ttl == 0 || generation_ != _generation)
+        return;
+
+    const uint64_t now = _clock.now_ms ();
+    if (_entries.size () >= _purge_size) {
+        purge (now);
+        _purge_size = std::max (min_purge_size, 2 * _entries.size ());
+    }
+
+    entry_t &entry = _entries[request_];
+    entry.expiry = now + _ttl;
+    entry.reply = reply_;
+}
+
+void zmq::zap_cache_t::purge (uint64_t now_)
+{
+    entries_t::iterator it = _entries.begin ();
+    while (it != _entries.end ()) {
+        if (it->second.expiry <= now_)
+            _entries.erase (it++);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_ZAP_CACHE_HPP_INCLUDED__
+#define __ZMQ_ZAP_CACHE_HPP_INCLUDED__
+
+#include <map>
+#include <string>
+
+#include "clock.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Cache of ZAP replies, shared by all the sockets of a context, so that a
+//  peer reconnecting with the same credentials is not authenticated by the
+//  ZAP handler all over again. Entries are keyed by the contents of the ZAP
+//  request (domain, address, routing id, mechanism and credentials) and
+//  expire after a configurable time. Only definitive answers (200 and 400)
+//  are cached.
+
+class zap_cache_t
+{
+  public:
+    struct reply_t
+    {
+        std::string status_code;
+        std::string user_id;
+        std::string metadata;
+    };
+
+    zap_cache_t ();
+
+    //  Sets the time, in milliseconds, replies are kept for. Zero disables
+    //  the cache. Any cached replies are discarded.
+    void set_ttl (int ttl_);
+    int get_ttl ();
+
+    bool enabled ();
+
+    //  Copies the reply cached for the request into reply_ and returns
+    //  true if there is a reply that has not expired yet. Otherwise, the
+    //  current generation of the cache is stored in generation_, to be
+    //  passed to insert along with the reply of the ZAP handler.
+    bool find (const std::string &request_,
+               reply_t *reply_,
+               uint64_t *generation_);
+
+    //  Caches the reply, unless the cache was reset after the lookup.
+    void insert (const std::string &request_,
+                 const reply_t &reply_,
+                 uint64_t generation_);
+
+  private:
+    //  Removes the expired entries.
+    void purge (uint64_t now_);
+
+    struct entry_t
+    {
+        uint64_t expiry;
+        reply_t reply;
+    };
+    typedef std::map<std::string, entry_t> entries_t;
+    entries_t _entries;
+
+    //  Time to live of the entries, in milliseconds; 0 if disabled.
+    int _ttl;
+
+    //  Incremented each time the cache is reset, so that replies to
+    //  requests sent before are not cached.
+    uint64_t _generation;
+
+    //  Size the cache may grow to before the expired entries are purged.
+    size_t _purge_size;
+
+    clock_t _clock;
+
+    mutex_t _sync;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (zap_cache_t)
+};
+}
+
+#endif
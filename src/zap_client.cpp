@@ -5,6 +5,8 @@
 #include "zap_client.hpp"
 #include "msg.hpp"
 #include "session_base.hpp"
+#include "ctx.hpp"
+#include "wire.hpp"
 
 namespace zmq
 {
@@ -17,10 +19,23 @@ const size_t id_len = sizeof (id) - 1;
 zap_client_t::zap_client_t (session_base_t *const session_,
                             const std::string &peer_address_,
                             const options_t &options_) :
-    mechanism_base_t (session_, options_), peer_address (peer_address_)
+    mechanism_base_t (session_, options_),
+    peer_address (peer_address_),
+    _zap_cache_generation (0),
+    _zap_reply_cached (false)
 {
 }
 
+//  Appends a length-prefixed part of the request to the ZAP cache key.
+static void
+append_zap_cache_part (std::string &request_, const void *data_, size_t size_)
+{
+    unsigned char size[4];
+    put_uint32 (size, static_cast<uint32_t> (size_));
+    request_.append (reinterpret_cast<char *> (size), sizeof size);
+    request_.append (static_cast<const char *> (data_), size_);
+}
+
 void zap_client_t::send_zap_request (const char *mechanism_,
                                      size_t mechanism_length_,
                                      const uint8_t *credentials_,
@@ -36,6 +51,30 @@ void zap_client_t::send_zap_request (const char *mechanism_,
                                      size_t *credentials_sizes_,
                                      size_t credentials_count_)
 {
+    //  A peer that authenticated recently with the same request gets the
+    //  same reply without bothering the ZAP handler.
+    zap_cache_t *const cache = session->get_ctx ()->get_zap_cache ();
+    _zap_cache_request.clear ();
+    if (cache->enabled ()) {
+        append_zap_cache_part (_zap_cache_request, options.zap_domain.c_str (),
+                               options.zap_domain.length ());
+        append_zap_cache_part (_zap_cache_request, peer_address.c_str (),
+                               peer_address.length ());
+        append_zap_cache_part (_zap_cache_request, options.routing_id,
+                               options.routing_id_size);
+        append_zap_cache_part (_zap_cache_request, mechanism_,
+                               mechanism_length_);
+        for (size_t i = 0; i < credentials_count_; ++i)
+            append_zap_cache_part (_zap_cache_request, credentials_[i],
+                                   credentials_sizes_[i]);
+
+        if (cache->find (_zap_cache_request, &_cached_zap_reply,
+                         &_zap_cache_generation)) {
+            _zap_reply_cached = true;
+            return;
+        }
+    }
+
     // write_zap_msg cannot fail. It could only fail if the HWM was exceeded,
     // but on the ZAP socket, the HWM is disabled.
 
@@ -113,6 +152,11 @@ void zap_client_t::send_zap_request (const char *mechanism_,
 
 int zap_client_t::receive_and_process_zap_reply ()
 {
+    if (_zap_reply_cached) {
+        _zap_reply_cached = false;
+        return process_cached_zap_reply ();
+    }
+
     int rc = 0;
     const size_t zap_reply_frame_count = 7;
     msg_t msg[zap_reply_frame_count];
@@ -194,6 +238,20 @@ int zap_client_t::receive_and_process_zap_reply ()
         return close_and_return (msg, -1);
     }
 
+    //  Temporary failures and internal errors of the handler are not
+    //  cached, the next handshake asks again.
+    if (!_zap_cache_request.empty ()
+        && (status_code[0] == '2' || status_code[0] == '4')) {
+        zap_cache_t::reply_t reply;
+        reply.status_code = status_code;
+        reply.user_id.assign (static_cast<char *> (msg[5].data ()),
+                              msg[5].size ());
+        reply.metadata.assign (static_cast<char *> (msg[6].data ()),
+                               msg[6].size ());
+        session->get_ctx ()->get_zap_cache ()->insert (
+          _zap_cache_request, reply, _zap_cache_generation);
+    }
+
     //  Close all reply frames
     for (size_t i = 0; i < zap_reply_frame_count; i++) {
         const int rc2 = msg[i].close ();
@@ -205,6 +263,23 @@ int zap_client_t::receive_and_process_zap_reply ()
     return 0;
 }
 
+int zap_client_t::process_cached_zap_reply ()
+{
+    status_code = _cached_zap_reply.status_code;
+    set_user_id (_cached_zap_reply.user_id.data (),
+                 _cached_zap_reply.user_id.size ());
+
+    //  The metadata was validated when the reply was first received.
+    const std::string &metadata = _cached_zap_reply.metadata;
+    const int rc = parse_metadata (
+      reinterpret_cast<const unsigned char *> (metadata.data ()),
+      metadata.size (), true);
+    zmq_assert (rc == 0);
+
+    handle_zap_status_code ();
+    return 0;
+}
+
 void zap_client_t::handle_zap_status_code ()
 {
     //  we can assume here that status_code is a valid ZAP status code,
@@ -4,6 +4,7 @@
 #define __ZMQ_ZAP_CLIENT_HPP_INCLUDED__
 
 #include "mechanism_base.hpp"
+#include "zap_cache.hpp"
 
 namespace zmq
 {
@@ -33,6 +34,20 @@ class zap_client_t : public virtual mechanism_base_t
 
     //  Status code as received from ZAP handler
     std::string status_code;
+
+  private:
+    //  Applies the reply found in the ZAP cache of the context.
+    int process_cached_zap_reply ();
+
+    //  The request, as the key to the ZAP cache; empty if the cache is
+    //  disabled.
+    std::string _zap_cache_request;
+    uint64_t _zap_cache_generation;
+
+    //  Set if the reply was found in the cache, in which case no request
+    //  was sent to the ZAP handler.
+    bool _zap_reply_cached;
+    zap_cache_t::reply_t _cached_zap_reply;
 };
 
 class zap_client_common_handshake_t : public zap_client_t
@@ -66,6 +66,7 @@ struct iovec
 #include "fd.hpp"
 #include "metadata.hpp"
 #include "socket_poller.hpp"
+#include "completion_queue.hpp"
 #include "timers.hpp"
 #include "ip.hpp"
 #include "address.hpp"
@@ -1630,6 +1631,126 @@ int zmq_poller_fd (void *poller_, zmq_fd_t *fd_)
     return static_cast<zmq::socket_poller_t *> (poller_)->signaler_fd (fd_);
 }
 
+//  The completion queue functionality
+
+void *zmq_cq_new (void)
+{
+    zmq::completion_queue_t *cq = new (std::nothrow) zmq::completion_queue_t;
+    if (!cq) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (!cq->valid ()) {
+        delete cq;
+        errno = EMFILE;
+        return NULL;
+    }
+    return cq;
+}
+
+int zmq_cq_destroy (void **cq_p_)
+{
+    if (cq_p_) {
+        const zmq::completion_queue_t *const cq =
+          static_cast<const zmq::completion_queue_t *> (*cq_p_);
+        if (cq && cq->check_tag ()) {
+            delete cq;
+            *cq_p_ = NULL;
+            return 0;
+        }
+    }
+    errno = EFAULT;
+    return -1;
+}
+
+static int check_cq (void *const cq_)
+{
+    if (!cq_ || !(static_cast<zmq::completion_queue_t *> (cq_))->check_tag ()) {
+        errno = EFAULT;
+        return -1;
+    }
+
+    return 0;
+}
+
+static int check_cq_registration_args (void *const cq_, void *const s_)
+{
+    if (-1 == check_cq (cq_))
+        return -1;
+
+    if (!s_ || !(static_cast<zmq::socket_base_t *> (s_))->check_tag ()) {
+        errno = ENOTSOCK;
+        return -1;
+    }
+
+    return 0;
+}
+
+int zmq_cq_size (void *cq_)
+{
+    if (-1 == check_cq (cq_))
+        return -1;
+
+    return (static_cast<zmq::completion_queue_t *> (cq_))->size ();
+}
+
+int zmq_cq_add (void *cq_, void *s_, void *user_data_, short events_)
+{
+    if (-1 == check_cq_registration_args (cq_, s_)
+        || -1 == check_events (events_))
+        return -1;
+
+    zmq::socket_base_t *socket = static_cast<zmq::socket_base_t *> (s_);
+
+    return (static_cast<zmq::completion_queue_t *> (cq_))
+      ->add (socket, user_data_, events_);
+}
+
+int zmq_cq_modify (void *cq_, void *s_, short events_)
+{
+    if (-1 == check_cq_registration_args (cq_, s_)
+        || -1 == check_events (events_))
+        return -1;
+
+    const zmq::socket_base_t *const socket =
+      static_cast<const zmq::socket_base_t *> (s_);
+
+    return (static_cast<zmq::completion_queue_t *> (cq_))
+      ->modify (socket, events_);
+}
+
+int zmq_cq_remove (void *cq_, void *s_)
+{
+    if (-1 == check_cq_registration_args (cq_, s_))
+        return -1;
+
+    zmq::socket_base_t *socket = static_cast<zmq::socket_base_t *> (s_);
+
+    return (static_cast<zmq::completion_queue_t *> (cq_))->remove (socket);
+}
+
+int zmq_cq_wait (void *cq_,
+                 zmq_poller_event_t *events_,
+                 int n_events_,
+                 long timeout_)
+{
+    if (-1 == check_cq (cq_))
+        return -1;
+
+    if (!events_) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (n_events_ < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return (static_cast<zmq::completion_queue_t *> (cq_))
+      ->wait (reinterpret_cast<zmq::completion_queue_t::event_t *> (events_),
+              n_events_, timeout_);
+}
+
 //  Peer-specific state
 
 int zmq_socket_get_peer_state (void *s_,
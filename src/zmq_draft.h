@@ -54,6 +54,15 @@
 #define ZMQ_NORM_NUM_PARITY 122
 #define ZMQ_NORM_NUM_AUTOPARITY 123
 #define ZMQ_NORM_PUSH 124
+#define ZMQ_TCP_LISTEN_SHARDS 125
+#define ZMQ_TCP_LISTEN_CPU_STEERING 126
+#define ZMQ_ACCEPT_BATCH_SIZE 127
+#define ZMQ_OPTIMISTIC_HANDSHAKE 128
+#define ZMQ_IO_BUDGET 129
+#define ZMQ_RCVSPIN 130
+#define ZMQ_CURVE_AEAD 131
+#define ZMQ_CONFLATE_KEY 132
+#define ZMQ_XPUB_LAST_VALUE_CACHE 133
 
 /*  DRAFT ZMQ_NORM_MODE options                                               */
 #define ZMQ_NORM_FIXED 0
@@ -67,8 +76,23 @@
 #define ZMQ_RECONNECT_STOP_HANDSHAKE_FAILED 0x2
 #define ZMQ_RECONNECT_STOP_AFTER_DISCONNECT 0x4
 
+/*  DRAFT ZMQ_CURVE_AEAD options                                              */
+#define ZMQ_CURVE_AEAD_AES256GCM 1
+#define ZMQ_CURVE_AEAD_CHACHA20POLY1305 2
+
+/*  DRAFT ZMQ_CONFLATE_KEY options                                            */
+#define ZMQ_CONFLATE_KEY_FRAME -1
+
+/*  DRAFT ZMQ_XPUB_LAST_VALUE_CACHE options                                   */
+#define ZMQ_XPUB_LAST_VALUE_CACHE_FRAME -1
+
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_IO_THREAD_REBALANCE_IVL 11
+#define ZMQ_CRYPTO_THREADS 12
+#define ZMQ_ZAP_CACHE_TTL 13
+#define ZMQ_EDGE_TRIGGERED 14
+#define ZMQ_IO_THREAD_STATS 15
 
 /*  DRAFT Context methods.                                                    */
 int zmq_ctx_set_ext (void *context_,
@@ -80,6 +104,20 @@ int zmq_ctx_get_ext (void *context_,
                      void *optval_,
                      size_t *optvallen_);
 
+/*  Utilisation of an I/O thread, as returned by ZMQ_IO_THREAD_STATS. Times   */
+/*  are in microseconds.                                                      */
+typedef struct zmq_io_thread_stats_t
+{
+    uint64_t busy_time;
+    uint64_t idle_time;
+    uint64_t events;
+    uint64_t commands;
+    uint64_t timers;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t migrations;
+} zmq_io_thread_stats_t;
+
 /*  DRAFT Socket methods.                                                     */
 int zmq_join (void *s_, const char *group_);
 int zmq_leave (void *s_, const char *group_);
@@ -142,6 +180,17 @@ int zmq_poller_add_fd (void *poller_,
 int zmq_poller_modify_fd (void *poller_, zmq_fd_t fd_, short events_);
 int zmq_poller_remove_fd (void *poller_, zmq_fd_t fd_);
 
+void *zmq_cq_new (void);
+int zmq_cq_destroy (void **cq_p_);
+int zmq_cq_size (void *cq_);
+int zmq_cq_add (void *cq_, void *socket_, void *user_data_, short events_);
+int zmq_cq_modify (void *cq_, void *socket_, short events_);
+int zmq_cq_remove (void *cq_, void *socket_);
+int zmq_cq_wait (void *cq_,
+                 zmq_poller_event_t *events_,
+                 int n_events_,
+                 long timeout_);
+
 int zmq_socket_get_peer_state (void *socket_,
                                const void *routing_id_,
                                size_t routing_id_size_);
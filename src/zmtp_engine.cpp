@@ -16,6 +16,7 @@
 #include "zmtp_engine.hpp"
 #include "io_thread.hpp"
 #include "session_base.hpp"
+#include "ctx.hpp"
 #include "v1_encoder.hpp"
 #include "v1_decoder.hpp"
 #include "v2_encoder.hpp"
@@ -43,6 +44,7 @@ zmq::zmtp_engine_t::zmtp_engine_t (
     stream_engine_base_t (fd_, options_, endpoint_uri_pair_, true),
     _greeting_size (v2_greeting_size),
     _greeting_bytes_read (0),
+    _optimistic_handshake (false),
     _subscription_required (false),
     _heartbeat_timeout (0)
 {
@@ -75,6 +77,8 @@ void zmq::zmtp_engine_t::plug_internal ()
     // start optional timer, to prevent handshake hanging on no input
     set_handshake_timer ();
 
+    _crypto_pool = session ()->get_ctx ()->get_crypto_pool ();
+
     //  Send the 'length' and 'flags' fields of the routing id message.
     //  The 'length' field is encoded in the long format.
     _outpos = _greeting_send;
@@ -83,6 +87,16 @@ void zmq::zmtp_engine_t::plug_internal ()
     _outsize += 8;
     _outpos[_outsize++] = 0x7f;
 
+    //  Send the rest of the greeting right away, followed by the first
+    //  handshake command if possible, so that the peer can answer both
+    //  at once.
+    _optimistic_handshake = session ()->optimistic_handshake ();
+    if (_optimistic_handshake) {
+        _outpos[_outsize++] = 3; //  Major version number
+        put_greeting_v3_1 ();
+        put_first_handshake_command ();
+    }
+
     set_pollin ();
     set_pollout ();
     //  Flush all the data that may have been already received downstream.
@@ -102,6 +116,17 @@ bool zmq::zmtp_engine_t::handshake ()
         return false;
     const bool unversioned = rc != 0;
 
+    //  Peers older than ZMTP/3.0 cannot make sense of the greeting sent
+    //  already. Drop the connection, and let the session reconnect using
+    //  the regular handshake.
+    if (_optimistic_handshake
+        && (unversioned || _greeting_recv[revision_pos] < ZMTP_3_x)) {
+        session ()->disable_optimistic_handshake ();
+        errno = EPROTO;
+        error (connection_error);
+        return false;
+    }
+
     if (!(this
             ->*select_handshake_fun (unversioned, _greeting_recv[revision_pos],
                                      _greeting_recv[minor_pos])) ())
@@ -156,6 +181,15 @@ int zmq::zmtp_engine_t::receive_greeting ()
 
 void zmq::zmtp_engine_t::receive_greeting_versioned ()
 {
+    //  The whole greeting has been sent already; only find out how much
+    //  of the peer's greeting to read.
+    if (_optimistic_handshake) {
+        if (_greeting_bytes_read > signature_size
+            && _greeting_recv[revision_pos] >= ZMTP_3_x)
+            _greeting_size = v3_greeting_size;
+        return;
+    }
+
     //  Send the major version number.
     if (_outpos + _outsize == _greeting_send + signature_size) {
         if (_outsize == 0)
@@ -173,31 +207,71 @@ void zmq::zmtp_engine_t::receive_greeting_versioned ()
                 || _greeting_recv[revision_pos] == ZMTP_2_0)
                 _outpos[_outsize++] = _options.type;
             else {
-                _outpos[_outsize++] = 1; //  Minor version number
-                memset (_outpos + _outsize, 0, 20);
-
-                zmq_assert (_options.mechanism == ZMQ_NULL
-                            || _options.mechanism == ZMQ_PLAIN
-                            || _options.mechanism == ZMQ_CURVE
-                            || _options.mechanism == ZMQ_GSSAPI);
-
-                if (_options.mechanism == ZMQ_NULL)
-                    memcpy (_outpos + _outsize, "NULL", 4);
-                else if (_options.mechanism == ZMQ_PLAIN)
-                    memcpy (_outpos + _outsize, "PLAIN", 5);
-                else if (_options.mechanism == ZMQ_GSSAPI)
-                    memcpy (_outpos + _outsize, "GSSAPI", 6);
-                else if (_options.mechanism == ZMQ_CURVE)
-                    memcpy (_outpos + _outsize, "CURVE", 5);
-                _outsize += 20;
-                memset (_outpos + _outsize, 0, 32);
-                _outsize += 32;
+                put_greeting_v3_1 ();
                 _greeting_size = v3_greeting_size;
             }
         }
     }
 }
 
+void zmq::zmtp_engine_t::put_greeting_v3_1 ()
+{
+    _outpos[_outsize++] = 1; //  Minor version number
+    memset (_outpos + _outsize, 0, 20);
+
+    zmq_assert (_options.mechanism == ZMQ_NULL
+                || _options.mechanism == ZMQ_PLAIN
+                || _options.mechanism == ZMQ_CURVE
+                || _options.mechanism == ZMQ_GSSAPI);
+
+    if (_options.mechanism == ZMQ_NULL)
+        memcpy (_outpos + _outsize, "NULL", 4);
+    else if (_options.mechanism == ZMQ_PLAIN)
+        memcpy (_outpos + _outsize, "PLAIN", 5);
+    else if (_options.mechanism == ZMQ_GSSAPI)
+        memcpy (_outpos + _outsize, "GSSAPI", 6);
+    else if (_options.mechanism == ZMQ_CURVE)
+        memcpy (_outpos + _outsize, "CURVE", 5);
+    _outsize += 20;
+    memset (_outpos + _outsize, 0, 32);
+    _outsize += 32;
+}
+
+void zmq::zmtp_engine_t::put_first_handshake_command ()
+{
+    //  The READY command of NULL, unless it waits for a ZAP reply, and the
+    //  HELLO command of a PLAIN client only depend on our own options.
+    if (_options.mechanism == ZMQ_NULL && !session ()->zap_enabled ())
+        _mechanism = new (std::nothrow)
+          null_mechanism_t (session (), _peer_address, _options);
+    else if (_options.mechanism == ZMQ_PLAIN && !_options.as_server)
+        _mechanism = new (std::nothrow) plain_client_t (session (), _options);
+    else
+        return;
+    alloc_assert (_mechanism);
+
+    msg_t command;
+    int rc = command.init ();
+    errno_assert (rc == 0);
+    rc = _mechanism->next_handshake_command (&command);
+    errno_assert (rc == 0);
+    command.set_flags (msg_t::command);
+
+    //  Commands are encoded the same way by all the ZMTP/3.x encoders, so
+    //  the encoder picked once the peer's revision is known can take over.
+    _optimistic_send.assign (_outpos, _outpos + _outsize);
+    v3_1_encoder_t encoder (_options.out_batch_size);
+    encoder.load_msg (&command);
+    unsigned char *buffer = NULL;
+    for (size_t n; (n = encoder.encode (&buffer, 0)) > 0; buffer = NULL)
+        _optimistic_send.insert (_optimistic_send.end (), buffer, buffer + n);
+    rc = command.close ();
+    errno_assert (rc == 0);
+
+    _outpos = &_optimistic_send[0];
+    _outsize = _optimistic_send.size ();
+}
+
 zmq::zmtp_engine_t::handshake_fun_t zmq::zmtp_engine_t::select_handshake_fun (
   bool unversioned_, unsigned char revision_, unsigned char minor_)
 {
@@ -317,7 +391,16 @@ bool zmq::zmtp_engine_t::handshake_v2_0 ()
 
 bool zmq::zmtp_engine_t::handshake_v3_x (const bool downgrade_sub_)
 {
-    if (_options.mechanism == ZMQ_NULL
+    //  The optimistic handshake has set up the mechanism already.
+    if (_mechanism != NULL) {
+        if (memcmp (_greeting_recv + 12, _greeting_send + 12, 20) != 0) {
+            socket ()->event_handshake_failed_protocol (
+              session ()->get_endpoint (),
+              ZMQ_PROTOCOL_ERROR_ZMTP_MECHANISM_MISMATCH);
+            error (protocol_error);
+            return false;
+        }
+    } else if (_options.mechanism == ZMQ_NULL
         && memcmp (_greeting_recv + 12, "NULL\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0",
                    20)
              == 0) {
@@ -4,6 +4,7 @@
 #define __ZMQ_ZMTP_ENGINE_HPP_INCLUDED__
 
 #include <stddef.h>
+#include <vector>
 
 #include "fd.hpp"
 #include "i_engine.hpp"
@@ -57,6 +58,14 @@ class zmtp_engine_t ZMQ_FINAL : public stream_engine_base_t
     int receive_greeting ();
     void receive_greeting_versioned ();
 
+    //  Appends the minor version number, the mechanism and the filler
+    //  to the greeting being sent.
+    void put_greeting_v3_1 ();
+
+    //  Sets up the mechanism and appends its first command to the
+    //  greeting, if that command does not depend on the peer.
+    void put_first_handshake_command ();
+
     typedef bool (zmtp_engine_t::*handshake_fun_t) ();
     static handshake_fun_t select_handshake_fun (bool unversioned,
                                                  unsigned char revision,
@@ -95,6 +104,13 @@ class zmtp_engine_t ZMQ_FINAL : public stream_engine_base_t
     //  Size of greeting received so far
     unsigned int _greeting_bytes_read;
 
+    //  True if the whole greeting is sent without waiting for the peer.
+    bool _optimistic_handshake;
+
+    //  Greeting followed by the first handshake command, when both are
+    //  sent at once by the optimistic handshake.
+    std::vector<unsigned char> _optimistic_send;
+
     //  Indicates whether the engine is to inject a phantom
     //  subscription message into the incoming stream.
     //  Needed to support old peers.
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+#include "testutil_monitoring.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static const int peers = 32;
+
+void test_sockopt_accept_batch_size ()
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+
+    int value = 0;
+    size_t value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (router, ZMQ_ACCEPT_BATCH_SIZE, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (32, value);
+
+    value = 0;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (router, ZMQ_ACCEPT_BATCH_SIZE, &value, sizeof (value)));
+
+    value = 4;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (router, ZMQ_ACCEPT_BATCH_SIZE, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (router, ZMQ_ACCEPT_BATCH_SIZE, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (4, value);
+
+    test_context_socket_close (router);
+}
+
+static void test_connection_burst (const char *address_, int batch_size_)
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      router, ZMQ_ACCEPT_BATCH_SIZE, &batch_size_, sizeof (batch_size_)));
+
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (router, address_, endpoint, sizeof endpoint);
+
+    //  Connections pile up in the accept queue before being drained.
+    void *dealers[peers];
+    for (int i = 0; i < peers; ++i) {
+        dealers[i] = test_context_socket (ZMQ_DEALER);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealers[i], endpoint));
+        send_string_expect_success (dealers[i], "Hello", 0);
+    }
+
+    for (int i = 0; i < peers; ++i) {
+        zmq_msg_t routing_id;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&routing_id));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&routing_id, router, 0));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&routing_id));
+        recv_string_expect_success (router, "Hello", 0);
+    }
+
+    for (int i = 0; i < peers; ++i)
+        test_context_socket_close_zero_linger (dealers[i]);
+    test_context_socket_close (router);
+}
+
+void test_connection_burst_tcp_single ()
+{
+    test_connection_burst ("tcp://127.0.0.1:*", 1);
+}
+
+void test_connection_burst_tcp_batched ()
+{
+    test_connection_burst ("tcp://127.0.0.1:*", 4);
+}
+
+#if defined ZMQ_HAVE_LINUX
+//  A connection turned down by the accept filter neither ends the batch nor
+//  is reported as a failure. Linux routes all of 127.0.0.0/8 to loopback,
+//  so connecting from 127.0.0.2 makes for a peer the filter rejects.
+void test_rejected_connection_in_batch ()
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+    const char filter[] = "127.0.0.1";
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (router, ZMQ_TCP_ACCEPT_FILTER,
+                                               filter, strlen (filter)));
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (router, "tcp://127.0.0.1:*", endpoint, sizeof endpoint);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_socket_monitor (router, "inproc://monitor-accept",
+                          ZMQ_EVENT_ACCEPTED | ZMQ_EVENT_ACCEPT_FAILED));
+    void *monitor = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_connect (monitor, "inproc://monitor-accept"));
+
+    //  The rejected connection is queued first, the others right behind it.
+    void *rejected = test_context_socket (ZMQ_DEALER);
+    const int reconnect_ivl = -1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      rejected, ZMQ_RECONNECT_IVL, &reconnect_ivl, sizeof (reconnect_ivl)));
+    char rejected_endpoint[MAX_SOCKET_STRING];
+    snprintf (rejected_endpoint, sizeof rejected_endpoint,
+              "tcp://127.0.0.2:0;%s", endpoint + strlen ("tcp://"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (rejected, rejected_endpoint));
+
+    void *dealers[peers];
+    for (int i = 0; i < peers; ++i) {
+        dealers[i] = test_context_socket (ZMQ_DEALER);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealers[i], endpoint));
+        send_string_expect_success (dealers[i], "Hello", 0);
+    }
+
+    for (int i = 0; i < peers; ++i) {
+        zmq_msg_t routing_id;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&routing_id));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&routing_id, router, 0));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&routing_id));
+        recv_string_expect_success (router, "Hello", 0);
+    }
+
+    //  All but the rejected connection were accepted, and nothing failed.
+    int accepted = 0;
+    int event;
+    while ((event = get_monitor_event_with_timeout (monitor, NULL, NULL,
+                                                    SETTLE_TIME))
+           != -1) {
+        TEST_ASSERT_EQUAL_INT (ZMQ_EVENT_ACCEPTED, event);
+        accepted++;
+    }
+    TEST_ASSERT_EQUAL_INT (peers, accepted);
+
+    for (int i = 0; i < peers; ++i)
+        test_context_socket_close_zero_linger (dealers[i]);
+    test_context_socket_close_zero_linger (rejected);
+    test_context_socket_close (monitor);
+    test_context_socket_close (router);
+}
+#endif
+
+#if defined ZMQ_HAVE_IPC
+void test_connection_burst_ipc_batched ()
+{
+    test_connection_burst ("ipc://*", 4);
+}
+#endif
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_sockopt_accept_batch_size);
+    RUN_TEST (test_connection_burst_tcp_single);
+    RUN_TEST (test_connection_burst_tcp_batched);
+#if defined ZMQ_HAVE_LINUX
+    RUN_TEST (test_rejected_connection_in_batch);
+#endif
+#if defined ZMQ_HAVE_IPC
+    RUN_TEST (test_connection_burst_ipc_batched);
+#endif
+    return UNITY_END ();
+}
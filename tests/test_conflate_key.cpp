@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void set_conflate_key (void *socket_, int key_size_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      socket_, ZMQ_CONFLATE_KEY, &key_size_, sizeof (key_size_)));
+}
+
+static void recv_nothing (void *socket_)
+{
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, zmq_recv (socket_, buffer, sizeof buffer, ZMQ_DONTWAIT));
+}
+
+static int rcvmore (void *socket_)
+{
+    int more;
+    size_t more_size = sizeof (more);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket_, ZMQ_RCVMORE, &more, &more_size));
+    return more;
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PULL);
+
+    int value = -2;
+    size_t value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CONFLATE_KEY, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = -2;
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_setsockopt (socket, ZMQ_CONFLATE_KEY,
+                                                       &value, sizeof (value)));
+
+    set_conflate_key (socket, ZMQ_CONFLATE_KEY_FRAME);
+    value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CONFLATE_KEY, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (ZMQ_CONFLATE_KEY_FRAME, value);
+
+    test_context_socket_close (socket);
+}
+
+//  Of the messages sent, only the newest of each key is received, in the
+//  order the keys were first sent in.
+void test_push_pull ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_conflate_key (pull, 1);
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const char keys[] = "abc";
+    const int message_count = 30;
+    char message[8];
+    for (int i = 0; i < message_count; i++) {
+        snprintf (message, sizeof message, "%c%02d", keys[i % 3], i);
+        send_string_expect_success (push, message, 0);
+    }
+    msleep (SETTLE_TIME);
+
+    recv_string_expect_success (pull, "a27", 0);
+    recv_string_expect_success (pull, "b28", 0);
+    recv_string_expect_success (pull, "c29", 0);
+    recv_nothing (pull);
+
+    //  A key read already is queued anew.
+    send_string_expect_success (push, "b30", 0);
+    recv_string_expect_success (pull, "b30", 0);
+
+    test_context_socket_close (pull);
+    test_context_socket_close (push);
+}
+
+//  The key is the whole first frame, and the other frames of a message go
+//  along with it.
+void test_multipart ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (push, "inproc://conflate_key"));
+
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_conflate_key (pull, ZMQ_CONFLATE_KEY_FRAME);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, "inproc://conflate_key"));
+
+    char payload[8];
+    for (int i = 0; i < 10; i++) {
+        snprintf (payload, sizeof payload, "%d", i);
+        send_string_expect_success (push, i % 2 ? "xy" : "x", ZMQ_SNDMORE);
+        send_string_expect_success (push, payload, ZMQ_SNDMORE);
+        send_string_expect_success (push, "end", 0);
+    }
+
+    const char *const expected[2][2] = {{"x", "8"}, {"xy", "9"}};
+    for (int i = 0; i < 2; i++) {
+        recv_string_expect_success (pull, expected[i][0], 0);
+        TEST_ASSERT_TRUE (rcvmore (pull));
+        recv_string_expect_success (pull, expected[i][1], 0);
+        TEST_ASSERT_TRUE (rcvmore (pull));
+        recv_string_expect_success (pull, "end", 0);
+        TEST_ASSERT_FALSE (rcvmore (pull));
+    }
+    recv_nothing (pull);
+
+    test_context_socket_close (pull);
+    test_context_socket_close (push);
+}
+
+//  Subscription commands are never conflated, even when their topics share
+//  a key.
+void test_pub_sub ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+
+    void *pub = test_context_socket (ZMQ_PUB);
+    bind_loopback_ipv4 (pub, endpoint, sizeof endpoint);
+
+    void *sub = test_context_socket (ZMQ_SUB);
+    set_conflate_key (sub, 1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_SUBSCRIBE, "a1", 2));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_SUBSCRIBE, "a2", 2));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, endpoint));
+    msleep (SETTLE_TIME);
+
+    //  Both subscriptions got through.
+    send_string_expect_success (pub, "a1 first", 0);
+    msleep (SETTLE_TIME);
+    recv_string_expect_success (sub, "a1 first", 0);
+
+    send_string_expect_success (pub, "a1 dropped", 0);
+    send_string_expect_success (pub, "a3 filtered", 0);
+    send_string_expect_success (pub, "a2 second", 0);
+    msleep (SETTLE_TIME);
+    recv_string_expect_success (sub, "a2 second", 0);
+    recv_nothing (sub);
+
+    test_context_socket_close (sub);
+    test_context_socket_close (pub);
+}
+
+int main (int, char *[])
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_push_pull);
+    RUN_TEST (test_multipart);
+    RUN_TEST (test_pub_sub);
+    return UNITY_END ();
+}
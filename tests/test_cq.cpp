@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+void test_api ()
+{
+    void *cq = zmq_cq_new ();
+    TEST_ASSERT_NOT_NULL (cq);
+    void *socket = test_context_socket (ZMQ_PAIR);
+
+    TEST_ASSERT_EQUAL_INT (0, zmq_cq_size (cq));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_add (cq, socket, NULL, ZMQ_POLLIN));
+    TEST_ASSERT_EQUAL_INT (1, zmq_cq_size (cq));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_cq_add (cq, socket, NULL, ZMQ_POLLIN));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK, zmq_cq_add (cq, cq, NULL, ZMQ_POLLIN));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_cq_add (cq, socket, NULL, 0x100));
+
+    //  A socket notifies a single completion queue.
+    void *other = zmq_cq_new ();
+    TEST_ASSERT_NOT_NULL (other);
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_cq_add (other, socket, NULL, ZMQ_POLLIN));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_cq_modify (other, socket, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_cq_remove (other, socket));
+
+    zmq_poller_event_t event;
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_cq_wait (cq, &event, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EFAULT, zmq_cq_wait (other, &event, 1, -1));
+    TEST_ASSERT_FAILURE_ERRNO (EFAULT, zmq_cq_wait (cq, NULL, 1, 0));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_modify (cq, socket, ZMQ_POLLOUT));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_remove (cq, socket));
+    TEST_ASSERT_EQUAL_INT (0, zmq_cq_size (cq));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_add (other, socket, NULL, ZMQ_POLLIN));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_destroy (&cq));
+    TEST_ASSERT_NULL (cq);
+    TEST_ASSERT_FAILURE_ERRNO (EFAULT, zmq_cq_destroy (&cq));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_destroy (&other));
+
+    test_context_socket_close (socket);
+}
+
+//  More sockets than the test context keeps track of.
+static const int pair_count = 200;
+
+static void *new_socket (int type_)
+{
+    void *socket = zmq_socket (get_test_context (), type_);
+    TEST_ASSERT_NOT_NULL (socket);
+    return socket;
+}
+
+//  Only the few sockets sent to are reported, for as long as they have
+//  messages to receive.
+void test_many_sockets ()
+{
+    void *senders[pair_count];
+    void *receivers[pair_count];
+    void *cq = zmq_cq_new ();
+    TEST_ASSERT_NOT_NULL (cq);
+
+    for (int i = 0; i < pair_count; i++) {
+        char endpoint[32];
+        sprintf (endpoint, "inproc://cq-%d", i);
+        receivers[i] = new_socket (ZMQ_PAIR);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (receivers[i], endpoint));
+        senders[i] = new_socket (ZMQ_PAIR);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (senders[i], endpoint));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_cq_add (cq, receivers[i], &receivers[i], ZMQ_POLLIN));
+    }
+
+    zmq_poller_event_t events[pair_count];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_cq_wait (cq, events, pair_count, 0));
+
+    const int ready[] = {3, 42, 150};
+    for (size_t i = 0; i < sizeof ready / sizeof ready[0]; i++)
+        send_string_expect_success (senders[ready[i]], "hello", 0);
+
+    //  Waiting twice without receiving reports the same sockets.
+    for (int round = 0; round < 2; round++) {
+        const int rc = TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_cq_wait (cq, events, pair_count, 1000));
+        TEST_ASSERT_EQUAL_INT (3, rc);
+        bool seen[pair_count];
+        memset (seen, 0, sizeof seen);
+        for (int i = 0; i < rc; i++) {
+            void **receiver = static_cast<void **> (events[i].user_data);
+            TEST_ASSERT_EQUAL_PTR (*receiver, events[i].socket);
+            TEST_ASSERT_EQUAL_INT (ZMQ_POLLIN, events[i].events);
+            seen[receiver - receivers] = true;
+        }
+        for (size_t i = 0; i < sizeof ready / sizeof ready[0]; i++)
+            TEST_ASSERT_TRUE (seen[ready[i]]);
+    }
+
+    for (size_t i = 0; i < sizeof ready / sizeof ready[0]; i++)
+        recv_string_expect_success (receivers[ready[i]], "hello", 0);
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_cq_wait (cq, events, pair_count, 0));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_destroy (&cq));
+    for (int i = 0; i < pair_count; i++) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (senders[i]));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (receivers[i]));
+    }
+}
+
+//  Sockets left out because the events array was full come first next time.
+void test_partial_wait ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://cq-partial"));
+    void *cq = zmq_cq_new ();
+    TEST_ASSERT_NOT_NULL (cq);
+    void *sockets[3];
+    for (int i = 0; i < 3; i++) {
+        sockets[i] = test_context_socket (ZMQ_PUSH);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_connect (sockets[i], "inproc://cq-partial"));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_cq_add (cq, sockets[i], NULL, ZMQ_POLLOUT));
+    }
+
+    zmq_poller_event_t events[2];
+    TEST_ASSERT_EQUAL_INT (
+      2, TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_wait (cq, events, 2, 1000)));
+    TEST_ASSERT_EQUAL_PTR (sockets[0], events[0].socket);
+    TEST_ASSERT_EQUAL_PTR (sockets[1], events[1].socket);
+    TEST_ASSERT_EQUAL_INT (ZMQ_POLLOUT, events[0].events);
+
+    TEST_ASSERT_EQUAL_INT (
+      2, TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_wait (cq, events, 2, 1000)));
+    TEST_ASSERT_EQUAL_PTR (sockets[2], events[0].socket);
+    TEST_ASSERT_EQUAL_PTR (sockets[0], events[1].socket);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_destroy (&cq));
+    for (int i = 0; i < 3; i++)
+        test_context_socket_close (sockets[i]);
+    test_context_socket_close (pull);
+}
+
+static void send_later (void *socket_)
+{
+    msleep (SETTLE_TIME);
+    send_string_expect_success (socket_, "hello", 0);
+}
+
+//  A blocked wait wakes up when another thread sends to a socket.
+static void test_wakeup (const char *address_)
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (pull, address_, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    void *cq = zmq_cq_new ();
+    TEST_ASSERT_NOT_NULL (cq);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_add (cq, pull, NULL, ZMQ_POLLIN));
+
+    for (int i = 0; i < 3; i++) {
+        void *thread = zmq_threadstart (send_later, push);
+        zmq_poller_event_t event;
+        TEST_ASSERT_EQUAL_INT (
+          1, TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_wait (cq, &event, 1, -1)));
+        TEST_ASSERT_EQUAL_PTR (pull, event.socket);
+        recv_string_expect_success (pull, "hello", 0);
+        zmq_threadclose (thread);
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_remove (cq, pull));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_destroy (&cq));
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_wakeup_inproc ()
+{
+    test_wakeup ("inproc://cq-wakeup");
+}
+
+void test_wakeup_tcp ()
+{
+    test_wakeup ("tcp://127.0.0.1:*");
+}
+
+void test_timeout ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *cq = zmq_cq_new ();
+    TEST_ASSERT_NOT_NULL (cq);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_add (cq, pull, NULL, ZMQ_POLLIN));
+
+    void *watch = zmq_stopwatch_start ();
+    zmq_poller_event_t event;
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_cq_wait (cq, &event, 1, 100));
+    const unsigned long elapsed = zmq_stopwatch_stop (watch);
+    TEST_ASSERT_GREATER_OR_EQUAL (90 * 1000, elapsed);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_cq_destroy (&cq));
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_api);
+    RUN_TEST (test_many_sockets);
+    RUN_TEST (test_partial_wait);
+    RUN_TEST (test_wakeup_inproc);
+    RUN_TEST (test_wakeup_tcp);
+    RUN_TEST (test_timeout);
+    return UNITY_END ();
+}
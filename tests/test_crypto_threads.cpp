@@ -0,0 +1,271 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+static const int crypto_threads = 2;
+static const int msg_count = 2000;
+static const size_t max_msg_size = 4096;
+
+void setUp ()
+{
+    setup_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_CRYPTO_THREADS, crypto_threads));
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+void test_ctx_option ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (ctx, ZMQ_CRYPTO_THREADS));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_ctx_set (ctx, ZMQ_CRYPTO_THREADS, -1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_CRYPTO_THREADS, 4));
+    TEST_ASSERT_EQUAL_INT (4, zmq_ctx_get (ctx, ZMQ_CRYPTO_THREADS));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+//  Message i carries its sequence number followed by a pattern, and its
+//  size varies so that batches mix small and large messages.
+static size_t msg_size (int seq_)
+{
+    return sizeof (int) + (seq_ * 61) % (max_msg_size - sizeof (int));
+}
+
+static void send_seq (void *socket_, int seq_)
+{
+    char buffer[max_msg_size];
+    const size_t size = msg_size (seq_);
+    memcpy (buffer, &seq_, sizeof (seq_));
+    memset (buffer + sizeof (seq_), 'a' + seq_ % 26, size - sizeof (seq_));
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_send (socket_, buffer, size, ZMQ_DONTWAIT)));
+}
+
+static bool recv_seq (void *socket_, int seq_, int flags_)
+{
+    char buffer[max_msg_size];
+    const int rc = zmq_recv (socket_, buffer, sizeof buffer, flags_);
+    if (rc == -1 && zmq_errno () == EAGAIN)
+        return false;
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (msg_size (seq_)),
+                           TEST_ASSERT_SUCCESS_ERRNO (rc));
+
+    int seq;
+    memcpy (&seq, buffer, sizeof (seq));
+    TEST_ASSERT_EQUAL_INT (seq_, seq);
+    for (int i = sizeof (seq); i < rc; i++)
+        TEST_ASSERT_EQUAL_INT ('a' + seq_ % 26, buffer[i]);
+    return true;
+}
+
+//  Both peers send and receive bursts at once, so that messages are
+//  encoded and decoded in batches on both sides.
+static void test_bursts (void *bound_, void *connected_)
+{
+    //  The bound socket has nowhere to send to before the connection is up.
+    send_string_expect_success (connected_, "hello", 0);
+    recv_string_expect_success (bound_, "hello", 0);
+
+    int sent = 0;
+    int received[2] = {0, 0};
+    void *sockets[2] = {bound_, connected_};
+    while (received[0] < msg_count || received[1] < msg_count) {
+        //  Keep the messages in flight well below the high water marks.
+        const bool can_send = sent < msg_count && sent - received[0] < 200
+                              && sent - received[1] < 200;
+        for (int burst = 0; can_send && burst < 100 && sent < msg_count;
+             burst++, sent++) {
+            send_seq (bound_, sent);
+            send_seq (connected_, sent);
+        }
+        for (int i = 0; i < 2; i++) {
+            const int flags = can_send ? ZMQ_DONTWAIT : 0;
+            while (received[i] < sent
+                   && recv_seq (sockets[i], received[i], flags))
+                received[i]++;
+        }
+    }
+}
+
+static void test_null (const char *address_)
+{
+    void *bound = test_context_socket (ZMQ_DEALER);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (bound, address_, endpoint, sizeof endpoint);
+    void *connected = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (connected, endpoint));
+
+    test_bursts (bound, connected);
+
+    test_context_socket_close_zero_linger (connected);
+    test_context_socket_close_zero_linger (bound);
+}
+
+void test_null_tcp ()
+{
+    test_null ("tcp://127.0.0.1:*");
+}
+
+#if defined ZMQ_HAVE_IPC
+void test_null_ipc ()
+{
+    test_null ("ipc://*");
+}
+#endif
+
+//  With a tiny receive high water mark, the receiving engine keeps running
+//  into a full pipe in the middle of a batch.
+void test_flow_control ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    const int hwm = 5;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof (hwm)));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    const int unlimited = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_SNDHWM, &unlimited, sizeof (unlimited)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    for (int i = 0; i < msg_count; i++)
+        send_seq (push, i);
+
+    //  Let the data pile up in the receiving engine before draining it.
+    msleep (SETTLE_TIME);
+    for (int i = 0; i < msg_count; i++)
+        TEST_ASSERT_TRUE (recv_seq (pull, i, 0));
+
+    test_context_socket_close_zero_linger (push);
+    test_context_socket_close_zero_linger (pull);
+}
+
+void test_curve ()
+{
+#if defined ZMQ_HAVE_CURVE
+    char server_public[41];
+    char server_secret[41];
+    char client_public[41];
+    char client_secret[41];
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_curve_keypair (server_public, server_secret));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_curve_keypair (client_public, client_secret));
+
+    void *server = test_context_socket (ZMQ_DEALER);
+    const int as_server = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_SERVER, &as_server, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_SECRETKEY, server_secret, 41));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+
+    void *client = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_SERVERKEY, server_public, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_PUBLICKEY, client_public, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_SECRETKEY, client_secret, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+
+    test_bursts (server, client);
+
+    test_context_socket_close_zero_linger (client);
+    test_context_socket_close_zero_linger (server);
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without CURVE support, ignoring test");
+#endif
+}
+
+//  Many clients handshake at once, one of them with the wrong server key,
+//  so that the handshake steps of several connections are in flight on the
+//  crypto threads together.
+void test_curve_handshakes ()
+{
+#if defined ZMQ_HAVE_CURVE
+    char server_public[41];
+    char server_secret[41];
+    char client_public[41];
+    char client_secret[41];
+    char wrong_public[41];
+    char wrong_secret[41];
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_curve_keypair (server_public, server_secret));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_curve_keypair (client_public, client_secret));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_curve_keypair (wrong_public, wrong_secret));
+
+    void *server = test_context_socket (ZMQ_PULL);
+    const int as_server = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_SERVER, &as_server, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_SECRETKEY, server_secret, 41));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+
+    const int client_count = 32;
+    void *clients[client_count];
+    for (int i = 0; i < client_count; i++) {
+        clients[i] = test_context_socket (ZMQ_PUSH);
+        const char *const server_key = i == 0 ? wrong_public : server_public;
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_setsockopt (clients[i], ZMQ_CURVE_SERVERKEY, server_key, 41));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_setsockopt (clients[i], ZMQ_CURVE_PUBLICKEY, client_public, 41));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_setsockopt (clients[i], ZMQ_CURVE_SECRETKEY, client_secret, 41));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (clients[i], endpoint));
+        send_string_expect_success (clients[i], "hello", 0);
+    }
+
+    //  Everyone but the client with the wrong key gets through.
+    for (int i = 1; i < client_count; i++)
+        recv_string_expect_success (server, "hello", 0);
+
+    const int timeout = 250;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_RCVTIMEO, &timeout, sizeof (int)));
+    char buffer[32];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recv (server, buffer, sizeof buffer, 0));
+
+    for (int i = 0; i < client_count; i++)
+        test_context_socket_close_zero_linger (clients[i]);
+    test_context_socket_close_zero_linger (server);
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without CURVE support, ignoring test");
+#endif
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_ctx_option);
+    RUN_TEST (test_null_tcp);
+#if defined ZMQ_HAVE_IPC
+    RUN_TEST (test_null_ipc);
+#endif
+    RUN_TEST (test_flow_control);
+    RUN_TEST (test_curve);
+    RUN_TEST (test_curve_handshakes);
+    return UNITY_END ();
+}
@@ -0,0 +1,211 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_DEALER);
+    int value = -1;
+    size_t value_size = sizeof value;
+#if defined ZMQ_HAVE_CURVE
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CURVE_AEAD, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = ZMQ_CURVE_AEAD_CHACHA20POLY1305;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_CURVE_AEAD, &value, sizeof value));
+    value = -1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CURVE_AEAD, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (ZMQ_CURVE_AEAD_CHACHA20POLY1305, value);
+
+    value = 3;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_CURVE_AEAD, &value, sizeof value));
+#else
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_getsockopt (socket, ZMQ_CURVE_AEAD, &value, &value_size));
+#endif
+    test_context_socket_close (socket);
+}
+
+#if defined ZMQ_HAVE_CURVE
+static const size_t large_size = 4096;
+
+//  Sends a small message, a large one, and a large one shared with
+//  another message, so that each way of encrypting gets used.
+static void send_messages (void *socket_)
+{
+    send_string_expect_success (socket_, "hello", ZMQ_SNDMORE);
+
+    char buffer[large_size];
+    memset (buffer, 'x', sizeof buffer);
+    TEST_ASSERT_EQUAL_INT (
+      static_cast<int> (large_size),
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_send (socket_, buffer, large_size, 0)));
+
+    zmq_msg_t msg;
+    zmq_msg_t copy;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, large_size));
+    memset (zmq_msg_data (&msg), 'y', large_size);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&copy));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_copy (&copy, &msg));
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (large_size),
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_msg_send (&msg, socket_, 0)));
+    TEST_ASSERT_EACH_EQUAL_UINT8 ('y', zmq_msg_data (&copy), large_size);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&copy));
+}
+
+//  Receives the messages of send_messages, returning the Cipher property
+//  of the last one, or NULL if there is none.
+static const char *recv_messages (void *socket_, zmq_msg_t *msg_)
+{
+    recv_string_expect_success (socket_, "hello", 0);
+
+    const char fills[] = {'x', 'y'};
+    for (size_t i = 0; i < sizeof fills; i++) {
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (large_size),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_msg_recv (msg_, socket_, 0)));
+        TEST_ASSERT_EACH_EQUAL_UINT8 (fills[i], zmq_msg_data (msg_),
+                                      large_size);
+    }
+    return zmq_msg_gets (msg_, "Cipher");
+}
+
+//  Connects a client preferring client_aead_ to a server preferring
+//  server_aead_, bounces messages, and returns the cipher the client got
+//  told of.
+static const char *negotiate (int server_aead_,
+                              int client_aead_,
+                              zmq_msg_t *msg_)
+{
+    char server_public[41];
+    char server_secret[41];
+    char client_public[41];
+    char client_secret[41];
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_curve_keypair (server_public, server_secret));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_curve_keypair (client_public, client_secret));
+
+    void *server = test_context_socket (ZMQ_DEALER);
+    const int as_server = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_SERVER, &as_server, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_SECRETKEY, server_secret, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_CURVE_AEAD, &server_aead_, sizeof (int)));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+
+    void *client = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_SERVERKEY, server_public, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_PUBLICKEY, client_public, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_SECRETKEY, client_secret, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_AEAD, &client_aead_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+
+    send_messages (client);
+    recv_messages (server, msg_);
+    send_messages (server);
+    const char *cipher = recv_messages (client, msg_);
+
+    test_context_socket_close_zero_linger (client);
+    test_context_socket_close_zero_linger (server);
+    return cipher;
+}
+
+//  AES-256-GCM is left out on CPUs without AES instructions.
+static bool aes_or_chacha (const char *cipher_)
+{
+    return cipher_ != NULL
+           && (strcmp (cipher_, "AES-256-GCM") == 0
+               || strcmp (cipher_, "ChaCha20-Poly1305") == 0);
+}
+#endif
+
+void test_chacha20poly1305 ()
+{
+#if defined ZMQ_HAVE_CURVE
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_STRING ("ChaCha20-Poly1305",
+                              negotiate (ZMQ_CURVE_AEAD_CHACHA20POLY1305,
+                                         ZMQ_CURVE_AEAD_CHACHA20POLY1305,
+                                         &msg));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without CURVE support, ignoring test");
+#endif
+}
+
+void test_aes256gcm ()
+{
+#if defined ZMQ_HAVE_CURVE
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_TRUE (aes_or_chacha (negotiate (
+      ZMQ_CURVE_AEAD_AES256GCM, ZMQ_CURVE_AEAD_AES256GCM, &msg)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without CURVE support, ignoring test");
+#endif
+}
+
+//  The server's preference wins over the client's.
+void test_server_preference ()
+{
+#if defined ZMQ_HAVE_CURVE
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_STRING ("ChaCha20-Poly1305",
+                              negotiate (ZMQ_CURVE_AEAD_CHACHA20POLY1305,
+                                         ZMQ_CURVE_AEAD_AES256GCM, &msg));
+    TEST_ASSERT_TRUE (aes_or_chacha (negotiate (
+      ZMQ_CURVE_AEAD_AES256GCM, ZMQ_CURVE_AEAD_CHACHA20POLY1305, &msg)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without CURVE support, ignoring test");
+#endif
+}
+
+//  Unless both peers want an AEAD cipher, CURVE's own is kept.
+void test_fallback ()
+{
+#if defined ZMQ_HAVE_CURVE
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_NULL (negotiate (0, ZMQ_CURVE_AEAD_AES256GCM, &msg));
+    TEST_ASSERT_NULL (negotiate (ZMQ_CURVE_AEAD_CHACHA20POLY1305, 0, &msg));
+    TEST_ASSERT_NULL (negotiate (0, 0, &msg));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without CURVE support, ignoring test");
+#endif
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_chacha20poly1305);
+    RUN_TEST (test_aes256gcm);
+    RUN_TEST (test_server_preference);
+    RUN_TEST (test_fallback);
+    return UNITY_END ();
+}
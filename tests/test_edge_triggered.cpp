@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_monitoring.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp ()
+{
+    setup_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_EDGE_TRIGGERED, 1));
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+void test_ctx_option ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (ctx, ZMQ_EDGE_TRIGGERED));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_ctx_set (ctx, ZMQ_EDGE_TRIGGERED, -1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_EDGE_TRIGGERED, 1));
+    TEST_ASSERT_EQUAL_INT (1, zmq_ctx_get (ctx, ZMQ_EDGE_TRIGGERED));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+//  Each round trip stops and resumes polling for output on both sides.
+static void test_round_trips (const char *address_)
+{
+    void *rep = test_context_socket (ZMQ_REP);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (rep, address_, endpoint, sizeof endpoint);
+    void *req = test_context_socket (ZMQ_REQ);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, endpoint));
+
+    for (int i = 0; i < 1000; i++) {
+        send_string_expect_success (req, "ping", 0);
+        recv_string_expect_success (rep, "ping", 0);
+        send_string_expect_success (rep, "pong", 0);
+        recv_string_expect_success (req, "pong", 0);
+    }
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_round_trips_tcp ()
+{
+    test_round_trips ("tcp://127.0.0.1:*");
+}
+
+#if defined ZMQ_HAVE_IPC
+void test_round_trips_ipc ()
+{
+    test_round_trips ("ipc://*");
+}
+#endif
+
+//  Messages larger than the socket buffers are written and read in several
+//  goes, each ending with the socket about to block.
+void test_large_messages ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const size_t size = 4 * 1024 * 1024;
+    char *sent = static_cast<char *> (malloc (size));
+    char *received = static_cast<char *> (malloc (size));
+    TEST_ASSERT_NOT_NULL (sent);
+    TEST_ASSERT_NOT_NULL (received);
+
+    for (int i = 0; i < 4; i++) {
+        memset (sent, 'a' + i, size);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, sent, size, 0)));
+    }
+    for (int i = 0; i < 4; i++) {
+        memset (sent, 'a' + i, size);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pull, received, size, 0)));
+        TEST_ASSERT_EQUAL_MEMORY (sent, received, size);
+    }
+
+    free (received);
+    free (sent);
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+//  With a tiny receive high water mark, the receiving engine keeps stopping
+//  and resuming input with data left in the socket, for which epoll reports
+//  no new edge.
+void test_flow_control ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    const int hwm = 5;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof (hwm)));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    const int unlimited = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_SNDHWM, &unlimited, sizeof (unlimited)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const int msg_count = 10000;
+    for (int i = 0; i < msg_count; i++)
+        TEST_ASSERT_EQUAL_INT (sizeof (i), TEST_ASSERT_SUCCESS_ERRNO (zmq_send (
+                                             push, &i, sizeof (i), 0)));
+
+    //  Let the data pile up in the receiving engine before draining it.
+    msleep (SETTLE_TIME);
+    for (int i = 0; i < msg_count; i++) {
+        int value;
+        TEST_ASSERT_EQUAL_INT (sizeof (value),
+                               TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (
+                                 pull, &value, sizeof (value), 0)));
+        TEST_ASSERT_EQUAL_INT (i, value);
+    }
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+//  The peer going away is reported as an error by epoll.
+void test_disconnect ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *mon = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor (
+      pull, "inproc://monitor-edge-triggered", ZMQ_EVENT_DISCONNECTED));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_connect (mon, "inproc://monitor-edge-triggered"));
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+    send_string_expect_success (push, "hello", 0);
+    recv_string_expect_success (pull, "hello", 0);
+    test_context_socket_close (push);
+
+    expect_monitor_event (mon, ZMQ_EVENT_DISCONNECTED);
+
+    test_context_socket_close (mon);
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_ctx_option);
+    RUN_TEST (test_round_trips_tcp);
+#if defined ZMQ_HAVE_IPC
+    RUN_TEST (test_round_trips_ipc);
+#endif
+    RUN_TEST (test_large_messages);
+    RUN_TEST (test_flow_control);
+    RUN_TEST (test_disconnect);
+    return UNITY_END ();
+}
@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+//  Small enough for most reads and writes to stop at the budget.
+static const int budget = 1000;
+
+static void set_budget (void *socket_, int budget_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_IO_BUDGET, &budget_, sizeof (budget_)));
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PUSH);
+
+    int value = -1;
+    size_t value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_IO_BUDGET, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_IO_BUDGET, &value, sizeof (value)));
+
+    set_budget (socket, budget);
+    value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_IO_BUDGET, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (budget, value);
+
+    test_context_socket_close (socket);
+}
+
+//  Each message takes many turns of both I/O threads to get through.
+static void test_large_messages (const char *address_)
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_budget (pull, budget);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (pull, address_, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_budget (push, budget);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const size_t size = 1024 * 1024;
+    char *sent = static_cast<char *> (malloc (size));
+    char *received = static_cast<char *> (malloc (size));
+    TEST_ASSERT_NOT_NULL (sent);
+    TEST_ASSERT_NOT_NULL (received);
+
+    for (int i = 0; i < 4; i++) {
+        memset (sent, 'a' + i, size);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, sent, size, 0)));
+    }
+    for (int i = 0; i < 4; i++) {
+        memset (sent, 'a' + i, size);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pull, received, size, 0)));
+        TEST_ASSERT_EQUAL_MEMORY (sent, received, size);
+    }
+
+    free (received);
+    free (sent);
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_large_messages_tcp ()
+{
+    test_large_messages ("tcp://127.0.0.1:*");
+}
+
+#if defined ZMQ_HAVE_IPC
+void test_large_messages_ipc ()
+{
+    test_large_messages ("ipc://*");
+}
+#endif
+
+//  Messages straddle the budget boundaries at varying offsets.
+void test_small_messages ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_budget (pull, budget);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_budget (push, budget);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const int msg_count = 10000;
+    char buffer[64];
+    for (int i = 0; i < msg_count; i++) {
+        const size_t size = 4 + i % 60;
+        memset (buffer, i, size);
+        memcpy (buffer, &i, sizeof (i));
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, buffer, size, 0)));
+    }
+    for (int i = 0; i < msg_count; i++) {
+        const size_t size = 4 + i % 60;
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_recv (pull, buffer, sizeof buffer, 0)));
+        int value;
+        memcpy (&value, buffer, sizeof (value));
+        TEST_ASSERT_EQUAL_INT (i, value);
+    }
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+//  With edge-triggered polling, a connection that stopped at its budget
+//  gets no new edge for the data it left in the socket.
+void test_edge_triggered ()
+{
+    teardown_test_context ();
+    setup_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_EDGE_TRIGGERED, 1));
+
+    test_large_messages ("tcp://127.0.0.1:*");
+    test_small_messages ();
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_large_messages_tcp);
+#if defined ZMQ_HAVE_IPC
+    RUN_TEST (test_large_messages_ipc);
+#endif
+    RUN_TEST (test_small_messages);
+    RUN_TEST (test_edge_triggered);
+    return UNITY_END ();
+}
@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+static const int io_threads = 2;
+static const int rebalance_ivl = 10;
+static const int peers = 4;
+static const int heavy_peers = 2;
+static const int rounds = 4000;
+//  How long to keep the traffic skewed for, in microseconds, if no session
+//  has been moved after all the rounds.
+static const unsigned long migration_timeout = 5000000;
+static const size_t msg_size = 512;
+
+void setUp ()
+{
+    setup_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_THREADS, io_threads));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (
+      get_test_context (), ZMQ_IO_THREAD_REBALANCE_IVL, rebalance_ivl));
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+void test_ctx_option ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (ctx, ZMQ_IO_THREAD_REBALANCE_IVL));
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_ctx_set (ctx, ZMQ_IO_THREAD_REBALANCE_IVL, -1));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (ctx, ZMQ_IO_THREAD_REBALANCE_IVL, 100));
+    TEST_ASSERT_EQUAL_INT (100,
+                           zmq_ctx_get (ctx, ZMQ_IO_THREAD_REBALANCE_IVL));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+//  Returns the number of sessions moved between the I/O threads so far.
+static uint64_t migrations ()
+{
+    zmq_io_thread_stats_t stats[io_threads];
+    size_t size = sizeof stats;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_get_ext (
+      get_test_context (), ZMQ_IO_THREAD_STATS, stats, &size));
+
+    uint64_t total = 0;
+    for (int i = 0; i < io_threads; ++i)
+        total += stats[i].migrations;
+    return total;
+}
+
+//  Returns true once a session has been moved between the I/O threads, or
+//  once the time to wait for one, as measured by watch_, is up.
+static bool migrated_or_timed_out (void *watch_)
+{
+    return migrations () > 0
+           || zmq_stopwatch_intermediate (watch_) >= migration_timeout;
+}
+
+//  Receives one message and checks it is the next one from its peer.
+//  Returns false if there is no message available.
+static bool recv_in_order (void *router_, int *received_, int flags_)
+{
+    char routing_id;
+    const int rc =
+      zmq_recv (router_, &routing_id, sizeof (routing_id), flags_);
+    if (rc == -1 && zmq_errno () == EAGAIN)
+        return false;
+    TEST_ASSERT_EQUAL_INT (sizeof (routing_id), TEST_ASSERT_SUCCESS_ERRNO (rc));
+
+    char buffer[msg_size];
+    TEST_ASSERT_EQUAL_INT (
+      static_cast<int> (msg_size),
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (router_, buffer, sizeof buffer, 0)));
+    int seq;
+    memcpy (&seq, buffer, sizeof (seq));
+    TEST_ASSERT_EQUAL_INT (received_[routing_id - 'A'], seq);
+    received_[routing_id - 'A']++;
+    return true;
+}
+
+static void test_skewed_traffic (const char *address_)
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (router, address_, endpoint, sizeof endpoint);
+
+    void *dealers[peers];
+    for (int i = 0; i < peers; ++i) {
+        dealers[i] = test_context_socket (ZMQ_DEALER);
+        const char routing_id = 'A' + i;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+          dealers[i], ZMQ_ROUTING_ID, &routing_id, sizeof (routing_id)));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealers[i], endpoint));
+    }
+
+    //  Heavy peers send every round, the others only every tenth round.
+    //  Sessions may be moved between the I/O threads meanwhile; messages
+    //  must neither be lost nor reordered. The rounds go on until some
+    //  session has been moved, as the rebalancing timer may be late on a
+    //  loaded machine.
+    int sent[peers];
+    int received[peers];
+    for (int i = 0; i < peers; ++i) {
+        sent[i] = 0;
+        received[i] = 0;
+    }
+    int total = 0;
+
+    char buffer[msg_size];
+    memset (buffer, 0, sizeof buffer);
+    void *watch = zmq_stopwatch_start ();
+    for (int round = 0; round < rounds || !migrated_or_timed_out (watch);
+         ++round) {
+        for (int i = 0; i < peers; ++i) {
+            if (i >= heavy_peers && round % 10 != 0)
+                continue;
+            memcpy (buffer, &sent[i], sizeof (sent[i]));
+            TEST_ASSERT_EQUAL_INT (
+              static_cast<int> (msg_size),
+              TEST_ASSERT_SUCCESS_ERRNO (
+                zmq_send (dealers[i], buffer, msg_size, 0)));
+            sent[i]++;
+            total++;
+        }
+
+        //  Keep the queues short so that traffic keeps flowing while the
+        //  I/O threads rebalance.
+        while (total > 0 && recv_in_order (router, received, ZMQ_DONTWAIT))
+            total--;
+    }
+    zmq_stopwatch_stop (watch);
+
+    //  The skew was large enough for at least one session to be moved.
+    TEST_ASSERT_TRUE (migrations () > 0);
+
+    while (total > 0 && recv_in_order (router, received, 0))
+        total--;
+    TEST_ASSERT_EQUAL_INT (0, total);
+
+    //  Whichever I/O thread the sessions ended up in, they still work
+    //  in both directions.
+    for (int i = 0; i < peers; ++i) {
+        TEST_ASSERT_EQUAL_INT (sent[i], received[i]);
+        const char routing_id = 'A' + i;
+        TEST_ASSERT_EQUAL_INT (
+          sizeof (routing_id),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (
+            router, &routing_id, sizeof (routing_id), ZMQ_SNDMORE)));
+        send_string_expect_success (router, "done", 0);
+        recv_string_expect_success (dealers[i], "done", 0);
+    }
+
+    for (int i = 0; i < peers; ++i)
+        test_context_socket_close_zero_linger (dealers[i]);
+    test_context_socket_close_zero_linger (router);
+}
+
+void test_skewed_traffic_tcp ()
+{
+    test_skewed_traffic ("tcp://127.0.0.1:*");
+}
+
+#if defined ZMQ_HAVE_IPC
+void test_skewed_traffic_ipc ()
+{
+    test_skewed_traffic ("ipc://*");
+}
+#endif
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_ctx_option);
+    RUN_TEST (test_skewed_traffic_tcp);
+#if defined ZMQ_HAVE_IPC
+    RUN_TEST (test_skewed_traffic_ipc);
+#endif
+    return UNITY_END ();
+}
@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static const int io_threads = 2;
+
+static void get_stats (void *ctx_, zmq_io_thread_stats_t *stats_)
+{
+    size_t size = io_threads * sizeof (zmq_io_thread_stats_t);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_get_ext (ctx_, ZMQ_IO_THREAD_STATS, stats_, &size));
+}
+
+//  Adds up the statistics of all the I/O threads. The context may have
+//  fewer than the buffer has room for.
+static void get_total (void *ctx_, zmq_io_thread_stats_t *total_)
+{
+    zmq_io_thread_stats_t stats[io_threads];
+    memset (stats, 0, sizeof stats);
+    get_stats (ctx_, stats);
+
+    memset (total_, 0, sizeof *total_);
+    for (int i = 0; i < io_threads; i++) {
+        total_->busy_time += stats[i].busy_time;
+        total_->idle_time += stats[i].idle_time;
+        total_->events += stats[i].events;
+        total_->commands += stats[i].commands;
+        total_->timers += stats[i].timers;
+        total_->bytes_read += stats[i].bytes_read;
+        total_->bytes_written += stats[i].bytes_written;
+    }
+}
+
+void test_before_start ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_IO_THREADS, io_threads));
+
+    zmq_io_thread_stats_t stats[io_threads];
+    memset (stats, 0xff, sizeof stats);
+    get_stats (ctx, stats);
+    for (int i = 0; i < io_threads; i++) {
+        TEST_ASSERT_TRUE (stats[i].busy_time == 0);
+        TEST_ASSERT_TRUE (stats[i].idle_time == 0);
+        TEST_ASSERT_TRUE (stats[i].events == 0);
+        TEST_ASSERT_TRUE (stats[i].bytes_read == 0);
+    }
+
+    //  The buffer must have room for all the I/O threads.
+    size_t size = sizeof (zmq_io_thread_stats_t);
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_ctx_get_ext (ctx, ZMQ_IO_THREAD_STATS, stats, &size));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+void test_traffic ()
+{
+    void *ctx = get_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_IO_THREADS, io_threads));
+
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    zmq_io_thread_stats_t before;
+    get_total (ctx, &before);
+
+    const int msg_count = 100;
+    const size_t msg_size = 1000;
+    char buffer[msg_size];
+    memset (buffer, 'x', msg_size);
+    for (int i = 0; i < msg_count; i++)
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (msg_size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, buffer, msg_size, 0)));
+    for (int i = 0; i < msg_count; i++)
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (msg_size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pull, buffer, msg_size, 0)));
+
+    //  Let the I/O threads go back to waiting, which publishes the counters.
+    msleep (SETTLE_TIME);
+
+    zmq_io_thread_stats_t after;
+    get_total (ctx, &after);
+
+    TEST_ASSERT_TRUE (after.busy_time >= before.busy_time);
+    TEST_ASSERT_TRUE (after.idle_time > before.idle_time);
+    TEST_ASSERT_TRUE (after.events > before.events);
+    TEST_ASSERT_TRUE (after.commands > before.commands);
+    TEST_ASSERT_TRUE (after.bytes_read
+                      >= before.bytes_read + msg_count * msg_size);
+    TEST_ASSERT_TRUE (after.bytes_written
+                      >= before.bytes_written + msg_count * msg_size);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_timers ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    const int heartbeat_ivl = 10;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      pull, ZMQ_HEARTBEAT_IVL, &heartbeat_ivl, sizeof (heartbeat_ivl)));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_string_expect_success (push, "hello", 0);
+    recv_string_expect_success (pull, "hello", 0);
+
+    zmq_io_thread_stats_t before;
+    get_total (get_test_context (), &before);
+
+    //  Heartbeats keep firing timers.
+    msleep (SETTLE_TIME);
+
+    zmq_io_thread_stats_t after;
+    get_total (get_test_context (), &after);
+    TEST_ASSERT_TRUE (after.timers > before.timers);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_before_start);
+    RUN_TEST (test_traffic);
+    RUN_TEST (test_timers);
+    return UNITY_END ();
+}
@@ -7,11 +7,16 @@
 #include <stdlib.h>
 #include <vector>
 
+#if !defined ZMQ_HAVE_WINDOWS
+#include <sys/resource.h>
+#endif
+
 SETUP_TEARDOWN_TESTCONTEXT
 
 void test_system_max ()
 {
-    // Keep allocating sockets until we run out of system resources
+    // Keep allocating sockets until we hit the limit or run out of system
+    // resources
     const int no_of_sockets = 2 * 65536;
     zmq_ctx_set (get_test_context (), ZMQ_MAX_SOCKETS, no_of_sockets);
     std::vector<void *> sockets;
@@ -27,7 +32,7 @@ void test_system_max ()
     printf ("Socket creation failed after %i sockets\n",
             static_cast<int> (sockets.size ()));
 
-    //  System is out of resources, further calls to zmq_socket should return NULL
+    //  Further calls to zmq_socket should return NULL
     for (unsigned int i = 0; i < 10; ++i) {
         TEST_ASSERT_NULL (zmq_socket (get_test_context (), ZMQ_PAIR));
     }
@@ -60,6 +65,77 @@ void test_zmq_default_max ()
         TEST_ASSERT_SUCCESS_ERRNO (zmq_close (sockets[i]));
 }
 
+#if !defined ZMQ_HAVE_WINDOWS
+//  Sockets take a file descriptor only once they need one, so many more of
+//  them can be open than the process may open files.
+void test_fd_limit ()
+{
+    struct rlimit saved;
+    TEST_ASSERT_SUCCESS_RAW_ERRNO (getrlimit (RLIMIT_NOFILE, &saved));
+    struct rlimit limit = saved;
+    limit.rlim_cur = 64;
+    TEST_ASSERT_SUCCESS_RAW_ERRNO (setrlimit (RLIMIT_NOFILE, &limit));
+
+    const int no_of_sockets = 1000;
+    std::vector<void *> sockets;
+    for (int i = 0; i < no_of_sockets; ++i) {
+        void *socket = zmq_socket (get_test_context (), ZMQ_PAIR);
+        TEST_ASSERT_NOT_NULL (socket);
+        sockets.push_back (socket);
+    }
+
+    //  Asking each of them for its file descriptor runs out of them.
+    int i;
+    for (i = 0; i < no_of_sockets; ++i) {
+        fd_t fd;
+        size_t fd_size = sizeof fd;
+        if (zmq_getsockopt (sockets[i], ZMQ_FD, &fd, &fd_size) != 0)
+            break;
+    }
+    TEST_ASSERT_LESS_THAN_INT (no_of_sockets, i);
+    TEST_ASSERT_EQUAL_INT (EMFILE, errno);
+
+    TEST_ASSERT_SUCCESS_RAW_ERRNO (setrlimit (RLIMIT_NOFILE, &saved));
+    for (unsigned int j = 0; j < sockets.size (); ++j)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (sockets[j]));
+}
+
+//  A closed socket that cannot terminate straight away gets reaped even if
+//  no file descriptor can be had to wait for its peer.
+void test_close_at_fd_limit ()
+{
+    const int no_of_pairs = 200;
+    std::vector<void *> bound;
+    std::vector<void *> connected;
+    for (int i = 0; i < no_of_pairs; ++i) {
+        char endpoint[32];
+        snprintf (endpoint, sizeof endpoint, "inproc://fd_limit_%d", i);
+        bound.push_back (zmq_socket (get_test_context (), ZMQ_PAIR));
+        TEST_ASSERT_NOT_NULL (bound.back ());
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (bound.back (), endpoint));
+        connected.push_back (zmq_socket (get_test_context (), ZMQ_PAIR));
+        TEST_ASSERT_NOT_NULL (connected.back ());
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (connected.back (), endpoint));
+    }
+
+    struct rlimit saved;
+    TEST_ASSERT_SUCCESS_RAW_ERRNO (getrlimit (RLIMIT_NOFILE, &saved));
+    struct rlimit limit = saved;
+    limit.rlim_cur = 64;
+    TEST_ASSERT_SUCCESS_RAW_ERRNO (setrlimit (RLIMIT_NOFILE, &limit));
+
+    //  Each of them waits for its peer to acknowledge the termination of
+    //  their pipe, and the reaper runs out of file descriptors to wait with.
+    for (int i = 0; i < no_of_pairs; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (bound[i]));
+    msleep (SETTLE_TIME);
+
+    TEST_ASSERT_SUCCESS_RAW_ERRNO (setrlimit (RLIMIT_NOFILE, &saved));
+    for (int i = 0; i < no_of_pairs; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (connected[i]));
+}
+#endif
+
 int main (void)
 {
     setup_test_environment ();
@@ -67,5 +143,9 @@ int main (void)
     UNITY_BEGIN ();
     RUN_TEST (test_system_max);
     RUN_TEST (test_zmq_default_max);
+#if !defined ZMQ_HAVE_WINDOWS
+    RUN_TEST (test_fd_limit);
+    RUN_TEST (test_close_at_fd_limit);
+#endif
     return UNITY_END ();
 }
@@ -0,0 +1,186 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil_security.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void set_optimistic (void *socket_)
+{
+    const int optimistic = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      socket_, ZMQ_OPTIMISTIC_HANDSHAKE, &optimistic, sizeof (optimistic)));
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_DEALER);
+
+    int value = -1;
+    size_t size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_OPTIMISTIC_HANDSHAKE, &value, &size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = 2;
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_setsockopt (socket, ZMQ_OPTIMISTIC_HANDSHAKE,
+                                               &value, sizeof (value)));
+    set_optimistic (socket);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_OPTIMISTIC_HANDSHAKE, &value, &size));
+    TEST_ASSERT_EQUAL_INT (1, value);
+
+    test_context_socket_close (socket);
+}
+
+static void test_null (const char *address_, bool optimistic_server_)
+{
+    void *server = test_context_socket (ZMQ_DEALER);
+    if (optimistic_server_)
+        set_optimistic (server);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (server, address_, endpoint, sizeof endpoint);
+
+    void *client = test_context_socket (ZMQ_DEALER);
+    set_optimistic (client);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+
+    bounce (server, client);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+void test_null_tcp ()
+{
+    test_null ("tcp://127.0.0.1:*", false);
+}
+
+void test_null_tcp_both_optimistic ()
+{
+    test_null ("tcp://127.0.0.1:*", true);
+}
+
+#if defined ZMQ_HAVE_IPC
+void test_null_ipc ()
+{
+    test_null ("ipc://*", false);
+}
+#endif
+
+static void socket_config_plain_client_optimistic (void *client_,
+                                                   void *data_)
+{
+    set_optimistic (client_);
+    socket_config_plain_client (client_, data_);
+}
+
+void test_plain ()
+{
+    void *zap_control;
+    void *zap_thread;
+    void *server;
+    void *server_mon;
+    char endpoint[MAX_SOCKET_STRING];
+    setup_context_and_server_side (&zap_control, &zap_thread, &server,
+                                   &server_mon, endpoint, &zap_handler,
+                                   &socket_config_plain_server);
+
+    void *client = create_and_connect_client (
+      endpoint, &socket_config_plain_client_optimistic, NULL);
+    bounce (server, client);
+    test_context_socket_close (client);
+
+    shutdown_context_and_server_side (zap_thread, server, server_mon,
+                                      zap_control);
+}
+
+static void recv_all (fd_t fd_, unsigned char *buffer_, int size_)
+{
+    int received = 0;
+    while (received < size_) {
+        const int rc = TEST_ASSERT_SUCCESS_RAW_ERRNO (
+          recv (fd_, reinterpret_cast<char *> (buffer_) + received,
+                size_ - received, 0));
+        TEST_ASSERT_GREATER_THAN_INT (0, rc);
+        received += rc;
+    }
+}
+
+static void send_all (fd_t fd_, const unsigned char *data_, int size_)
+{
+    TEST_ASSERT_EQUAL_INT (size_, TEST_ASSERT_SUCCESS_RAW_ERRNO (send (
+                                    fd_, reinterpret_cast<const char *> (data_),
+                                    size_, 0)));
+}
+
+//  A peer speaking ZMTP/2.0 gets the whole greeting and the READY command
+//  up front, and rejects them. The client then falls back to the regular
+//  handshake.
+void test_fallback ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    const fd_t listener =
+      bind_socket_resolve_port ("127.0.0.1", "0", endpoint);
+
+    void *client = test_context_socket (ZMQ_DEALER);
+    set_optimistic (client);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+
+    fd_t peer = TEST_ASSERT_SUCCESS_RAW_ERRNO (accept (listener, NULL, NULL));
+
+    unsigned char buffer[64 + sizeof (zmtp_ready_dealer)];
+    recv_all (peer, buffer, sizeof buffer);
+    TEST_ASSERT_EQUAL_UINT8 (3, buffer[10]);
+    TEST_ASSERT_EQUAL_UINT8 (1, buffer[11]);
+    TEST_ASSERT_EQUAL_MEMORY ("NULL", buffer + 12, 4);
+    TEST_ASSERT_EQUAL_MEMORY (zmtp_ready_dealer, buffer + 64,
+                              sizeof (zmtp_ready_dealer));
+
+    //  ZMTP/2.0 greeting of a DEALER socket.
+    const unsigned char greeting_v2[] = {0xff, 0, 0, 0, 0,    0,
+                                         0,    0, 1, 0x7f, 1, ZMQ_DEALER};
+    send_all (peer, greeting_v2, sizeof greeting_v2);
+    TEST_ASSERT_EQUAL_INT (0,
+                           recv (peer, reinterpret_cast<char *> (buffer),
+                                 sizeof buffer, 0));
+    close (peer);
+
+    //  On reconnection, only the signature comes until the peer's arrives.
+    peer = TEST_ASSERT_SUCCESS_RAW_ERRNO (accept (listener, NULL, NULL));
+    msleep (SETTLE_TIME);
+    TEST_ASSERT_EQUAL_INT (10, TEST_ASSERT_SUCCESS_RAW_ERRNO (recv (
+                                 peer, reinterpret_cast<char *> (buffer),
+                                 sizeof buffer, 0)));
+
+    send_all (peer, zmtp_greeting_null, sizeof zmtp_greeting_null);
+    recv_all (peer, buffer, 64 - 10 + sizeof (zmtp_ready_dealer));
+    send_all (peer, zmtp_ready_dealer, sizeof zmtp_ready_dealer);
+
+    const unsigned char hello[] = {0, 5, 'h', 'e', 'l', 'l', 'o'};
+    send_all (peer, hello, sizeof hello);
+    recv_string_expect_success (client, "hello", 0);
+
+    test_context_socket_close_zero_linger (client);
+    close (peer);
+    close (listener);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_null_tcp);
+    RUN_TEST (test_null_tcp_both_optimistic);
+#if defined ZMQ_HAVE_IPC
+    RUN_TEST (test_null_ipc);
+#endif
+    RUN_TEST (test_plain);
+    RUN_TEST (test_fallback);
+    return UNITY_END ();
+}
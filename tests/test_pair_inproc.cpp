@@ -44,6 +44,25 @@ void test_zmq_send_const ()
     recv_string_expect_success (sc, "foobar", 0);
 }
 
+//  A command sent to the socket before its file descriptor was asked for
+//  still makes the descriptor readable.
+void test_fd_after_command ()
+{
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, zmq_recv (sc, buffer, sizeof buffer, ZMQ_DONTWAIT));
+    send_string_expect_success (sb, "foo", 0);
+
+    fd_t fd;
+    size_t fd_size = sizeof fd;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_getsockopt (sc, ZMQ_FD, &fd, &fd_size));
+    zmq_pollitem_t item = {NULL, fd, ZMQ_POLLIN, 0};
+    TEST_ASSERT_EQUAL_INT (1,
+                           TEST_ASSERT_SUCCESS_ERRNO (zmq_poll (&item, 1, 0)));
+
+    recv_string_expect_success (sc, "foo", 0);
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -51,5 +70,6 @@ int main ()
     UNITY_BEGIN ();
     RUN_TEST (test_roundtrip);
     RUN_TEST (test_zmq_send_const);
+    RUN_TEST (test_fd_after_command);
     return UNITY_END ();
 }
@@ -79,6 +79,35 @@ void test_pair_tcp_connect_by_name ()
     test_context_socket_close (sb);
 }
 
+//  The connection keeps working once idle long enough for the engines to
+//  give their buffers back.
+void test_pair_tcp_idle ()
+{
+    void *sb = test_context_socket (ZMQ_PAIR);
+    char my_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (sb, my_endpoint, sizeof my_endpoint);
+    void *sc = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, my_endpoint));
+
+    bounce (sb, sc);
+    msleep (2500);
+    bounce (sb, sc);
+
+    //  A message larger than the buffers, received in place.
+    char buffer[16384];
+    memset (buffer, 'x', sizeof buffer);
+    TEST_ASSERT_EQUAL_INT (
+      static_cast<int> (sizeof buffer),
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_send (sc, buffer, sizeof buffer, 0)));
+    memset (buffer, 0, sizeof buffer);
+    TEST_ASSERT_EQUAL_INT (
+      static_cast<int> (sizeof buffer),
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (sb, buffer, sizeof buffer, 0)));
+    TEST_ASSERT_EACH_EQUAL_INT8 ('x', buffer, sizeof buffer);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
 
 #ifdef ZMQ_BUILD_DRAFT
 void test_pair_tcp_fastpath ()
@@ -123,6 +152,7 @@ int main ()
     UNITY_BEGIN ();
     RUN_TEST (test_pair_tcp_regular);
     RUN_TEST (test_pair_tcp_connect_by_name);
+    RUN_TEST (test_pair_tcp_idle);
 #ifdef ZMQ_BUILD_DRAFT
     RUN_TEST (test_pair_tcp_fastpath);
 #endif
@@ -228,6 +228,14 @@ void test_radio_bind_fails (int ipv6_)
 }
 MAKE_TEST_V4V6 (test_radio_bind_fails)
 
+//  Size of the body of the i-th message of a burst. Most bodies are small
+//  enough to be copied out of their receive slot, and every eighth one is
+//  large enough to be received in place.
+static size_t burst_body_size (int i_)
+{
+    return i_ % 8 == 7 ? 6000 + i_ : (i_ * 97) % 2000 + 1;
+}
+
 void test_radio_dish_udp (int ipv6_)
 {
     void *radio = test_context_socket (ZMQ_RADIO);
@@ -238,6 +246,12 @@ void test_radio_dish_udp (int ipv6_)
     TEST_ASSERT_SUCCESS_ERRNO (
       zmq_setsockopt (dish, ZMQ_IPV6, &ipv6_, sizeof (int)));
 
+    //  A burst fills the pipe half way through a receive batch, the rest
+    //  of which must not be lost.
+    const int hwm = 4;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_RCVHWM, &hwm, sizeof (hwm)));
+
     const char *radio_url = ipv6_ ? "udp://[::1]:5556" : "udp://127.0.0.1:5556";
 
     TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (dish, "udp://*:5556"));
@@ -250,6 +264,31 @@ void test_radio_dish_udp (int ipv6_)
     msg_send_expect_success (radio, "TV", "Friends");
     msg_recv_cmp (dish, "TV", "Friends");
 
+    const int msg_count = 64;
+    char body[8000];
+    for (int i = 0; i < msg_count; i++) {
+        const size_t size = burst_body_size (i);
+        memset (body, 'a' + i % 26, size);
+
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_buffer (&msg, body, size));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_set_group (&msg, "TV"));
+        TEST_ASSERT_EQUAL_INT ((int) size, zmq_msg_send (&msg, radio, 0));
+    }
+
+    for (int i = 0; i < msg_count; i++) {
+        const size_t size = burst_body_size (i);
+        memset (body, 'a' + i % 26, size);
+
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT ((int) size, TEST_ASSERT_SUCCESS_ERRNO (
+                                             zmq_msg_recv (&msg, dish, 0)));
+        TEST_ASSERT_EQUAL_STRING ("TV", zmq_msg_group (&msg));
+        TEST_ASSERT_EQUAL_MEMORY (body, zmq_msg_data (&msg), size);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
     test_context_socket_close (dish);
     test_context_socket_close (radio);
 }
@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void set_rcvspin (void *socket_, int rcvspin_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_RCVSPIN, &rcvspin_, sizeof (rcvspin_)));
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PULL);
+
+    int value = -1;
+    size_t value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_RCVSPIN, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_RCVSPIN, &value, sizeof (value)));
+
+    set_rcvspin (socket, 100);
+    value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_RCVSPIN, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (100, value);
+
+    test_context_socket_close (socket);
+}
+
+//  Most receives find their message while spinning, some only once asleep.
+static void test_round_trips (const char *address_)
+{
+    void *rep = test_context_socket (ZMQ_REP);
+    set_rcvspin (rep, 50);
+    char endpoint[MAX_SOCKET_STRING];
+    test_bind (rep, address_, endpoint, sizeof endpoint);
+    void *req = test_context_socket (ZMQ_REQ);
+    set_rcvspin (req, 50);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, endpoint));
+
+    for (int i = 0; i < 1000; i++) {
+        send_string_expect_success (req, "ping", 0);
+        recv_string_expect_success (rep, "ping", 0);
+        send_string_expect_success (rep, "pong", 0);
+        recv_string_expect_success (req, "pong", 0);
+    }
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_round_trips_inproc ()
+{
+    test_round_trips ("inproc://rcvspin");
+}
+
+void test_round_trips_tcp ()
+{
+    test_round_trips ("tcp://127.0.0.1:*");
+}
+
+//  The spin is cut short by the receive timeout.
+void test_timeout ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_rcvspin (pull, 10 * 1000 * 1000);
+    const int timeout = 100;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVTIMEO, &timeout, sizeof (timeout)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://rcvspin-timeout"));
+
+    void *watch = zmq_stopwatch_start ();
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recv (pull, buffer, sizeof buffer, 0));
+    const unsigned long elapsed = zmq_stopwatch_stop (watch);
+    TEST_ASSERT_LESS_THAN (2 * 1000 * 1000, elapsed);
+
+    test_context_socket_close (pull);
+}
+
+//  After spinning, the socket's file descriptor signals incoming messages
+//  as usual.
+void test_poll_after_spin ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_rcvspin (pull, 1000);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_string_expect_success (push, "first", 0);
+    recv_string_expect_success (pull, "first", 0);
+
+    zmq_pollitem_t item = {pull, 0, ZMQ_POLLIN, 0};
+    TEST_ASSERT_EQUAL_INT (0,
+                           TEST_ASSERT_SUCCESS_ERRNO (zmq_poll (&item, 1, 0)));
+
+    send_string_expect_success (push, "second", 0);
+    TEST_ASSERT_EQUAL_INT (
+      1, TEST_ASSERT_SUCCESS_ERRNO (zmq_poll (&item, 1, 1000)));
+    recv_string_expect_success (pull, "second", 0);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_round_trips_inproc);
+    RUN_TEST (test_round_trips_tcp);
+    RUN_TEST (test_timeout);
+    RUN_TEST (test_poll_after_spin);
+    return UNITY_END ();
+}
@@ -3,6 +3,8 @@
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
+#include <string.h>
+
 SETUP_TEARDOWN_TESTCONTEXT
 
 void test_with_handover ()
@@ -117,6 +119,103 @@ void test_without_handover ()
     test_context_socket_close (dealer_two);
 }
 
+//  Routing id frames past the VSM size keep their content when the routing
+//  id is handed over meanwhile.
+void test_handover_long_routing_id ()
+{
+    char my_endpoint[MAX_SOCKET_STRING];
+    void *router = test_context_socket (ZMQ_ROUTER);
+    bind_loopback_ipv4 (router, my_endpoint, sizeof my_endpoint);
+    int handover = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (router, ZMQ_ROUTER_HANDOVER,
+                                               &handover, sizeof (handover)));
+
+    char routing_id[100];
+    memset (routing_id, 'X', sizeof routing_id);
+    void *dealer_one = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dealer_one, ZMQ_ROUTING_ID,
+                                               routing_id, sizeof routing_id));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealer_one, my_endpoint));
+
+    zmq_msg_t id_one;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&id_one));
+    send_string_expect_success (dealer_one, "Hello", 0);
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof routing_id),
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_msg_recv (&id_one, router, 0)));
+    recv_string_expect_success (router, "Hello", 0);
+
+    void *dealer_two = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dealer_two, ZMQ_ROUTING_ID,
+                                               routing_id, sizeof routing_id));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealer_two, my_endpoint));
+
+    zmq_msg_t id_two;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&id_two));
+    send_string_expect_success (dealer_two, "Hello", 0);
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof routing_id),
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_msg_recv (&id_two, router, 0)));
+    recv_string_expect_success (router, "Hello", 0);
+
+    TEST_ASSERT_EQUAL_MEMORY (routing_id, zmq_msg_data (&id_one),
+                              sizeof routing_id);
+    TEST_ASSERT_EQUAL_MEMORY (routing_id, zmq_msg_data (&id_two),
+                              sizeof routing_id);
+
+    //  The frame received first now routes to the second dealer.
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof routing_id),
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_msg_send (&id_one, router, ZMQ_SNDMORE)));
+    send_string_expect_success (router, "Hello", 0);
+    recv_string_expect_success (dealer_two, "Hello", 0);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&id_one));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&id_two));
+    test_context_socket_close (router);
+    test_context_socket_close (dealer_one);
+    test_context_socket_close (dealer_two);
+}
+
+//  A received routing id frame is the application's own: writing into it
+//  changes neither the routing id of the peer nor the next frames.
+void test_write_to_long_routing_id ()
+{
+    char my_endpoint[MAX_SOCKET_STRING];
+    void *router = test_context_socket (ZMQ_ROUTER);
+    bind_loopback_ipv4 (router, my_endpoint, sizeof my_endpoint);
+
+    char routing_id[100];
+    memset (routing_id, 'X', sizeof routing_id);
+    void *dealer = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dealer, ZMQ_ROUTING_ID,
+                                               routing_id, sizeof routing_id));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealer, my_endpoint));
+
+    zmq_msg_t id;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&id));
+    send_string_expect_success (dealer, "Hello", 0);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&id, router, 0));
+    recv_string_expect_success (router, "Hello", 0);
+    memset (zmq_msg_data (&id), 'Y', zmq_msg_size (&id));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&id));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&id));
+    send_string_expect_success (dealer, "Hello", 0);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&id, router, 0));
+    recv_string_expect_success (router, "Hello", 0);
+    TEST_ASSERT_EQUAL_INT (sizeof routing_id, zmq_msg_size (&id));
+    TEST_ASSERT_EQUAL_MEMORY (routing_id, zmq_msg_data (&id),
+                              sizeof routing_id);
+    memset (zmq_msg_data (&id), 'Y', zmq_msg_size (&id));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&id));
+
+    //  The peer is still found when it goes away.
+    test_context_socket_close (dealer);
+    msleep (SETTLE_TIME);
+    test_context_socket_close (router);
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -124,5 +223,7 @@ int main ()
     UNITY_BEGIN ();
     RUN_TEST (test_with_handover);
     RUN_TEST (test_without_handover);
+    RUN_TEST (test_handover_long_routing_id);
+    RUN_TEST (test_write_to_long_routing_id);
     return UNITY_END ();
 }
@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+static const int io_threads = 4;
+static const int peers = 16;
+
+void setUp ()
+{
+    setup_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_THREADS, io_threads));
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+void test_sockopt_tcp_listen_shards ()
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+
+    int value = -2;
+    size_t value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (router, ZMQ_TCP_LISTEN_SHARDS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = -2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (router, ZMQ_TCP_LISTEN_SHARDS, &value, sizeof (value)));
+
+    value = 3;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (router, ZMQ_TCP_LISTEN_SHARDS, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (router, ZMQ_TCP_LISTEN_SHARDS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (3, value);
+
+    value = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      router, ZMQ_TCP_LISTEN_CPU_STEERING, &value, sizeof (value)));
+    value = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_getsockopt (
+      router, ZMQ_TCP_LISTEN_CPU_STEERING, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (1, value);
+
+    test_context_socket_close (router);
+}
+
+static void test_sharded_bind (int shards_, int steering_)
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (router, ZMQ_TCP_LISTEN_SHARDS,
+                                               &shards_, sizeof (shards_)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      router, ZMQ_TCP_LISTEN_CPU_STEERING, &steering_, sizeof (steering_)));
+
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (router, endpoint, sizeof endpoint);
+
+    void *dealers[peers];
+    for (int i = 0; i < peers; ++i) {
+        dealers[i] = test_context_socket (ZMQ_DEALER);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealers[i], endpoint));
+        send_string_expect_success (dealers[i], "Hello", 0);
+    }
+
+    //  Every connection is served, whichever shard accepted it.
+    for (int i = 0; i < peers; ++i) {
+        zmq_msg_t routing_id;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&routing_id));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&routing_id, router, 0));
+        recv_string_expect_success (router, "Hello", 0);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_msg_send (&routing_id, router, ZMQ_SNDMORE));
+        send_string_expect_success (router, "World", 0);
+    }
+    for (int i = 0; i < peers; ++i) {
+        recv_string_expect_success (dealers[i], "World", 0);
+        test_context_socket_close_zero_linger (dealers[i]);
+    }
+
+    //  Unbinding the endpoint stops all of its shards.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_unbind (router, endpoint));
+    test_context_socket_close (router);
+}
+
+void test_sharded_bind_all_io_threads ()
+{
+    test_sharded_bind (-1, 0);
+}
+
+void test_sharded_bind_some_io_threads ()
+{
+    test_sharded_bind (2, 0);
+}
+
+void test_sharded_bind_cpu_steering ()
+{
+    test_sharded_bind (-1, 1);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_sockopt_tcp_listen_shards);
+    RUN_TEST (test_sharded_bind_all_io_threads);
+    RUN_TEST (test_sharded_bind_some_io_threads);
+    RUN_TEST (test_sharded_bind_cpu_steering);
+    return UNITY_END ();
+}
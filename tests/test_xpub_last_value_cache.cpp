@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void set_last_value_cache (void *socket_, int topic_size_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      socket_, ZMQ_XPUB_LAST_VALUE_CACHE, &topic_size_, sizeof (topic_size_)));
+}
+
+//  Makes the socket process the commands it was sent, subscriptions
+//  included.
+static void process_commands (void *socket_)
+{
+    int events;
+    size_t events_size = sizeof (events);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket_, ZMQ_EVENTS, &events, &events_size));
+}
+
+static void recv_nothing (void *socket_)
+{
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, zmq_recv (socket_, buffer, sizeof buffer, ZMQ_DONTWAIT));
+}
+
+void test_option ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+
+    int value = -2;
+    size_t value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (pub, ZMQ_XPUB_LAST_VALUE_CACHE, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = -2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (pub, ZMQ_XPUB_LAST_VALUE_CACHE, &value, sizeof (value)));
+
+    set_last_value_cache (pub, ZMQ_XPUB_LAST_VALUE_CACHE_FRAME);
+    value_size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (pub, ZMQ_XPUB_LAST_VALUE_CACHE, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (ZMQ_XPUB_LAST_VALUE_CACHE_FRAME, value);
+
+    test_context_socket_close (pub);
+}
+
+//  A new subscription gets the last message of each matching topic.
+void test_subscribe ()
+{
+    void *pub = test_context_socket (ZMQ_XPUB);
+    set_last_value_cache (pub, 2);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pub, "inproc://last_value_cache"));
+
+    send_string_expect_success (pub, "A1 old", 0);
+    send_string_expect_success (pub, "A1 new", 0);
+    send_string_expect_success (pub, "A2 only", 0);
+    send_string_expect_success (pub, "B1 old", 0);
+    send_string_expect_success (pub, "B1 new", 0);
+
+    void *sub = test_context_socket (ZMQ_XSUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, "inproc://last_value_cache"));
+
+    const char subscription_a[] = {1, 'A', 0};
+    send_string_expect_success (sub, subscription_a, 0);
+    recv_string_expect_success (pub, subscription_a, 0);
+
+    recv_string_expect_success (sub, "A1 new", 0);
+    recv_string_expect_success (sub, "A2 only", 0);
+    recv_nothing (sub);
+
+    //  A subscription longer than the topic size only gets the messages
+    //  it matches.
+    const char subscription_b_old[] = {1, 'B', '1', ' ', 'o', 0};
+    send_string_expect_success (sub, subscription_b_old, 0);
+    recv_string_expect_success (pub, subscription_b_old, 0);
+    recv_nothing (sub);
+
+    const char subscription_b_new[] = {1, 'B', '1', ' ', 'n', 0};
+    send_string_expect_success (sub, subscription_b_new, 0);
+    recv_string_expect_success (pub, subscription_b_new, 0);
+    recv_string_expect_success (sub, "B1 new", 0);
+    recv_nothing (sub);
+
+    //  Messages sent since are received as usual.
+    send_string_expect_success (pub, "A1 newer", 0);
+    recv_string_expect_success (sub, "A1 newer", 0);
+
+    test_context_socket_close (sub);
+    test_context_socket_close (pub);
+}
+
+//  With the whole first frame as topic, multi-part messages are cached
+//  whole.
+void test_multipart ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+
+    void *pub = test_context_socket (ZMQ_PUB);
+    set_last_value_cache (pub, ZMQ_XPUB_LAST_VALUE_CACHE_FRAME);
+    bind_loopback_ipv4 (pub, endpoint, sizeof endpoint);
+
+    send_string_expect_success (pub, "t1", ZMQ_SNDMORE);
+    send_string_expect_success (pub, "old", 0);
+    send_string_expect_success (pub, "t1", ZMQ_SNDMORE);
+    send_string_expect_success (pub, "new", 0);
+    send_string_expect_success (pub, "t2", ZMQ_SNDMORE);
+    send_string_expect_success (pub, "only", 0);
+
+    void *sub = test_context_socket (ZMQ_SUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_SUBSCRIBE, "t", 1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, endpoint));
+    msleep (SETTLE_TIME);
+    process_commands (pub);
+
+    recv_string_expect_success (sub, "t1", 0);
+    recv_string_expect_success (sub, "new", 0);
+    recv_string_expect_success (sub, "t2", 0);
+    recv_string_expect_success (sub, "only", 0);
+
+    test_context_socket_close (sub);
+    test_context_socket_close (pub);
+}
+
+//  A subscription received in the middle of a multi-part message gets its
+//  last values once the message is complete.
+void test_subscribe_during_message ()
+{
+    void *pub = test_context_socket (ZMQ_XPUB);
+    set_last_value_cache (pub, 1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pub, "inproc://last_value_cache"));
+
+    void *sub = test_context_socket (ZMQ_XSUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, "inproc://last_value_cache"));
+    const char subscription_a[] = {1, 'A', 0};
+    send_string_expect_success (sub, subscription_a, 0);
+    recv_string_expect_success (pub, subscription_a, 0);
+
+    send_string_expect_success (pub, "B cached", 0);
+
+    send_string_expect_success (pub, "A first", ZMQ_SNDMORE);
+    const char subscription_b[] = {1, 'B', 0};
+    send_string_expect_success (sub, subscription_b, 0);
+    process_commands (pub);
+    send_string_expect_success (pub, "A last", 0);
+
+    recv_string_expect_success (sub, "A first", 0);
+    recv_string_expect_success (sub, "A last", 0);
+    recv_string_expect_success (sub, "B cached", 0);
+    recv_nothing (sub);
+
+    test_context_socket_close (sub);
+    test_context_socket_close (pub);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_subscribe);
+    RUN_TEST (test_multipart);
+    RUN_TEST (test_subscribe_during_message);
+    return UNITY_END ();
+}
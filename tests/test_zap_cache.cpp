@@ -0,0 +1,186 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil_security.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+static const int cache_ttl = 60000;
+
+void setUp ()
+{
+    setup_test_context ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_ZAP_CACHE_TTL, cache_ttl));
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+static void *zap_control;
+static void *zap_thread;
+static void *server;
+static void *server_mon;
+static char my_endpoint[MAX_SOCKET_STRING];
+
+static void setup_server (zmq_thread_fn zap_handler_ = &zap_handler)
+{
+    setup_context_and_server_side (&zap_control, &zap_thread, &server,
+                                   &server_mon, my_endpoint, zap_handler_,
+                                   &socket_config_plain_server);
+}
+
+static void shutdown_server ()
+{
+    shutdown_context_and_server_side (zap_thread, server, server_mon,
+                                      zap_control);
+}
+
+//  The ZAP handler counts a request after sending the reply, so the count
+//  may lag behind the handshake for a moment.
+static void expect_zap_requests (int expected_)
+{
+    for (int i = 0;
+         i < 10 && zmq_atomic_counter_value (zap_requests_handled) < expected_;
+         i++)
+        msleep (SETTLE_TIME / 10);
+    TEST_ASSERT_EQUAL_INT (expected_,
+                           zmq_atomic_counter_value (zap_requests_handled));
+}
+
+static void connect_and_bounce ()
+{
+    void *client = create_and_connect_client (
+      my_endpoint, &socket_config_plain_client, NULL);
+    bounce (server, client);
+    test_context_socket_close (client);
+}
+
+static void socket_config_plain_client_wrong_password (void *client_,
+                                                        void * /*unused_*/)
+{
+    const char username[] = "testuser";
+    const char password[] = "wrongpass";
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (client_, ZMQ_PLAIN_USERNAME,
+                                               username, strlen (username)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (client_, ZMQ_PLAIN_PASSWORD,
+                                               password, strlen (password)));
+}
+
+void test_ctx_option ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (ctx, ZMQ_ZAP_CACHE_TTL));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_ctx_set (ctx, ZMQ_ZAP_CACHE_TTL, -1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_ZAP_CACHE_TTL, 1000));
+    TEST_ASSERT_EQUAL_INT (1000, zmq_ctx_get (ctx, ZMQ_ZAP_CACHE_TTL));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+void test_reconnect_uses_cache ()
+{
+    setup_server ();
+
+    connect_and_bounce ();
+    expect_zap_requests (1);
+    connect_and_bounce ();
+    connect_and_bounce ();
+    expect_zap_requests (1);
+
+    shutdown_server ();
+}
+
+void test_rejection_is_cached ()
+{
+    setup_server ();
+
+    expect_new_client_bounce_fail (
+      my_endpoint, server, &socket_config_plain_client_wrong_password, NULL);
+    expect_zap_requests (1);
+    expect_new_client_bounce_fail (
+      my_endpoint, server, &socket_config_plain_client_wrong_password, NULL);
+    expect_zap_requests (1);
+
+    //  Other credentials are not affected.
+    connect_and_bounce ();
+    expect_zap_requests (2);
+
+    shutdown_server ();
+}
+
+void test_invalidation ()
+{
+    setup_server ();
+
+    connect_and_bounce ();
+    expect_zap_requests (1);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_ZAP_CACHE_TTL, cache_ttl));
+    connect_and_bounce ();
+    expect_zap_requests (2);
+
+    shutdown_server ();
+}
+
+void test_expiry ()
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_ZAP_CACHE_TTL, 100));
+    setup_server ();
+
+    connect_and_bounce ();
+    expect_zap_requests (1);
+
+    msleep (SETTLE_TIME);
+    connect_and_bounce ();
+    expect_zap_requests (2);
+
+    shutdown_server ();
+}
+
+static void zap_handler_temporary_failure (void * /*unused_*/)
+{
+    zap_handler_generic (zap_status_temporary_failure);
+}
+
+//  A temporary failure must not keep the next handshake from reaching the
+//  ZAP handler.
+void test_temporary_failure_is_not_cached ()
+{
+    setup_server (&zap_handler_temporary_failure);
+
+    expect_new_client_bounce_fail (my_endpoint, server,
+                                   &socket_config_plain_client, NULL);
+    expect_new_client_bounce_fail (my_endpoint, server,
+                                   &socket_config_plain_client, NULL);
+
+    //  The clients may also have reconnected and asked again.
+    for (int i = 0;
+         i < 10 && zmq_atomic_counter_value (zap_requests_handled) < 2; i++)
+        msleep (SETTLE_TIME / 10);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT (
+      2, zmq_atomic_counter_value (zap_requests_handled));
+
+    shutdown_server ();
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_ctx_option);
+    RUN_TEST (test_reconnect_uses_cache);
+    RUN_TEST (test_rejection_is_cached);
+    RUN_TEST (test_invalidation);
+    RUN_TEST (test_expiry);
+    RUN_TEST (test_temporary_failure_is_not_cached);
+    return UNITY_END ();
+}
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <buffer_pool.hpp>
+#include <msg.hpp>
+#include <v2_decoder.hpp>
+#include <v2_encoder.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+void test_reuse ()
+{
+    zmq::buffer_pool_t pool;
+    void *const buf = zmq::buffer_pool_t::allocate (&pool, 64);
+    TEST_ASSERT_NOT_NULL (buf);
+    zmq::buffer_pool_t::release (&pool, buf, 64);
+
+    //  Only a buffer of the same size is reused.
+    void *const other = zmq::buffer_pool_t::allocate (&pool, 128);
+    TEST_ASSERT_TRUE (other != buf);
+    TEST_ASSERT_EQUAL_PTR (buf, zmq::buffer_pool_t::allocate (&pool, 64));
+
+    zmq::buffer_pool_t::release (&pool, other, 128);
+    zmq::buffer_pool_t::release (&pool, buf, 64);
+}
+
+void test_no_pool ()
+{
+    void *const buf = zmq::buffer_pool_t::allocate (NULL, 64);
+    TEST_ASSERT_NOT_NULL (buf);
+    zmq::buffer_pool_t::release (NULL, buf, 64);
+}
+
+//  The encoder gives its buffer back, and allocates it anew for the next
+//  message.
+void test_encoder_release ()
+{
+    zmq::buffer_pool_t pool;
+    zmq::v2_encoder_t encoder (64);
+    encoder.set_buffer_pool (&pool);
+
+    zmq::msg_t msg;
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT (0, msg.init_size (5));
+        memcpy (msg.data (), "hello", 5);
+        encoder.load_msg (&msg);
+        unsigned char *data = NULL;
+        TEST_ASSERT_EQUAL_UINT (7, encoder.encode (&data, 0));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY ("hello", data + 2, 5);
+        encoder.release_buffer ();
+
+        //  The buffer is in the pool again.
+        void *const buf = zmq::buffer_pool_t::allocate (&pool, 64);
+        TEST_ASSERT_EQUAL_PTR (data, buf);
+        zmq::buffer_pool_t::release (&pool, buf, 64);
+    }
+    TEST_ASSERT_EQUAL_INT (0, msg.close ());
+}
+
+//  The decoder reuses the buffer it gave back, and keeps decoding.
+void test_decoder_release ()
+{
+    zmq::buffer_pool_t pool;
+    zmq::v2_decoder_t decoder (64, -1, true);
+    decoder.set_buffer_pool (&pool);
+
+    unsigned char *first = NULL;
+    for (int i = 0; i < 2; i++) {
+        unsigned char *data;
+        size_t size;
+        decoder.get_buffer (&data, &size);
+        TEST_ASSERT_EQUAL_UINT (64, size);
+        if (i == 0)
+            first = data;
+        else
+            TEST_ASSERT_EQUAL_PTR (first, data);
+
+        memcpy (data, "\0\5hello", 7);
+        decoder.resize_buffer (7);
+        size_t processed;
+        TEST_ASSERT_EQUAL_INT (1, decoder.decode (data, 7, processed));
+        TEST_ASSERT_EQUAL_UINT (7, processed);
+        TEST_ASSERT_EQUAL_UINT (5, decoder.msg ()->size ());
+        TEST_ASSERT_EQUAL_UINT8_ARRAY ("hello", decoder.msg ()->data (), 5);
+        TEST_ASSERT_EQUAL_INT (0, decoder.msg ()->close ());
+        TEST_ASSERT_EQUAL_INT (0, decoder.msg ()->init ());
+
+        decoder.release_buffer ();
+    }
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_reuse);
+    RUN_TEST (test_no_pool);
+    RUN_TEST (test_encoder_release);
+    RUN_TEST (test_decoder_release);
+    return UNITY_END ();
+}
@@ -8,6 +8,8 @@
 #endif
 
 #include <curve_mechanism_base.hpp>
+#include <crypto_pool.hpp>
+#include <ctx.hpp>
 #include <msg.hpp>
 #include <random.hpp>
 
@@ -23,18 +25,10 @@ void tearDown ()
 {
 }
 
-void test_roundtrip (zmq::msg_t *msg_)
-{
 #ifdef ZMQ_HAVE_CURVE
-    const std::vector<uint8_t> original (static_cast<uint8_t *> (msg_->data ()),
-                                         static_cast<uint8_t *> (msg_->data ())
-                                           + msg_->size ());
-
-    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
-                                           "CurveZMQMESSAGES", false);
-    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
-                                           "CurveZMQMESSAGEC", false);
-
+void setup_keys (zmq::curve_encoding_t *encoding_client_,
+                 zmq::curve_encoding_t *encoding_server_)
+{
     uint8_t client_public[32];
     uint8_t client_secret[32];
     TEST_ASSERT_SUCCESS_ERRNO (
@@ -46,11 +40,26 @@ void test_roundtrip (zmq::msg_t *msg_)
       crypto_box_keypair (server_public, server_secret));
 
     TEST_ASSERT_SUCCESS_ERRNO (
-      crypto_box_beforenm (encoding_client.get_writable_precom_buffer (),
+      crypto_box_beforenm (encoding_client_->get_writable_precom_buffer (),
                            server_public, client_secret));
     TEST_ASSERT_SUCCESS_ERRNO (
-      crypto_box_beforenm (encoding_server.get_writable_precom_buffer (),
+      crypto_box_beforenm (encoding_server_->get_writable_precom_buffer (),
                            client_public, server_secret));
+}
+#endif
+
+void test_roundtrip (zmq::msg_t *msg_)
+{
+#ifdef ZMQ_HAVE_CURVE
+    const std::vector<uint8_t> original (static_cast<uint8_t *> (msg_->data ()),
+                                         static_cast<uint8_t *> (msg_->data ())
+                                           + msg_->size ());
+
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+    setup_keys (&encoding_client, &encoding_server);
 
     TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (msg_));
 
@@ -114,6 +123,65 @@ void test_roundtrip_large ()
     msg.close ();
 }
 
+//  A large message has room for the header in front of its data, so it is
+//  encrypted without being moved.
+void test_roundtrip_large_in_place ()
+{
+#ifndef ZMQ_HAVE_CURVE
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#else
+    zmq::msg_t msg;
+    msg.init_size (2048);
+    memset (msg.data (), 'x', 2048);
+    TEST_ASSERT_TRUE (msg.headroom () > 0);
+    const uint8_t *const data = static_cast<uint8_t *> (msg.data ());
+
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+    setup_keys (&encoding_client, &encoding_server);
+
+    TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (&msg));
+    TEST_ASSERT_TRUE (msg.data () < data);
+    TEST_ASSERT_TRUE (static_cast<uint8_t *> (msg.data ()) + msg.size ()
+                      == data + 2048);
+
+    encoding_server.set_peer_nonce (0);
+    int error_event_code;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      encoding_server.decode (&msg, &error_event_code));
+    TEST_ASSERT_EQUAL_PTR (data, msg.data ());
+    TEST_ASSERT_EQUAL_INT (2048, msg.size ());
+    TEST_ASSERT_EACH_EQUAL_UINT8 ('x', msg.data (), 2048);
+
+    msg.close ();
+#endif
+}
+
+//  The data of a shared message are left alone for the other references.
+void test_roundtrip_large_shared ()
+{
+#ifndef ZMQ_HAVE_CURVE
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#else
+    zmq::msg_t msg;
+    msg.init_size (2048);
+    memset (msg.data (), 'x', 2048);
+    zmq::msg_t copy;
+    copy.init ();
+    copy.copy (msg);
+    TEST_ASSERT_EQUAL_INT (0, msg.headroom ());
+
+    test_roundtrip (&msg);
+    TEST_ASSERT_EQUAL_INT (2048, copy.size ());
+    TEST_ASSERT_EACH_EQUAL_UINT8 ('x', copy.data (), 2048);
+
+    copy.close ();
+    msg.close ();
+#endif
+}
+
 void test_roundtrip_empty_more ()
 {
 #ifndef ZMQ_HAVE_CURVE
@@ -129,6 +197,57 @@ void test_roundtrip_empty_more ()
     msg.close ();
 }
 
+void test_roundtrip_batch ()
+{
+#ifdef ZMQ_HAVE_CURVE
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+    setup_keys (&encoding_client, &encoding_server);
+
+    zmq::thread_ctx_t thread_ctx;
+    zmq::crypto_pool_t pool (thread_ctx, 2);
+
+    //  Large enough for the batch to be spread over the pool.
+    const size_t count = 16;
+    const size_t size = 2048;
+    zmq::msg_t msgs[count];
+    for (size_t i = 0; i < count; i++) {
+        msgs[i].init_size (size);
+        memset (msgs[i].data (), static_cast<int> (i), size);
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      encoding_client.encode_batch (msgs, count, &pool));
+
+    //  A message tampered with fails, and so does everything after it, but
+    //  the messages in front of it are decoded.
+    static_cast<uint8_t *> (msgs[count - 1].data ())[size / 2] ^= 1;
+
+    encoding_server.set_peer_nonce (0);
+    size_t decoded = 0;
+    int error_event_code = 0;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EPROTO, encoding_server.decode_batch (msgs, count, &pool, &decoded,
+                                            &error_event_code));
+    TEST_ASSERT_EQUAL_INT (count - 1, decoded);
+    TEST_ASSERT_EQUAL_INT (ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC,
+                           error_event_code);
+
+    for (size_t i = 0; i < decoded; i++) {
+        TEST_ASSERT_EQUAL_INT (size, msgs[i].size ());
+        TEST_ASSERT_EACH_EQUAL_UINT8 (static_cast<uint8_t> (i),
+                                      msgs[i].data (), size);
+    }
+
+    for (size_t i = 0; i < count; i++)
+        msgs[i].close ();
+#else
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#endif
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -139,9 +258,13 @@ int main ()
     RUN_TEST (test_roundtrip_empty);
     RUN_TEST (test_roundtrip_small);
     RUN_TEST (test_roundtrip_large);
+    RUN_TEST (test_roundtrip_large_in_place);
+    RUN_TEST (test_roundtrip_large_shared);
 
     RUN_TEST (test_roundtrip_empty_more);
 
+    RUN_TEST (test_roundtrip_batch);
+
     zmq::random_close ();
 
     return UNITY_END ();
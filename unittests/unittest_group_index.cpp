@@ -0,0 +1,215 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <group_index.hpp>
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+//  The index never dereferences the pipes.
+static zmq::pipe_t *fake_pipe (size_t id_)
+{
+    return reinterpret_cast<zmq::pipe_t *> (id_ * 16);
+}
+
+static void add (zmq::group_index_t &index_, const char *group_, size_t pipe_)
+{
+    index_.add (group_, strlen (group_), fake_pipe (pipe_));
+}
+
+static bool rm (zmq::group_index_t &index_, const char *group_, size_t pipe_)
+{
+    return index_.rm (group_, strlen (group_), fake_pipe (pipe_));
+}
+
+static bool check (zmq::group_index_t &index_, const char *group_)
+{
+    return index_.check (group_, strlen (group_));
+}
+
+static void count_pipe (zmq::pipe_t *pipe_, void *counts_)
+{
+    static_cast<size_t *> (counts_)[reinterpret_cast<size_t> (pipe_) / 16]++;
+}
+
+static void count_match (zmq::group_index_t &index_,
+                         const char *group_,
+                         size_t *counts_)
+{
+    index_.match (group_, strlen (group_), count_pipe, counts_);
+}
+
+void test_empty ()
+{
+    zmq::group_index_t index;
+
+    TEST_ASSERT_EQUAL_UINT (0, index.size ());
+    TEST_ASSERT_FALSE (check (index, "TV"));
+    TEST_ASSERT_FALSE (rm (index, "TV", 1));
+    index.rm (fake_pipe (1));
+}
+
+void test_add_rm ()
+{
+    zmq::group_index_t index;
+
+    add (index, "TV", 1);
+    TEST_ASSERT_EQUAL_UINT (1, index.size ());
+    TEST_ASSERT_TRUE (check (index, "TV"));
+    TEST_ASSERT_FALSE (check (index, "T"));
+    TEST_ASSERT_FALSE (check (index, "TVs"));
+    TEST_ASSERT_FALSE (check (index, ""));
+
+    TEST_ASSERT_FALSE (rm (index, "TV", 2));
+    TEST_ASSERT_TRUE (rm (index, "TV", 1));
+    TEST_ASSERT_FALSE (check (index, "TV"));
+    TEST_ASSERT_EQUAL_UINT (0, index.size ());
+}
+
+void test_empty_group ()
+{
+    zmq::group_index_t index;
+
+    add (index, "", 1);
+    TEST_ASSERT_TRUE (check (index, ""));
+    TEST_ASSERT_FALSE (check (index, "TV"));
+}
+
+void test_longest_group ()
+{
+    zmq::group_index_t index;
+
+    char group[ZMQ_GROUP_MAX_LENGTH + 1];
+    memset (group, 'g', ZMQ_GROUP_MAX_LENGTH);
+    group[ZMQ_GROUP_MAX_LENGTH] = 0;
+    add (index, group, 1);
+    TEST_ASSERT_TRUE (check (index, group));
+
+    group[ZMQ_GROUP_MAX_LENGTH - 1] = 'h';
+    TEST_ASSERT_FALSE (check (index, group));
+}
+
+void test_match ()
+{
+    zmq::group_index_t index;
+
+    add (index, "TV", 1);
+    add (index, "TV", 2);
+    add (index, "TV", 2);
+    add (index, "radio", 3);
+
+    size_t counts[4] = {0, 0, 0, 0};
+    count_match (index, "TV", counts);
+    TEST_ASSERT_EQUAL_UINT (0, counts[0]);
+    TEST_ASSERT_EQUAL_UINT (1, counts[1]);
+    TEST_ASSERT_EQUAL_UINT (2, counts[2]);
+    TEST_ASSERT_EQUAL_UINT (0, counts[3]);
+
+    //  Only one instance of a duplicate pair is removed.
+    TEST_ASSERT_TRUE (rm (index, "TV", 2));
+    memset (counts, 0, sizeof counts);
+    count_match (index, "TV", counts);
+    TEST_ASSERT_EQUAL_UINT (1, counts[2]);
+}
+
+void test_rm_pipe ()
+{
+    zmq::group_index_t index;
+
+    add (index, "TV", 1);
+    add (index, "TV", 2);
+    add (index, "radio", 1);
+    add (index, "movies", 2);
+
+    index.rm (fake_pipe (1));
+    TEST_ASSERT_EQUAL_UINT (2, index.size ());
+    TEST_ASSERT_TRUE (check (index, "TV"));
+    TEST_ASSERT_FALSE (check (index, "radio"));
+    TEST_ASSERT_TRUE (check (index, "movies"));
+}
+
+static void count_pair (const char *group_,
+                        size_t size_,
+                        zmq::pipe_t *pipe_,
+                        void *count_)
+{
+    TEST_ASSERT_EQUAL_UINT (strlen ("TV"), size_);
+    TEST_ASSERT_EQUAL_MEMORY ("TV", group_, size_);
+    TEST_ASSERT_EQUAL_PTR (fake_pipe (1), pipe_);
+    ++*static_cast<size_t *> (count_);
+}
+
+void test_apply ()
+{
+    zmq::group_index_t index;
+
+    add (index, "TV", 1);
+    add (index, "TV", 1);
+
+    size_t count = 0;
+    index.apply (count_pair, &count);
+    TEST_ASSERT_EQUAL_UINT (2, count);
+}
+
+//  Enough pairs to grow the table several times and to make probe sequences
+//  overlap, removed in an order that keeps shifting entries back.
+void test_many ()
+{
+    zmq::group_index_t index;
+    const size_t group_count = 1000;
+    const size_t pipe_count = 4;
+    char group[16];
+
+    for (size_t i = 0; i < group_count; i++) {
+        snprintf (group, sizeof group, "group-%u", static_cast<unsigned> (i));
+        add (index, group, i % pipe_count);
+    }
+    TEST_ASSERT_EQUAL_UINT (group_count, index.size ());
+
+    for (size_t i = 0; i < group_count; i += 3) {
+        snprintf (group, sizeof group, "group-%u", static_cast<unsigned> (i));
+        TEST_ASSERT_TRUE (rm (index, group, i % pipe_count));
+    }
+    index.rm (fake_pipe (1));
+
+    for (size_t i = 0; i < group_count; i++) {
+        snprintf (group, sizeof group, "group-%u", static_cast<unsigned> (i));
+        const bool expected = i % 3 != 0 && i % pipe_count != 1;
+        TEST_ASSERT_EQUAL (expected, check (index, group));
+
+        size_t counts[pipe_count] = {0, 0, 0, 0};
+        count_match (index, group, counts);
+        TEST_ASSERT_EQUAL_UINT (expected ? 1 : 0, counts[i % pipe_count]);
+    }
+
+    for (size_t i = 0; i < pipe_count; i++)
+        index.rm (fake_pipe (i));
+    TEST_ASSERT_EQUAL_UINT (0, index.size ());
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+
+    RUN_TEST (test_empty);
+    RUN_TEST (test_add_rm);
+    RUN_TEST (test_empty_group);
+    RUN_TEST (test_longest_group);
+    RUN_TEST (test_match);
+    RUN_TEST (test_rm_pipe);
+    RUN_TEST (test_apply);
+    RUN_TEST (test_many);
+
+    return UNITY_END ();
+}
@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <options.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+//  Options a socket owns are copied into a new snapshot.
+void test_share_copies_options ()
+{
+    zmq::options_t options;
+    options.sndhwm = 42;
+    options.zap_domain = "domain";
+
+    const zmq::options_t &snapshot = zmq::share_options (options);
+    TEST_ASSERT_TRUE (&snapshot != &options);
+    TEST_ASSERT_EQUAL_INT (42, snapshot.sndhwm);
+    TEST_ASSERT_EQUAL_STRING ("domain", snapshot.zap_domain.c_str ());
+
+    //  Changing the options leaves the snapshot as it was.
+    options.sndhwm = 43;
+    TEST_ASSERT_EQUAL_INT (42, snapshot.sndhwm);
+
+    //  Sharing the options anew makes another snapshot.
+    const zmq::options_t &other = zmq::share_options (options);
+    TEST_ASSERT_TRUE (&other != &snapshot);
+    TEST_ASSERT_EQUAL_INT (43, other.sndhwm);
+
+    zmq::release_options (other);
+    zmq::release_options (snapshot);
+}
+
+//  A snapshot is shared as it is, for as long as a reference is left.
+void test_share_snapshot ()
+{
+    zmq::options_t options;
+    options.rcvhwm = 7;
+
+    const zmq::options_t &snapshot = zmq::share_options (options);
+    const zmq::options_t &shared = zmq::share_options (snapshot);
+    TEST_ASSERT_EQUAL_PTR (&snapshot, &shared);
+
+    zmq::release_options (snapshot);
+    TEST_ASSERT_EQUAL_INT (7, shared.rcvhwm);
+    zmq::release_options (shared);
+}
+
+//  A copy of a snapshot is not a snapshot.
+void test_copy_of_snapshot ()
+{
+    zmq::options_t options;
+    const zmq::options_t &snapshot = zmq::share_options (options);
+
+    zmq::options_t copy (snapshot);
+    const zmq::options_t &from_copy = zmq::share_options (copy);
+    TEST_ASSERT_TRUE (&from_copy != &copy);
+
+    zmq::release_options (from_copy);
+    zmq::release_options (snapshot);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+
+    RUN_TEST (test_share_copies_options);
+    RUN_TEST (test_share_snapshot);
+    RUN_TEST (test_copy_of_snapshot);
+
+    return UNITY_END ();
+}
@@ -2,7 +2,12 @@
 
 #include "../tests/testutil.hpp"
 
+#include <msg.hpp>
 #include <ypipe.hpp>
+#include <ypipe_keyed.hpp>
+
+#include <stdio.h>
+#include <string.h>
 
 #include <unity.h>
 
@@ -55,6 +60,142 @@ void test_write_complete_and_flush_and_check_read_and_read ()
     TEST_ASSERT_EQUAL_INT (value, read_value);
 }
 
+//  A pipe whose chunks grow from 2 to 8 items.
+typedef zmq::ypipe_t<int, 8, 2> growing_ypipe_t;
+
+//  The items come out in order while the chunks grow.
+void test_grow ()
+{
+    growing_ypipe_t ypipe;
+    for (int i = 0; i < 100; i++)
+        ypipe.write (i, false);
+    ypipe.flush ();
+    for (int i = 0; i < 100; i++) {
+        int read_value = -1;
+        TEST_ASSERT_TRUE (ypipe.read (&read_value));
+        TEST_ASSERT_EQUAL_INT (i, read_value);
+    }
+    TEST_ASSERT_FALSE (ypipe.check_read ());
+}
+
+//  Incomplete items spanning chunks of different sizes are unwritten in
+//  reverse order.
+void test_unwrite_across_chunks ()
+{
+    growing_ypipe_t ypipe;
+    ypipe.write (-1, false);
+    for (int i = 0; i < 20; i++)
+        ypipe.write (i, true);
+    for (int i = 19; i >= 0; i--) {
+        int value = -1;
+        TEST_ASSERT_TRUE (ypipe.unwrite (&value));
+        TEST_ASSERT_EQUAL_INT (i, value);
+    }
+    int value = 0;
+    TEST_ASSERT_FALSE (ypipe.unwrite (&value));
+
+    ypipe.write (42, false);
+    ypipe.flush ();
+    TEST_ASSERT_TRUE (ypipe.read (&value));
+    TEST_ASSERT_EQUAL_INT (-1, value);
+    TEST_ASSERT_TRUE (ypipe.read (&value));
+    TEST_ASSERT_EQUAL_INT (42, value);
+}
+
+//  The reader catching up and going to sleep, which frees the spare chunk
+//  and shrinks the chunks, leaves the items flowing.
+void test_shrink_when_idle ()
+{
+    growing_ypipe_t ypipe;
+    int next_read = 0;
+    int next_write = 0;
+    for (int round = 0; round < 10; round++) {
+        //  Bursts of various sizes.
+        const int count = 1 + round * 7;
+        for (int i = 0; i < count; i++)
+            ypipe.write (next_write++, false);
+
+        //  The reader asleep gets woken up.
+        TEST_ASSERT_EQUAL (round == 0, ypipe.flush ());
+
+        int read_value = -1;
+        while (ypipe.read (&read_value))
+            TEST_ASSERT_EQUAL_INT (next_read++, read_value);
+        TEST_ASSERT_EQUAL_INT (next_write, next_read);
+    }
+}
+
+//  Writes a message made of a 5 byte key and a 1 byte value.
+static void write_keyed (zmq::ypipe_keyed_t *ypipe_, int key_, char value_)
+{
+    zmq::msg_t msg;
+    TEST_ASSERT_EQUAL_INT (0, msg.init_size (6));
+    char *const data = static_cast<char *> (msg.data ());
+    char key[6];
+    snprintf (key, sizeof key, "%05d", key_);
+    memcpy (data, key, 5);
+    data[5] = value_;
+    ypipe_->write (msg, false);
+}
+
+static void read_keyed (zmq::ypipe_keyed_t *ypipe_, int key_, char value_)
+{
+    zmq::msg_t msg;
+    TEST_ASSERT_TRUE (ypipe_->read (&msg));
+    TEST_ASSERT_EQUAL_UINT (6, msg.size ());
+    const char *const data = static_cast<const char *> (msg.data ());
+    char key[6];
+    snprintf (key, sizeof key, "%05d", key_);
+    TEST_ASSERT_EQUAL_MEMORY (key, data, 5);
+    TEST_ASSERT_EQUAL_INT (value_, data[5]);
+    TEST_ASSERT_EQUAL_INT (0, msg.close ());
+}
+
+//  Keys never read stay, each with its newest message.
+void test_keyed_keeps_unread_keys ()
+{
+    const int count = 1000;
+    zmq::ypipe_keyed_t ypipe (5);
+    for (int i = 0; i < count; i++)
+        write_keyed (&ypipe, i, 'a');
+    for (int i = 0; i < count; i += 2)
+        write_keyed (&ypipe, i, 'b');
+    ypipe.flush ();
+    TEST_ASSERT_EQUAL_UINT (count, ypipe.keys ());
+
+    for (int i = 0; i < count; i++)
+        read_keyed (&ypipe, i, i % 2 ? 'a' : 'b');
+    TEST_ASSERT_FALSE (ypipe.check_read ());
+}
+
+//  The writer drops the keys read, so that a stream of new keys read as
+//  they come holds a bounded number of slots, and the keys dropped work
+//  again when written to later.
+void test_keyed_drops_read_keys ()
+{
+    const int rounds = 100;
+    const int count = 100;
+    zmq::ypipe_keyed_t ypipe (5);
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < count; i++)
+            write_keyed (&ypipe, round * count + i, 'a');
+        ypipe.flush ();
+        for (int i = 0; i < count; i++)
+            read_keyed (&ypipe, round * count + i, 'a');
+        TEST_ASSERT_FALSE (ypipe.check_read ());
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT (2 * count + 1, ypipe.keys ());
+
+    for (int i = 0; i < count; i++) {
+        write_keyed (&ypipe, i, 'a');
+        write_keyed (&ypipe, i, 'b');
+    }
+    ypipe.flush ();
+    for (int i = 0; i < count; i++)
+        read_keyed (&ypipe, i, 'b');
+    TEST_ASSERT_FALSE (ypipe.check_read ());
+}
+
 int main (void)
 {
     setup_test_environment ();
@@ -65,6 +206,11 @@ int main (void)
     RUN_TEST (test_read_empty);
     RUN_TEST (test_write_complete_and_check_read_and_read);
     RUN_TEST (test_write_complete_and_flush_and_check_read_and_read);
+    RUN_TEST (test_grow);
+    RUN_TEST (test_unwrite_across_chunks);
+    RUN_TEST (test_shrink_when_idle);
+    RUN_TEST (test_keyed_keeps_unread_keys);
+    RUN_TEST (test_keyed_drops_read_keys);
 
     return UNITY_END ();
 }